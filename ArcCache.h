@@ -0,0 +1,260 @@
+#pragma once
+
+#include "CacheNodePool.h"
+#include "Hashmap.h"
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <utility>
+
+
+namespace dsalgo {
+
+/**
+ * Key-value cache with Adaptive Replacement Cache (ARC) eviction, from
+ * Megiddo and Modha, "ARC: A Self-Tuning, Low Overhead Replacement Cache"
+ * (FAST 2003). A drop-in alternative to LruCache that resists scans without
+ * a tuning parameter.
+ *
+ * Cached entries are split between T1, keys seen once recently, and T2, keys
+ * seen at least twice. Evicted keys are remembered, without their values, in
+ * the ghost lists B1 and B2, which hold about as many keys as the cache. The
+ * target size p of T1 adapts on every miss: a miss on a key in B1 means T1
+ * was too small, so p grows, and a miss on a key in B2 means T2 was too
+ * small, so p shrinks. A scan only ever fills T1, and repeated keys in T2
+ * survive it unless the workload really has shifted to recency.
+ *
+ * ARC adapts when a missing key is put, so use it as a read-through cache:
+ * Get(), and on a miss, Put().
+ *
+ * All four lists share one array of 2 * capacity nodes, and one hashmap
+ * indexes cached and ghost keys alike. Nothing is allocated after
+ * construction.
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class ArcCache {
+
+public:
+
+  /**
+   * @param capacity maximum number of cached entries. Must be at least 1.
+   */
+  ArcCache(int capacity) : capacity_(capacity), nodes_(2 * capacity) {
+    assert(capacity >= 1);
+    index_.Reserve(2 * capacity + 1);
+  }
+
+  /**
+   * Looks up a key and marks it as used, which moves it to T2.
+   *
+   * @return the value the key is mapped to, or nullptr if the key isn't in
+   * the cache. Valid until the key is erased or evicted.
+   */
+  Val* Get(const Key& k) {
+    int32_t* found = index_.Get(k);
+    if (found == nullptr || !IsCached(*found)) {
+      return nullptr;
+    }
+    nodes_.MoveToMru(ListOf(*found), t2_, kT2, *found);
+    return &nodes_[*found].v;
+  }
+
+  /**
+   * Looks up a key without marking it as used.
+   */
+  const Val* Peek(const Key& k) const {
+    int32_t* found = index_.Get(k);
+    if (found == nullptr || !IsCached(*found)) {
+      return nullptr;
+    }
+    return &nodes_[*found].v;
+  }
+
+  /**
+   * Maps the key to the value. A key that isn't cached adapts p if it's a
+   * ghost, and may evict an entry. A cached key is marked as used.
+   *
+   * @return true if the key was inserted, false if its value was replaced.
+   */
+  bool Put(const Key& k, const Val& v) {
+    int32_t* found = index_.Get(k);
+    if (found != nullptr) {
+      int32_t node = *found;
+      uint8_t list = nodes_[node].list;
+      if (list == kB1) {
+        p_ = std::min(capacity_, p_ + std::max(b2_.size / b1_.size, 1));
+        MakeRoom(false);
+      } else if (list == kB2) {
+        p_ = std::max(0, p_ - std::max(b1_.size / b2_.size, 1));
+        MakeRoom(true);
+      }
+      // MakeRoom() never frees a node, so the ghost is still there
+      nodes_.MoveToMru(ListOf(node), t2_, kT2, node);
+      nodes_[node].v = v;
+      return list == kB1 || list == kB2;
+    }
+
+    if (t1_.size + b1_.size >= capacity_) {
+      if (t1_.size < capacity_) {
+        DropLru(b1_);
+        MakeRoom(false);
+      } else {
+        DropLru(t1_);
+      }
+    } else if (t1_.size + t2_.size + b1_.size + b2_.size >= capacity_) {
+      if (t1_.size + t2_.size + b1_.size + b2_.size >= 2 * capacity_) {
+        DropLru(b2_);
+      }
+      MakeRoom(false);
+    }
+
+    // DropLru() freed a node if the pool was full
+    int32_t node = nodes_.Alloc();
+    nodes_[node].k = k;
+    nodes_[node].v = v;
+    nodes_.PushMru(t1_, kT1, node);
+    index_.Put(k, node);
+    return true;
+  }
+
+  /**
+   * Removes a key from the cache, and forgets it if it's a ghost.
+   *
+   * @return if the key was cached.
+   */
+  bool Erase(const Key& k) {
+    int32_t* found = index_.Get(k);
+    if (found == nullptr) {
+      return false;
+    }
+    int32_t node = *found;
+    bool cached = IsCached(node);
+    index_.Remove(k);
+    nodes_.Unlink(ListOf(node), node);
+    nodes_.Free(node);
+    return cached;
+  }
+
+  /**
+   * Removes every entry and ghost, and resets p.
+   */
+  void Clear() {
+    nodes_ = Pool(2 * capacity_);
+    t1_ = List();
+    t2_ = List();
+    b1_ = List();
+    b2_ = List();
+    p_ = 0;
+    index_.Clear();
+  }
+
+  int Size() const {
+    return t1_.size + t2_.size;
+  }
+
+  int Capacity() const {
+    return capacity_;
+  }
+
+  /**
+   * @return current target size of T1, the keys seen once recently
+   */
+  int TargetRecencySize() const {
+    return p_;
+  }
+
+private:
+
+  typedef CacheNodePool<Key, Val> Pool;
+  typedef typename Pool::List List;
+
+  // list ids
+  static constexpr uint8_t kT1 = 0;
+  static constexpr uint8_t kT2 = 1;
+  static constexpr uint8_t kB1 = 2;
+  static constexpr uint8_t kB2 = 3;
+
+  bool IsCached(int32_t node) const {
+    return nodes_[node].list == kT1 || nodes_[node].list == kT2;
+  }
+
+  List& ListOf(int32_t node) {
+    switch (nodes_[node].list) {
+      case kT1: return t1_;
+      case kT2: return t2_;
+      case kB1: return b1_;
+      default: return b2_;
+    }
+  }
+
+  /**
+   * ARC's REPLACE: if the cache is full, demotes the least-recently used
+   * entry of T1 to a ghost in B1 if T1 is over its target size p, or else
+   * the least-recently used entry of T2 to a ghost in B2. The cache is only
+   * short of full after Erase().
+   *
+   * @param hit_b2 if the key being put is a ghost in B2, which breaks a tie
+   * in favor of evicting from T1
+   */
+  void MakeRoom(bool hit_b2) {
+    if (t1_.size + t2_.size < capacity_) {
+      return;
+    }
+    if (t1_.size > 0 && (t1_.size > p_ || (hit_b2 && t1_.size == p_) ||
+          t2_.size == 0)) {
+      MakeGhost(t1_, b1_, kB1);
+    } else {
+      MakeGhost(t2_, b2_, kB2);
+    }
+  }
+
+  /**
+   * Moves the least-recently used entry of a cached list to the
+   * most-recently used end of a ghost list, dropping its value.
+   */
+  void MakeGhost(List& from, List& to, uint8_t to_id) {
+    int32_t node = from.lru;
+    nodes_.MoveToMru(from, to, to_id, node);
+    nodes_[node].v = Val();
+  }
+
+  /**
+   * Forgets the least-recently used key of a list, which must not be empty.
+   */
+  void DropLru(List& list) {
+    int32_t node = list.lru;
+    index_.Remove(nodes_[node].k);
+    nodes_.Unlink(list, node);
+    nodes_.Free(node);
+  }
+
+private:
+
+  int capacity_ = 0;
+
+  // target size of T1
+  int p_ = 0;
+
+  Pool nodes_;
+
+  // cached keys seen once and at least twice recently
+  List t1_;
+  List t2_;
+
+  // ghosts of keys evicted from T1 and T2
+  List b1_;
+  List b2_;
+
+  /**
+   * Maps each cached or ghost key to its node.
+   */
+  Hashmap<Key, int32_t, FibonacciHash<Hash>, Eq> index_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,312 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+namespace dsalgo {
+
+/**
+ * Split block Bloom filter over 64-bit hashes.
+ *
+ * The filter is an array of 256-bit blocks, each split into eight 32-bit
+ * words. A hash picks one block, and sets or tests one bit in each of its
+ * words. Every query therefore touches a single block, which is aligned so
+ * that it never straddles cache lines, instead of k scattered cache lines
+ * like a classic Bloom filter. When compiled with AVX2 (e.g. -mavx2), a
+ * block is one register and all eight bits are computed and tested at once.
+ *
+ * Keys have to be hashed by the caller. Hashes are mixed again before use,
+ * so identity hashes like std::hash for integers are fine.
+ *
+ * There are no false negatives: MayContain() returns true for every hash
+ * that was inserted. Hashes can't be removed, except by clearing the whole
+ * filter.
+ */
+class BloomFilter {
+
+public:
+
+  /**
+   * Creates a filter sized for the given number of keys.
+   *
+   * @param num_keys number of keys expected to be inserted
+   * @param false_positive_rate roughly the fraction of hashes that were never
+   * inserted that MayContain() returns true for, once num_keys hashes have
+   * been inserted.
+   */
+  BloomFilter(int64_t num_keys, double false_positive_rate=0.01) {
+    // bits a classic Bloom filter would need, plus a margin for the uneven
+    // load of the blocks
+    double num_bits = -1.2 * std::max<int64_t>(num_keys, 1) *
+      std::log(false_positive_rate) / (std::log(2) * std::log(2));
+    num_blocks_ = std::max<int64_t>(1,
+        static_cast<int64_t>(num_bits / kBitsPerBlock) + 1);
+    blocks_ = AllocBlocks(num_blocks_);
+  }
+
+  /**
+   * Creates a filter without any blocks. Nothing can be inserted into or
+   * looked up in it until it is assigned a sized filter.
+   */
+  BloomFilter() {}
+
+  ~BloomFilter() {
+    FreeMem();
+  }
+
+  BloomFilter(const BloomFilter& other) {
+    CopyFrom(other);
+  }
+
+  BloomFilter(BloomFilter&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  BloomFilter& operator=(const BloomFilter& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  BloomFilter& operator=(BloomFilter&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Adds the given hash to the filter.
+   *
+   * @return if the filter may already have contained the hash, i.e. if
+   * MayContain() would have returned true before inserting it.
+   */
+  bool Insert(uint64_t hash) {
+    assert(num_blocks_ > 0);
+    hash = MurmurMix(hash);
+    uint32_t* block = BlockFor(hash);
+#ifdef __AVX2__
+    __m256i mask = MakeMask(static_cast<uint32_t>(hash));
+    __m256i words = _mm256_load_si256(reinterpret_cast<__m256i*>(block));
+    bool was_present = _mm256_testc_si256(words, mask);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(block),
+        _mm256_or_si256(words, mask));
+    return was_present;
+#else
+    uint32_t mask[kWordsPerBlock];
+    MakeMask(static_cast<uint32_t>(hash), mask);
+    uint32_t missing = 0;
+    for (int i = 0; i < kWordsPerBlock; ++i) {
+      missing |= mask[i] & ~block[i];
+      block[i] |= mask[i];
+    }
+    return missing == 0;
+#endif
+  }
+
+  /**
+   * @return false if the hash was definitely never inserted, true if it may
+   * have been.
+   */
+  bool MayContain(uint64_t hash) const {
+    assert(num_blocks_ > 0);
+    hash = MurmurMix(hash);
+    const uint32_t* block = BlockFor(hash);
+#ifdef __AVX2__
+    __m256i mask = MakeMask(static_cast<uint32_t>(hash));
+    __m256i words = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+    return _mm256_testc_si256(words, mask);
+#else
+    uint32_t mask[kWordsPerBlock];
+    MakeMask(static_cast<uint32_t>(hash), mask);
+    uint32_t missing = 0;
+    for (int i = 0; i < kWordsPerBlock; ++i) {
+      missing |= mask[i] & ~block[i];
+    }
+    return missing == 0;
+#endif
+  }
+
+  /**
+   * Inserts a batch of hashes. The blocks of each kBatchSize hashes are
+   * prefetched before any of them is updated, so their cache misses overlap.
+   *
+   * @param hashes array of n hashes to insert
+   * @param n number of hashes
+   * @param was_present optional array of n results. was_present[i] is set to
+   * what Insert(hashes[i]) returns.
+   */
+  void InsertMany(const uint64_t* hashes, int64_t n,
+      bool* was_present=nullptr) {
+    for (int64_t batch_begin = 0; batch_begin < n; batch_begin += kBatchSize) {
+      int64_t batch_end = std::min(batch_begin + kBatchSize, n);
+      PrefetchBatch(hashes, batch_begin, batch_end);
+      for (int64_t i = batch_begin; i < batch_end; ++i) {
+        bool present = Insert(hashes[i]);
+        if (was_present != nullptr) {
+          was_present[i] = present;
+        }
+      }
+    }
+  }
+
+  /**
+   * Looks up a batch of hashes, prefetching like InsertMany().
+   *
+   * @param hashes array of n hashes to look up
+   * @param n number of hashes
+   * @param results array of n results. results[i] is set to
+   * MayContain(hashes[i]).
+   */
+  void MayContainMany(const uint64_t* hashes, int64_t n, bool* results) const {
+    for (int64_t batch_begin = 0; batch_begin < n; batch_begin += kBatchSize) {
+      int64_t batch_end = std::min(batch_begin + kBatchSize, n);
+      PrefetchBatch(hashes, batch_begin, batch_end);
+      for (int64_t i = batch_begin; i < batch_end; ++i) {
+        results[i] = MayContain(hashes[i]);
+      }
+    }
+  }
+
+  /**
+   * Removes every hash from the filter.
+   */
+  void Clear() {
+    if (blocks_ != nullptr) {
+      std::memset(blocks_, 0, num_blocks_ * kBytesPerBlock);
+    }
+  }
+
+  /**
+   * @return number of bytes used by the filter's blocks.
+   */
+  int64_t SizeBytes() const {
+    return num_blocks_ * kBytesPerBlock;
+  }
+
+private:
+
+  static constexpr int kWordsPerBlock = 8;
+
+  static constexpr int kBytesPerBlock = kWordsPerBlock * sizeof(uint32_t);
+
+  static constexpr int kBitsPerBlock = kBytesPerBlock * 8;
+
+  // number of hashes whose blocks InsertMany() and MayContainMany() prefetch
+  // at a time.
+  static constexpr int kBatchSize = 16;
+
+  /**
+   * Allocates the given number of zeroed blocks, aligned to a cache line.
+   */
+  static uint32_t* AllocBlocks(int64_t num_blocks) {
+    void* mem = nullptr;
+    if (posix_memalign(&mem, 64, num_blocks * kBytesPerBlock) != 0) {
+      throw std::bad_alloc();
+    }
+    std::memset(mem, 0, num_blocks * kBytesPerBlock);
+    return static_cast<uint32_t*>(mem);
+  }
+
+  /**
+   * Frees any memory that has been allocated for this filter.
+   */
+  void FreeMem() {
+    if (blocks_ != nullptr) {
+      free(blocks_);
+      blocks_ = nullptr;
+    }
+  }
+
+  /**
+   * Copies another filter into this filter. Does not free any currently
+   * allocated memory though.
+   */
+  void CopyFrom(const BloomFilter& other) {
+    num_blocks_ = other.num_blocks_;
+    if (other.blocks_ != nullptr) {
+      blocks_ = AllocBlocks(num_blocks_);
+      std::memcpy(blocks_, other.blocks_, num_blocks_ * kBytesPerBlock);
+    }
+  }
+
+  /**
+   * Moves another filter into this filter. The other filter is left without
+   * any blocks.
+   */
+  void MoveFrom(BloomFilter& other) {
+    blocks_ = other.blocks_;
+    num_blocks_ = other.num_blocks_;
+
+    other.blocks_ = nullptr;
+    other.num_blocks_ = 0;
+  }
+
+  /**
+   * @return the block that the high 32 bits of the mixed hash pick, without
+   * a division.
+   */
+  inline uint32_t* BlockFor(uint64_t hash) const {
+    uint64_t block_idx = ((hash >> 32) * static_cast<uint64_t>(num_blocks_))
+      >> 32;
+    return blocks_ + block_idx * kWordsPerBlock;
+  }
+
+  /**
+   * Prefetches the blocks of hashes[begin] to hashes[end - 1].
+   */
+  void PrefetchBatch(const uint64_t* hashes, int64_t begin,
+      int64_t end) const {
+    for (int64_t i = begin; i < end; ++i) {
+      __builtin_prefetch(BlockFor(MurmurMix(hashes[i])));
+    }
+  }
+
+  // odd multipliers that turn the low 32 bits of the hash into one bit
+  // position per word
+#define DSALGO_BLOOM_SALTS 0x47b6137bU, 0x44974d91U, 0x8824ad5bU, \
+    0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+
+#ifdef __AVX2__
+  /**
+   * @return block with the bit for the hash set in each word
+   */
+  static inline __m256i MakeMask(uint32_t hash) {
+    const __m256i salts = _mm256_setr_epi32(DSALGO_BLOOM_SALTS);
+    __m256i products = _mm256_mullo_epi32(_mm256_set1_epi32(hash), salts);
+    __m256i bit_positions = _mm256_srli_epi32(products, 27);
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit_positions);
+  }
+#else
+  /**
+   * Sets mask to the block with the bit for the hash set in each word.
+   */
+  static inline void MakeMask(uint32_t hash, uint32_t* mask) {
+    static const uint32_t salts[kWordsPerBlock] = {DSALGO_BLOOM_SALTS};
+    for (int i = 0; i < kWordsPerBlock; ++i) {
+      mask[i] = 1U << ((hash * salts[i]) >> 27);
+    }
+  }
+#endif
+
+#undef DSALGO_BLOOM_SALTS
+
+private:
+
+  // kWordsPerBlock words for every block
+  uint32_t* blocks_ = nullptr;
+
+  int64_t num_blocks_ = 0;
+};
+
+} // namespace dsalgo
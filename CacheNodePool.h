@@ -0,0 +1,154 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+
+namespace dsalgo {
+
+/**
+ * Preallocated nodes of the recency lists of a cache, such as the segments
+ * of SegmentedLruCache or ArcCache. All nodes live in one array and are
+ * linked by 32-bit index, like LruQueue's entries, so a pool copies and
+ * moves like any value and nothing is allocated after construction.
+ *
+ * Each list is a List owned by the cache, from least- to most-recently used.
+ * Every node records the id of the list it's in, which is how a cache tells
+ * which segment a key it looked up is in. Nodes that are in no list are
+ * chained into a free list.
+ *
+ * Key and Val must be default constructible.
+ */
+template<class Key, class Val>
+class CacheNodePool {
+
+public:
+
+  /**
+   * Marks the end of a list.
+   */
+  static constexpr int32_t kNoNode = -1;
+
+  struct Node {
+    Key k;
+    Val v;
+    int32_t prev = kNoNode;
+    int32_t next = kNoNode;
+    uint8_t list = 0;
+  };
+
+  struct List {
+    int32_t lru = kNoNode;
+    int32_t mru = kNoNode;
+    int32_t size = 0;
+  };
+
+  /**
+   * @param num_nodes number of nodes, all of them initially free
+   */
+  explicit CacheNodePool(int num_nodes) : nodes_(num_nodes) {
+    for (int i = 0; i + 1 < num_nodes; ++i) {
+      nodes_[i].next = i + 1;
+    }
+    free_ = (num_nodes > 0) ? 0 : kNoNode;
+  }
+
+  Node& operator[](int32_t node) {
+    return nodes_[node];
+  }
+
+  const Node& operator[](int32_t node) const {
+    return nodes_[node];
+  }
+
+  /**
+   * @return if every node is in use
+   */
+  bool Full() const {
+    return free_ == kNoNode;
+  }
+
+  /**
+   * Takes a node off the free list. The pool must not be full.
+   */
+  int32_t Alloc() {
+    assert(!Full());
+    int32_t node = free_;
+    free_ = nodes_[node].next;
+    return node;
+  }
+
+  /**
+   * Puts a node that's in no list back on the free list, releasing whatever
+   * its key and value hold.
+   */
+  void Free(int32_t node) {
+    nodes_[node].k = Key();
+    nodes_[node].v = Val();
+    nodes_[node].next = free_;
+    free_ = node;
+  }
+
+  /**
+   * Adds a node that's in no list to the most-recently used end of a list.
+   *
+   * @param list_id id recorded in the node
+   */
+  void PushMru(List& list, uint8_t list_id, int32_t node) {
+    Node& n = nodes_[node];
+    n.prev = list.mru;
+    n.next = kNoNode;
+    n.list = list_id;
+    if (list.mru != kNoNode) {
+      nodes_[list.mru].next = node;
+    } else {
+      list.lru = node;
+    }
+    list.mru = node;
+    ++list.size;
+  }
+
+  /**
+   * Removes a node from the list it's in, but DOES NOT free it.
+   */
+  void Unlink(List& list, int32_t node) {
+    Node& n = nodes_[node];
+    if (n.prev != kNoNode) {
+      nodes_[n.prev].next = n.next;
+    } else {
+      list.lru = n.next;
+    }
+    if (n.next != kNoNode) {
+      nodes_[n.next].prev = n.prev;
+    } else {
+      list.mru = n.prev;
+    }
+    --list.size;
+  }
+
+  /**
+   * Moves a node to the most-recently used end of a list, which may be the
+   * one it's already in.
+   */
+  void MoveToMru(List& from, List& to, uint8_t to_id, int32_t node) {
+    if (&from == &to && node == to.mru) {
+      return;
+    }
+    Unlink(from, node);
+    PushMru(to, to_id, node);
+  }
+
+  int NumNodes() const {
+    return nodes_.size();
+  }
+
+private:
+
+  std::vector<Node> nodes_;
+
+  // head of the chain of unused nodes, linked through next
+  int32_t free_ = kNoNode;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "Hashmap.h"
+#include <assert.h>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+
+namespace dsalgo {
+
+/**
+ * Drop-in alternative to LruQueue that approximates LRU with the CLOCK
+ * (second-chance) algorithm. Has the same GetLru() and MarkUsed() surface.
+ *
+ * Elements sit in a circular array with a reference bit each, and a hand
+ * points at the next candidate for eviction. MarkUsed() only sets the
+ * element's bit, so a hit touches one byte instead of splicing a linked list.
+ * GetLru() sweeps the hand forward, clearing set bits, until it reaches an
+ * element whose bit is clear: one that hasn't been used since the hand last
+ * passed it. Each sweep walks a contiguous array, and every step clears a
+ * bit, so GetLru() is amortized O(1).
+ *
+ * The result is not exactly least-recently used: every element used since
+ * the hand last passed gets a second chance, regardless of the order in
+ * which they were used. In read-mostly caches this picks nearly the same
+ * victims as LRU (see lru_prof.cpp).
+ *
+ * Reference bits are atomic, so any number of threads may call MarkUsed()
+ * concurrently with each other and with one thread calling GetLru().
+ *
+ * Every element in the ClockQueue should have a unique hash. Supports up to
+ * 2^31 - 1 elements.
+ */
+template <typename T>
+class ClockQueue {
+
+public:
+
+  /**
+   * Constructs a ClockQueue for the given elements.
+   *
+   * @param elements The elements that the ClockQueue should manage. None of
+   * them are marked as used, and the hand starts at the first element, so
+   * they are evicted in order until they're used.
+   */
+  ClockQueue(const std::vector<T>& elements) : size_(elements.size()) {
+    assert(elements.size() >= 1);
+    assert(elements.size() <= static_cast<size_t>(INT32_MAX));
+    AllocMemory();
+    for (int32_t i = 0; i < size_; ++i) {
+      assert(elem_to_slot_.Get(elements[i]) == nullptr);
+      elements_[i] = elements[i];
+      elem_to_slot_.Put(elements[i], i);
+    }
+  }
+
+  ~ClockQueue() {
+    FreeMemory();
+  }
+
+  ClockQueue(const ClockQueue<T>& other) {
+    CopyFrom(other);
+  }
+
+  ClockQueue(ClockQueue<T>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  ClockQueue& operator=(const ClockQueue& other) {
+    if (this != &other) {
+      FreeMemory();
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  ClockQueue& operator=(ClockQueue&& other) {
+    if (this != &other) {
+      FreeMemory();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  /**
+   * @return The element to evict next. Advances the hand past, and clears the
+   * reference bit of, every element used since the hand last passed it, so
+   * repeated calls return the same element until it's marked as used.
+   */
+  const T& GetLru() const {
+    while (refs_[hand_].load(std::memory_order_relaxed) != 0) {
+      refs_[hand_].store(0, std::memory_order_relaxed);
+      hand_ = (hand_ + 1 == size_) ? 0 : hand_ + 1;
+    }
+    return elements_[hand_];
+  }
+
+  /**
+   * Marks the given element as used by setting its reference bit.
+   *
+   * @param elem The element to mark as used.
+   */
+  void MarkUsed(const T& elem) {
+    assert(elem_to_slot_.Get(elem) != nullptr);
+    int32_t slot = *elem_to_slot_.Get(elem);
+
+    // skip the store if the bit is already set, so hot elements don't keep
+    // invalidating the cache line for other threads
+    if (refs_[slot].load(std::memory_order_relaxed) == 0) {
+      refs_[slot].store(1, std::memory_order_relaxed);
+    }
+  }
+
+private:
+
+  /**
+   * Allocates the arrays for size_ elements. All reference bits start clear.
+   */
+  void AllocMemory() {
+    elements_ = new T[size_];
+    refs_ = new std::atomic<uint8_t>[size_];
+    for (int32_t i = 0; i < size_; ++i) {
+      refs_[i].store(0, std::memory_order_relaxed);
+    }
+    hand_ = 0;
+  }
+
+  /**
+   * Releases all heap memory allocated by this ClockQueue.
+   */
+  void FreeMemory() {
+    delete[] elements_;
+    delete[] refs_;
+    elements_ = nullptr;
+    refs_ = nullptr;
+    elem_to_slot_ = Hashmap<T, int32_t>();
+  }
+
+  /**
+   * Moves another ClockQueue's contents into this queue. The other queue is
+   * emptied out.
+   */
+  void MoveFrom(ClockQueue<T>& other) {
+    elements_ = other.elements_;
+    refs_ = other.refs_;
+    size_ = other.size_;
+    hand_ = other.hand_;
+    elem_to_slot_ = std::move(other.elem_to_slot_);
+    other.elements_ = nullptr;
+    other.refs_ = nullptr;
+    other.size_ = 0;
+    other.hand_ = 0;
+  }
+
+  /**
+   * Deep copies all elements, reference bits and the hand from another
+   * ClockQueue.
+   *
+   * Note that no memory clean up is performed before copying. Call
+   * FreeMemory() before calling CopyFrom() if you need to clean up the
+   * current object.
+   */
+  void CopyFrom(const ClockQueue<T>& other) {
+    size_ = other.size_;
+    AllocMemory();
+    for (int32_t i = 0; i < size_; ++i) {
+      elements_[i] = other.elements_[i];
+      refs_[i].store(other.refs_[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    hand_ = other.hand_;
+    elem_to_slot_ = other.elem_to_slot_;
+  }
+
+private:
+
+  /**
+   * The elements, in the order the hand visits them.
+   */
+  T* elements_ = nullptr;
+
+  /**
+   * refs_[i] is 1 if elements_[i] was used since the hand last passed it.
+   * One byte per element so that setting one needs no read-modify-write.
+   */
+  std::atomic<uint8_t>* refs_ = nullptr;
+
+  int32_t size_ = 0;
+
+  /**
+   * Index of the next candidate for eviction. Moving it doesn't change which
+   * elements are in the queue, so GetLru() stays const.
+   */
+  mutable int32_t hand_ = 0;
+
+  /**
+   * Hashes elements to their index in elements_.
+   */
+  dsalgo::Hashmap<T, int32_t> elem_to_slot_;
+
+};
+
+} // namespace dsalgo
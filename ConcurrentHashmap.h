@@ -0,0 +1,223 @@
+#pragma once
+
+#include "Hashmap.h"
+#include "Utils.h"
+#include <assert.h>
+#include <functional>
+#include <new>
+#include <pthread.h>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+namespace dsalgo {
+
+/**
+ * Thread-safe hashmap that partitions keys across independently locked
+ * Hashmap shards.
+ *
+ * A key's shard is picked from the high bits of its (mixed) hash, while each
+ * shard's Hashmap indexes its table with the low bits, so the two choices are
+ * independent. Each shard is guarded by its own reader/writer lock, so
+ * concurrent Get() calls never block each other and writers only block the
+ * threads that touch the same shard. Shards are cache-line aligned so that
+ * locking one shard doesn't invalidate the cache line holding another.
+ *
+ * Because another thread may modify a shard as soon as its lock is released,
+ * values are copied out instead of returned by pointer.
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class ConcurrentHashmap {
+
+public:
+
+  /**
+   * Creates a concurrent hashmap.
+   *
+   * @param num_shards number of independently locked shards. Rounded up to a
+   * power of 2. Use a few times more shards than threads to keep the chance
+   * of two threads contending on the same shard low.
+   * @param init_capacity_per_shard initial capacity of each shard's Hashmap
+   * @param load_factor load factor of each shard's Hashmap
+   */
+  ConcurrentHashmap(int num_shards=64, int init_capacity_per_shard=8,
+      float load_factor=0.7) {
+    if (num_shards < 1) {
+      num_shards = 1;
+    }
+    num_shards_ = IsPowerOf2(num_shards) ?
+      num_shards :
+      NextPowerOf2(num_shards);
+    while ((1 << shard_bits_) < num_shards_) {
+      ++shard_bits_;
+    }
+
+    // new doesn't have to respect over-aligned types before C++17
+    void* mem = nullptr;
+    if (posix_memalign(&mem, kCacheLineSize, sizeof(Shard) * num_shards_)
+        != 0) {
+      throw std::bad_alloc();
+    }
+    shards_ = static_cast<Shard*>(mem);
+    for (int i = 0; i < num_shards_; ++i) {
+      new (shards_ + i) Shard(init_capacity_per_shard, load_factor);
+    }
+  }
+
+  ~ConcurrentHashmap() {
+    for (int i = 0; i < num_shards_; ++i) {
+      shards_[i].~Shard();
+    }
+    free(shards_);
+  }
+
+  // shards hold OS locks, which cannot be copied or moved.
+  ConcurrentHashmap(const ConcurrentHashmap&) = delete;
+  ConcurrentHashmap& operator=(const ConcurrentHashmap&) = delete;
+
+  /**
+   * Maps the given key to the given value, overwriting any previous mapping.
+   */
+  void Put(const Key& k, const Val& v) {
+    Shard& shard = ShardFor(k);
+    pthread_rwlock_wrlock(&shard.lock);
+    shard.map.Put(k, v);
+    pthread_rwlock_unlock(&shard.lock);
+  }
+
+  /**
+   * Copies the value mapped to the given key into *v.
+   *
+   * @param k key to look up
+   * @param v where to copy the value if the key is found. Untouched otherwise.
+   * @return if the key was in the hashmap
+   */
+  bool Get(const Key& k, Val* v) const {
+    Shard& shard = ShardFor(k);
+    pthread_rwlock_rdlock(&shard.lock);
+    Val* found = shard.map.Get(k);
+    if (found != nullptr) {
+      *v = *found;
+    }
+    pthread_rwlock_unlock(&shard.lock);
+    return found != nullptr;
+  }
+
+  /**
+   * @return if the given key is in the hashmap
+   */
+  bool Contains(const Key& k) const {
+    Shard& shard = ShardFor(k);
+    pthread_rwlock_rdlock(&shard.lock);
+    bool found = (shard.map.Get(k) != nullptr);
+    pthread_rwlock_unlock(&shard.lock);
+    return found;
+  }
+
+  /**
+   * Removes the given key from the hashmap if present.
+   *
+   * @return if the key was removed
+   */
+  bool Remove(const Key& k) {
+    Shard& shard = ShardFor(k);
+    pthread_rwlock_wrlock(&shard.lock);
+    bool removed = shard.map.Remove(k);
+    pthread_rwlock_unlock(&shard.lock);
+    return removed;
+  }
+
+  /**
+   * @return number of entries in the hashmap. Shards are counted one at a
+   * time, so this is not a consistent snapshot if other threads are writing.
+   */
+  int Size() const {
+    int size = 0;
+    for (int i = 0; i < num_shards_; ++i) {
+      pthread_rwlock_rdlock(&shards_[i].lock);
+      size += shards_[i].map.Size();
+      pthread_rwlock_unlock(&shards_[i].lock);
+    }
+    return size;
+  }
+
+  /**
+   * Removes all elements from the hashmap, one shard at a time.
+   */
+  void Clear() {
+    for (int i = 0; i < num_shards_; ++i) {
+      pthread_rwlock_wrlock(&shards_[i].lock);
+      shards_[i].map.Clear();
+      pthread_rwlock_unlock(&shards_[i].lock);
+    }
+  }
+
+  /**
+   * @return number of shards
+   */
+  int NumShards() const {
+    return num_shards_;
+  }
+
+private:
+
+  static constexpr int kCacheLineSize = 64;
+
+  /**
+   * A Hashmap and the lock that guards it. Aligning (and therefore padding)
+   * each shard to a cache line keeps neighboring shards from false sharing.
+   */
+  struct alignas(kCacheLineSize) Shard {
+    mutable pthread_rwlock_t lock;
+    Hashmap<Key, Val, Hash, Eq> map;
+
+    Shard(int init_capacity, float load_factor)
+        : map(init_capacity, load_factor) {
+      pthread_rwlock_init(&lock, nullptr);
+    }
+
+    ~Shard() {
+      pthread_rwlock_destroy(&lock);
+    }
+  };
+
+  /**
+   * @return the shard that holds the given key
+   */
+  inline Shard& ShardFor(const Key& k) const {
+    if (num_shards_ == 1) {
+      return shards_[0];
+    }
+
+    // std::hash is the identity for integers, so mix the hash before taking
+    // its high bits (Fibonacci hashing).
+    uint64_t mixed = static_cast<uint64_t>(hash_fn_(k)) * 0x9E3779B97F4A7C15ULL;
+    return shards_[mixed >> (64 - shard_bits_)];
+  }
+
+private:
+
+  // array of num_shards_ cache-line aligned shards
+  Shard* shards_ = nullptr;
+
+  // number of shards, a power of 2
+  int num_shards_ = 0;
+
+  // log2(num_shards_)
+  int shard_bits_ = 0;
+
+  Hash hash_fn_;
+};
+
+} // namespace dsalgo
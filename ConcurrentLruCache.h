@@ -0,0 +1,494 @@
+#pragma once
+
+#include "Hashmap.h"
+#include "Utils.h"
+#include <assert.h>
+#include <atomic>
+#include <functional>
+#include <new>
+#include <pthread.h>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdlib.h>
+#include <thread>
+
+
+namespace dsalgo {
+
+/**
+ * Thread-safe key-value cache holding at most about a fixed number of
+ * entries, evicting approximately least-recently used ones.
+ *
+ * Keys are partitioned across shards like in ConcurrentHashmap, and each
+ * shard is an LruCache of capacity / num_shards entries, so eviction is LRU
+ * within a shard. A shard has two locks: a reader/writer lock for its
+ * hashmap and values, and a mutex for its recency list.
+ *
+ * Marking a hit as used rewrites the list, so taking the list lock on every
+ * Get() would serialize all hits to a shard. Instead, Get() only takes the
+ * read lock, and records the hit's node in a ring buffer. Every shard has a
+ * ring buffer for each of a few stripes of threads, so concurrent hits
+ * rarely write to the same buffer. When a buffer fills up, the thread that
+ * filled it try-locks the list and replays every buffer of the shard in one
+ * batch. If another thread is already draining, it doesn't wait, and if a
+ * buffer is full or contended, the hit isn't recorded at all. Losing a few
+ * hits of a hot key doesn't change much which keys are least-recently used.
+ * Put() and Erase() lock both, and drain the buffers before touching the
+ * list so that evictions see recent hits.
+ *
+ * Because another thread may modify a shard as soon as its lock is released,
+ * values are copied out instead of returned by pointer.
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the cache
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class ConcurrentLruCache {
+
+public:
+
+  /**
+   * Creates a concurrent LRU cache.
+   *
+   * @param capacity maximum number of entries. Split evenly across the
+   * shards, rounding up, so each shard can hold at least one entry.
+   * @param num_shards number of independently locked shards. Rounded up to a
+   * power of 2.
+   */
+  ConcurrentLruCache(int capacity, int num_shards=64) {
+    assert(capacity >= 1);
+    if (num_shards < 1) {
+      num_shards = 1;
+    }
+    num_shards_ = IsPowerOf2(num_shards) ?
+      num_shards :
+      NextPowerOf2(num_shards);
+
+    // enough stripes that every hardware thread can have its own buffer
+    int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    num_stripes_ = num_threads <= 1 ? 1 : NextPowerOf2(num_threads);
+
+    int capacity_per_shard = (capacity + num_shards_ - 1) / num_shards_;
+    shards_ = static_cast<Shard*>(AllocAligned(sizeof(Shard) * num_shards_));
+    for (int i = 0; i < num_shards_; ++i) {
+      new (shards_ + i) Shard(capacity_per_shard, num_stripes_);
+    }
+  }
+
+  ~ConcurrentLruCache() {
+    for (int i = 0; i < num_shards_; ++i) {
+      shards_[i].~Shard();
+    }
+    free(shards_);
+  }
+
+  // shards hold OS locks, which cannot be copied or moved.
+  ConcurrentLruCache(const ConcurrentLruCache&) = delete;
+  ConcurrentLruCache& operator=(const ConcurrentLruCache&) = delete;
+
+  /**
+   * Copies the value mapped to the given key into *v, and records the hit.
+   *
+   * @param k key to look up
+   * @param v where to copy the value if the key is found. Untouched otherwise.
+   * @return if the key was in the cache
+   */
+  bool Get(const Key& k, Val* v) {
+    Shard& shard = ShardFor(k);
+    pthread_rwlock_rdlock(&shard.map_lock);
+    int32_t* found = shard.index.Get(k);
+    int32_t node = kNoNode;
+    if (found != nullptr) {
+      node = *found;
+      *v = shard.nodes[node].v;
+    }
+    pthread_rwlock_unlock(&shard.map_lock);
+
+    if (node != kNoNode &&
+        shard.buffers[ThreadStripe()].Record(node) &&
+        pthread_mutex_trylock(&shard.list_lock) == 0) {
+      shard.Drain(num_stripes_);
+      pthread_mutex_unlock(&shard.list_lock);
+    }
+    return node != kNoNode;
+  }
+
+  /**
+   * Maps the key to the value and marks it as most-recently used. If the key
+   * is new and its shard is full, the shard's least-recently used entry is
+   * evicted.
+   *
+   * @return true if the key was inserted, false if its value was replaced.
+   */
+  bool Put(const Key& k, const Val& v) {
+    Shard& shard = ShardFor(k);
+    pthread_rwlock_wrlock(&shard.map_lock);
+    pthread_mutex_lock(&shard.list_lock);
+    shard.Drain(num_stripes_);
+    bool inserted = shard.Put(k, v);
+    pthread_mutex_unlock(&shard.list_lock);
+    pthread_rwlock_unlock(&shard.map_lock);
+    return inserted;
+  }
+
+  /**
+   * Removes a key from the cache.
+   *
+   * @return if the key was in the cache
+   */
+  bool Erase(const Key& k) {
+    Shard& shard = ShardFor(k);
+    pthread_rwlock_wrlock(&shard.map_lock);
+    pthread_mutex_lock(&shard.list_lock);
+    shard.Drain(num_stripes_);
+    bool erased = shard.Erase(k);
+    pthread_mutex_unlock(&shard.list_lock);
+    pthread_rwlock_unlock(&shard.map_lock);
+    return erased;
+  }
+
+  /**
+   * @return number of entries in the cache. Shards are counted one at a
+   * time, so this is not a consistent snapshot if other threads are writing.
+   */
+  int Size() const {
+    int size = 0;
+    for (int i = 0; i < num_shards_; ++i) {
+      pthread_rwlock_rdlock(&shards_[i].map_lock);
+      size += shards_[i].size;
+      pthread_rwlock_unlock(&shards_[i].map_lock);
+    }
+    return size;
+  }
+
+  /**
+   * Removes all entries from the cache, one shard at a time.
+   */
+  void Clear() {
+    for (int i = 0; i < num_shards_; ++i) {
+      pthread_rwlock_wrlock(&shards_[i].map_lock);
+      pthread_mutex_lock(&shards_[i].list_lock);
+      shards_[i].Drain(num_stripes_);
+      shards_[i].Clear();
+      pthread_mutex_unlock(&shards_[i].list_lock);
+      pthread_rwlock_unlock(&shards_[i].map_lock);
+    }
+  }
+
+  /**
+   * @return maximum number of entries, which is at least the capacity
+   * requested at construction.
+   */
+  int Capacity() const {
+    return shards_[0].capacity * num_shards_;
+  }
+
+  /**
+   * @return number of shards
+   */
+  int NumShards() const {
+    return num_shards_;
+  }
+
+private:
+
+  static constexpr int kCacheLineSize = 64;
+
+  // number of hits each ring buffer holds before it's drained. A power of 2.
+  static constexpr uint32_t kReadBufferSize = 16;
+
+  // marks the end of a list, and an empty ring buffer slot
+  static constexpr int32_t kNoNode = -1;
+
+  // prev of a node on the free list
+  static constexpr int32_t kFreeNode = -2;
+
+  /**
+   * An entry, and its links in the recency list. k and v are guarded by the
+   * shard's map_lock, the links by its list_lock.
+   */
+  struct Node {
+    Key k;
+    Val v;
+    int32_t prev = kFreeNode;
+    int32_t next = kNoNode;
+  };
+
+  /**
+   * Lossy ring buffer of the nodes a stripe of threads hit. Any number of
+   * threads record into it, and one thread at a time, holding the shard's
+   * list_lock, drains it. Aligned so that buffers don't false share.
+   */
+  struct alignas(kCacheLineSize) ReadBuffer {
+    std::atomic<uint32_t> writes;
+    std::atomic<uint32_t> reads;
+    std::atomic<int32_t> slots[kReadBufferSize];
+
+    ReadBuffer() : writes(0), reads(0) {
+      for (uint32_t i = 0; i < kReadBufferSize; ++i) {
+        slots[i].store(kNoNode, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * Records a hit unless the buffer is full or another thread is claiming
+     * the same slot.
+     *
+     * @return if the buffer is full and should be drained
+     */
+    bool Record(int32_t node) {
+      uint32_t w = writes.load(std::memory_order_relaxed);
+      uint32_t r = reads.load(std::memory_order_acquire);
+      if (w - r >= kReadBufferSize) {
+        return true;
+      }
+      if (!writes.compare_exchange_strong(w, w + 1,
+            std::memory_order_relaxed)) {
+        return false;
+      }
+      slots[w & (kReadBufferSize - 1)].store(node, std::memory_order_release);
+      return w + 1 - r >= kReadBufferSize;
+    }
+
+    /**
+     * Passes every recorded node to f, oldest first. Stops early at a slot
+     * that has been claimed but not written yet, which is picked up by the
+     * next drain.
+     */
+    template<class F>
+    void Drain(const F& f) {
+      uint32_t r = reads.load(std::memory_order_relaxed);
+      uint32_t w = writes.load(std::memory_order_acquire);
+      for (; r != w; ++r) {
+        std::atomic<int32_t>& slot = slots[r & (kReadBufferSize - 1)];
+        int32_t node = slot.load(std::memory_order_acquire);
+        if (node == kNoNode) {
+          break;
+        }
+        // no writer can claim the slot again until reads is published
+        slot.store(kNoNode, std::memory_order_relaxed);
+        f(node);
+      }
+      reads.store(r, std::memory_order_release);
+    }
+  };
+
+  /**
+   * An LruCache with separately locked hashmap and recency list, and a ring
+   * buffer of hits per stripe. Aligning (and therefore padding) each shard
+   * to a cache line keeps neighboring shards from false sharing.
+   */
+  struct alignas(kCacheLineSize) Shard {
+    mutable pthread_rwlock_t map_lock;
+    pthread_mutex_t list_lock;
+    Hashmap<Key, int32_t, FibonacciHash<Hash>, Eq> index;
+    Node* nodes = nullptr;
+    ReadBuffer* buffers = nullptr;
+    int capacity = 0;
+    int size = 0;
+    int32_t lru = kNoNode;
+    int32_t mru = kNoNode;
+    int32_t free_list = 0;
+
+    Shard(int capacity, int num_stripes) : capacity(capacity) {
+      pthread_rwlock_init(&map_lock, nullptr);
+      pthread_mutex_init(&list_lock, nullptr);
+      index.Reserve(capacity + 1);
+      nodes = new Node[capacity];
+      for (int i = 0; i < capacity; ++i) {
+        nodes[i].next = (i + 1 < capacity) ? i + 1 : kNoNode;
+      }
+      buffers = static_cast<ReadBuffer*>(
+          AllocAligned(sizeof(ReadBuffer) * num_stripes));
+      for (int i = 0; i < num_stripes; ++i) {
+        new (buffers + i) ReadBuffer();
+      }
+    }
+
+    ~Shard() {
+      // ReadBuffer only holds atomics of trivial types, so nothing to destroy
+      free(buffers);
+      delete[] nodes;
+      pthread_mutex_destroy(&list_lock);
+      pthread_rwlock_destroy(&map_lock);
+    }
+
+    /**
+     * Marks every node recorded in the ring buffers as used. Nodes may have
+     * been erased, or evicted and reused for another key, since they were
+     * recorded. Free ones are skipped. Must hold list_lock.
+     */
+    void Drain(int num_stripes) {
+      for (int i = 0; i < num_stripes; ++i) {
+        buffers[i].Drain([this](int32_t node) {
+          if (nodes[node].prev != kFreeNode) {
+            MarkUsed(node);
+          }
+        });
+      }
+    }
+
+    /**
+     * Same as LruCache::Put(). Must hold both locks.
+     */
+    bool Put(const Key& k, const Val& v) {
+      std::pair<int32_t*, bool> found = index.TryEmplace(k);
+      if (!found.second) {
+        nodes[*found.first].v = v;
+        MarkUsed(*found.first);
+        return false;
+      }
+
+      int32_t node = free_list;
+      if (node != kNoNode) {
+        free_list = nodes[node].next;
+        *found.first = node;
+        ++size;
+      } else {
+        // full, so recycle the least-recently used node. The index has room
+        // for one more key than the capacity, so inserting k didn't resize
+        // it, but removing the evicted key may shift k's slot.
+        node = lru;
+        Unlink(node);
+        *found.first = node;
+        index.Remove(nodes[node].k);
+      }
+      nodes[node].k = k;
+      nodes[node].v = v;
+      Append(node);
+      return true;
+    }
+
+    /**
+     * Same as LruCache::Erase(). Must hold both locks.
+     */
+    bool Erase(const Key& k) {
+      int32_t* found = index.Get(k);
+      if (found == nullptr) {
+        return false;
+      }
+      int32_t node = *found;
+      index.Remove(k);
+      Unlink(node);
+      Release(node);
+      --size;
+      return true;
+    }
+
+    /**
+     * Removes every entry. Must hold both locks.
+     */
+    void Clear() {
+      while (lru != kNoNode) {
+        int32_t node = lru;
+        Unlink(node);
+        Release(node);
+      }
+      index.Clear();
+      size = 0;
+    }
+
+    void MarkUsed(int32_t node) {
+      if (node != mru) {
+        Unlink(node);
+        Append(node);
+      }
+    }
+
+    void Append(int32_t node) {
+      nodes[node].prev = mru;
+      nodes[node].next = kNoNode;
+      if (mru != kNoNode) {
+        nodes[mru].next = node;
+      } else {
+        lru = node;
+      }
+      mru = node;
+    }
+
+    void Unlink(int32_t node) {
+      int32_t prev = nodes[node].prev;
+      int32_t next = nodes[node].next;
+      if (prev != kNoNode) {
+        nodes[prev].next = next;
+      } else {
+        lru = next;
+      }
+      if (next != kNoNode) {
+        nodes[next].prev = prev;
+      } else {
+        mru = prev;
+      }
+    }
+
+    /**
+     * Puts an unlinked node on the free list, releasing whatever its key and
+     * value hold.
+     */
+    void Release(int32_t node) {
+      nodes[node].k = Key();
+      nodes[node].v = Val();
+      nodes[node].prev = kFreeNode;
+      nodes[node].next = free_list;
+      free_list = node;
+    }
+  };
+
+  /**
+   * Allocates cache-line aligned memory. new doesn't have to respect
+   * over-aligned types before C++17.
+   */
+  static void* AllocAligned(size_t size) {
+    void* mem = nullptr;
+    if (posix_memalign(&mem, kCacheLineSize, size) != 0) {
+      throw std::bad_alloc();
+    }
+    return mem;
+  }
+
+  /**
+   * @return the ring buffer stripe of the calling thread. Threads are
+   * numbered in the order they first call this, so up to num_stripes_
+   * threads each get their own.
+   */
+  int ThreadStripe() const {
+    static std::atomic<int> next_thread_id(0);
+    static thread_local int thread_id = next_thread_id.fetch_add(1);
+    return thread_id & (num_stripes_ - 1);
+  }
+
+  /**
+   * @return the shard that holds the given key
+   */
+  inline Shard& ShardFor(const Key& k) const {
+    if (num_shards_ == 1) {
+      return shards_[0];
+    }
+
+    // std::hash is the identity for integers, so the shard can't just be
+    // the hash's low bits
+    return shards_[FibonacciIndex(hash_fn_(k), num_shards_)];
+  }
+
+private:
+
+  // array of num_shards_ cache-line aligned shards
+  Shard* shards_ = nullptr;
+
+  // number of shards, a power of 2
+  int num_shards_ = 0;
+
+  // number of ring buffers per shard, a power of 2
+  int num_stripes_ = 1;
+
+  Hash hash_fn_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,533 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+
+namespace dsalgo {
+
+/**
+ * Hashmap with bucketized cuckoo hashing.
+ *
+ * The table is split into buckets of kSlotsPerBucket slots, and every key can
+ * only live in one of two buckets: its primary bucket, picked by the low bits
+ * of its hashcode, and an alternate bucket, found by XORing the primary
+ * bucket with a mix of the hashcode. Get() and Remove() therefore look at no
+ * more than 2 * kSlotsPerBucket slots no matter how unlucky the key is, which
+ * bounds the worst case lookup instead of just the average one.
+ *
+ * If both buckets of a new key are full, Put() searches breadth-first for a
+ * short chain of entries that can each move to their other bucket, ending in
+ * a bucket with a free slot, and shifts the entries along it to free a slot
+ * for the new key. If no such chain exists, the table doubles. Since the
+ * alternate bucket only depends on the current bucket and the hashcode, keys
+ * are never rehashed while moving them.
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class CuckooHashmap {
+
+public:
+
+  /**
+   * Creates a hashmap with the specified initial maximum capacity and load
+   * factor.
+   *
+   * @param init_capacity initial maximum capacity of the hashmap if the load
+   * factor were 1. Rounded up to the next power of 2.
+   * @param load_factor how soon to resize the hashmap. When the hashmap
+   * contains capacity * load_factor entries, it will double in size. Buckets
+   * let cuckoo hashing reach high load factors, hence the 0.9 default.
+   */
+  CuckooHashmap(int init_capacity, float load_factor=0.9)
+      : load_factor_(load_factor) {
+
+    if (init_capacity < 2 * kSlotsPerBucket) {
+      init_capacity = 2 * kSlotsPerBucket;
+    }
+
+    int table_size = IsPowerOf2(init_capacity) ?
+      init_capacity :
+      NextPowerOf2(init_capacity);
+
+    num_buckets_ = table_size / kSlotsPerBucket;
+    buckets_ = new Bucket[num_buckets_];
+  }
+
+  CuckooHashmap() : CuckooHashmap(8) {}
+
+  ~CuckooHashmap() {
+    FreeMem();
+  }
+
+  CuckooHashmap(const CuckooHashmap<Key, Val, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  CuckooHashmap(CuckooHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  CuckooHashmap<Key, Val, Hash, Eq>& operator=(
+      const CuckooHashmap<Key, Val, Hash, Eq>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  CuckooHashmap<Key, Val, Hash, Eq>& operator=(
+      CuckooHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Maps the given key to the given value, overwriting any previous mapping.
+   *
+   * Inserting may move other entries, so all references and pointers to
+   * values in the hashmap are invalidated by Put().
+   *
+   * @param k key to insert
+   * @param v value to which to map the key
+   * @throws length_error if more than 2 * kSlotsPerBucket keys would share a
+   * hash code
+   */
+  void Put(const Key& k, const Val& v) {
+    *FindOrInsert(k) = v;
+  }
+
+  /**
+   * Gets the value to which the given key is mapped, inserting a default
+   * constructed value if the key is not in the hashmap.
+   *
+   * @throws length_error if more than 2 * kSlotsPerBucket keys would share a
+   * hash code
+   */
+  Val& operator[](const Key& k) {
+    return *FindOrInsert(k);
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  Val* Get(const Key& k) const {
+    int hashcode = HashCode(k);
+    int bucket_idx = PrimaryBucket(hashcode);
+    int slot_idx = LocateSlotIdx(bucket_idx, k, hashcode);
+    if (slot_idx == -1) {
+      bucket_idx = AltBucket(bucket_idx, hashcode);
+      slot_idx = LocateSlotIdx(bucket_idx, k, hashcode);
+      if (slot_idx == -1) {
+        return nullptr;
+      }
+    }
+    return &buckets_[bucket_idx].entries[slot_idx].v;
+  }
+
+  /**
+   * Removes the given key from the hashmap if present. Otherwise, does nothing.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(const Key& k) {
+    int hashcode = HashCode(k);
+    int bucket_idx = PrimaryBucket(hashcode);
+    int slot_idx = LocateSlotIdx(bucket_idx, k, hashcode);
+    if (slot_idx == -1) {
+      bucket_idx = AltBucket(bucket_idx, hashcode);
+      slot_idx = LocateSlotIdx(bucket_idx, k, hashcode);
+      if (slot_idx == -1) {
+        return false;
+      }
+    }
+
+    // no other entry depends on this slot being full, so unlike linear
+    // probing nothing has to shift.
+    buckets_[bucket_idx].Invalidate(slot_idx);
+    --size_;
+    return true;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Removes all elements from this hashmap.
+   */
+  void Clear() {
+    for (int i = 0; i < num_buckets_; ++i) {
+      for (int j = 0; j < kSlotsPerBucket; ++j) {
+        buckets_[i].Invalidate(j);
+      }
+    }
+    size_ = 0;
+  }
+
+  /**
+   * Calls f(key, value) on every entry in this hashmap, in no particular
+   * order. f must not modify the hashmap.
+   */
+  template<class F>
+  void ForEach(F f) const {
+    for (int i = 0; i < num_buckets_; ++i) {
+      for (int j = 0; j < kSlotsPerBucket; ++j) {
+        if (buckets_[i].IsValid(j)) {
+          f(buckets_[i].entries[j].k, buckets_[i].entries[j].v);
+        }
+      }
+    }
+  }
+
+private:
+
+  static constexpr int kSlotsPerBucket = 4;
+
+  // maximum number of buckets to visit when searching for a chain of entries
+  // to move out of the way of a new key before giving up and resizing.
+  static constexpr int kMaxSearchBuckets = 512;
+
+  /**
+   * Represents a key-value pair in a bucket.
+   */
+  struct Entry {
+    Key k;
+    Val v;
+  };
+
+  /**
+   * A group of slots that a key can occupy any of. The hashcodes are kept
+   * together in front of the entries, so scanning a bucket for a key only
+   * compares keys whose hashcodes match.
+   */
+  struct Bucket {
+
+    // if hashcodes[i] is -1, that means entries[i] is not valid.
+    int hashcodes[kSlotsPerBucket];
+
+    Entry entries[kSlotsPerBucket];
+
+    Bucket() {
+      for (int i = 0; i < kSlotsPerBucket; ++i) {
+        hashcodes[i] = -1;
+      }
+    }
+
+    inline bool IsValid(int slot_idx) const {
+      return hashcodes[slot_idx] != -1;
+    }
+
+    inline void Invalidate(int slot_idx) {
+      hashcodes[slot_idx] = -1;
+      entries[slot_idx] = Entry();
+    }
+
+    /**
+     * @return the index of an empty slot in this bucket, or -1 if the bucket
+     * is full.
+     */
+    inline int FreeSlotIdx() const {
+      for (int i = 0; i < kSlotsPerBucket; ++i) {
+        if (hashcodes[i] == -1) {
+          return i;
+        }
+      }
+      return -1;
+    }
+  };
+
+  /**
+   * A bucket visited while searching for a chain of entries to move. The
+   * entry in slot_idx of the parent's bucket can move to this bucket.
+   */
+  struct SearchNode {
+    int bucket_idx;
+    int slot_idx;
+    int parent;
+  };
+
+  /**
+   * Frees any memory that has been allocated for this hashtable.
+   */
+  void FreeMem() {
+    if (buckets_ != nullptr) {
+      delete[] buckets_;
+      buckets_ = nullptr;
+    }
+  }
+
+  /**
+   * Copies another hashtable into this hashtable. Does not free any currently
+   * allocated memory though.
+   */
+  void CopyFrom(const CuckooHashmap<Key, Val, Hash, Eq>& other) {
+    buckets_ = new Bucket[other.num_buckets_];
+    std::copy(other.buckets_, other.buckets_ + other.num_buckets_, buckets_);
+    num_buckets_ = other.num_buckets_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = other.hash_fn_;
+    eq_fn_ = other.eq_fn_;
+  }
+
+  /**
+   * Moves another hashtable into this hashtable. The other hashtable is
+   * emptied and invalidated.
+   */
+  void MoveFrom(CuckooHashmap<Key, Val, Hash, Eq>& other) {
+    buckets_ = other.buckets_;
+    num_buckets_ = other.num_buckets_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = std::move(other.hash_fn_);
+    eq_fn_ = std::move(other.eq_fn_);
+
+    other.buckets_ = nullptr;
+  }
+
+  /**
+   * @return hash code for the given key
+   */
+  inline int HashCode(const Key& k) const {
+
+    // mix every bit in before truncating. A key can only go in two buckets,
+    // so keys whose hashes only differ in some of their bits, like integers
+    // under std::hash, can't be allowed to share a hash code.
+    return static_cast<int>(MurmurMix(hash_fn_(k)) >> 33);
+  }
+
+  /**
+   * @return the first bucket in which the hashcode can be stored.
+   */
+  inline int PrimaryBucket(int hashcode) const {
+    return hashcode & (num_buckets_ - 1);
+  }
+
+  /**
+   * @return the other bucket in which the hashcode can be stored, given one
+   * of its two buckets. The offset is odd, so the two buckets always differ,
+   * and XORing it again gets back the first bucket.
+   */
+  inline int AltBucket(int bucket_idx, int hashcode) const {
+    // murmur3 finalizer, so that keys sharing a primary bucket scatter
+    // to different alternate buckets. It maps 0 to 0, hence the offset.
+    uint32_t h = static_cast<uint32_t>(hashcode) + 0x9e3779b9;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return (bucket_idx ^ static_cast<int>(h | 1)) & (num_buckets_ - 1);
+  }
+
+  /**
+   * @return index of the slot in the given bucket that holds the key, or -1
+   * if the bucket does not hold the key.
+   */
+  inline int LocateSlotIdx(int bucket_idx, const Key& k, int hashcode) const {
+    const Bucket& bucket = buckets_[bucket_idx];
+    for (int i = 0; i < kSlotsPerBucket; ++i) {
+      if (bucket.hashcodes[i] == hashcode && eq_fn_(k, bucket.entries[i].k)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  /**
+   * @return pointer to the value for the key, inserting an entry with a
+   * default constructed value if the key is not in the hashmap.
+   */
+  Val* FindOrInsert(const Key& k) {
+    int hashcode = HashCode(k);
+    int bucket_idx = PrimaryBucket(hashcode);
+    int slot_idx = LocateSlotIdx(bucket_idx, k, hashcode);
+    if (slot_idx != -1) {
+      return &buckets_[bucket_idx].entries[slot_idx].v;
+    }
+    int alt_bucket_idx = AltBucket(bucket_idx, hashcode);
+    slot_idx = LocateSlotIdx(alt_bucket_idx, k, hashcode);
+    if (slot_idx != -1) {
+      return &buckets_[alt_bucket_idx].entries[slot_idx].v;
+    }
+
+    if (size_ + 1 > load_factor_ * num_buckets_ * kSlotsPerBucket) {
+      int num_buckets = num_buckets_ * 2;
+      while (size_ + 1 > load_factor_ * num_buckets * kSlotsPerBucket) {
+        num_buckets *= 2;
+      }
+      Resize(num_buckets);
+    }
+    while (!MakeRoom(hashcode, &bucket_idx, &slot_idx)) {
+
+      // at this load, random hashcodes essentially always find room, so
+      // more than 2 * kSlotsPerBucket keys must share this hashcode. No table
+      // size can hold them, so fail instead of growing forever.
+      if (size_ < num_buckets_ * kSlotsPerBucket / 16) {
+        throw std::length_error(
+            "Too many keys with the same hash code for a CuckooHashmap.");
+      }
+      Resize(num_buckets_ * 2);
+    }
+
+    Bucket& bucket = buckets_[bucket_idx];
+    bucket.hashcodes[slot_idx] = hashcode;
+    bucket.entries[slot_idx].k = k;
+    ++size_;
+    return &bucket.entries[slot_idx].v;
+  }
+
+  /**
+   * Frees a slot in one of the two buckets of the hashcode, moving entries to
+   * their alternate buckets if needed. Leaves the table untouched if there is
+   * no short enough chain of moves.
+   *
+   * @param bucket_idx set to the bucket of the free slot
+   * @param slot_idx set to the index of the free slot in the bucket
+   * @return if a slot was freed
+   */
+  bool MakeRoom(int hashcode, int* bucket_idx, int* slot_idx) {
+    int primary_bucket_idx = PrimaryBucket(hashcode);
+    search_queue_.clear();
+    search_queue_.push_back({primary_bucket_idx, -1, -1});
+    search_queue_.push_back({AltBucket(primary_bucket_idx, hashcode), -1, -1});
+
+    for (int head = 0; head < static_cast<int>(search_queue_.size()); ++head) {
+      const Bucket& bucket = buckets_[search_queue_[head].bucket_idx];
+      int free_slot_idx = bucket.FreeSlotIdx();
+      if (free_slot_idx != -1) {
+
+        // walk the chain back towards the new key's bucket, moving each entry
+        // into the slot freed by the move after it.
+        int node = head;
+        int to_bucket_idx = search_queue_[node].bucket_idx;
+        int to_slot_idx = free_slot_idx;
+        while (search_queue_[node].parent != -1) {
+          int from_bucket_idx =
+            search_queue_[search_queue_[node].parent].bucket_idx;
+          int from_slot_idx = search_queue_[node].slot_idx;
+          Bucket& from = buckets_[from_bucket_idx];
+          Bucket& to = buckets_[to_bucket_idx];
+          to.hashcodes[to_slot_idx] = from.hashcodes[from_slot_idx];
+          to.entries[to_slot_idx] = std::move(from.entries[from_slot_idx]);
+          from.hashcodes[from_slot_idx] = -1;
+          to_bucket_idx = from_bucket_idx;
+          to_slot_idx = from_slot_idx;
+          node = search_queue_[node].parent;
+        }
+        *bucket_idx = to_bucket_idx;
+        *slot_idx = to_slot_idx;
+        return true;
+      }
+
+      if (static_cast<int>(search_queue_.size()) + kSlotsPerBucket >
+          kMaxSearchBuckets) {
+        continue;
+      }
+      for (int i = 0; i < kSlotsPerBucket; ++i) {
+        search_queue_.push_back({
+            AltBucket(search_queue_[head].bucket_idx, bucket.hashcodes[i]),
+            i, head});
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Moves every entry into a table with the given number of buckets,
+   * doubling it further in the rare case that some entry can't be placed.
+   */
+  void Resize(int num_buckets) {
+
+    // tables that still hold entries to move. If a table turns out to be too
+    // small, the entries placed in it so far get moved out of it again.
+    std::vector<std::pair<Bucket*, int>> sources;
+    sources.push_back({buckets_, num_buckets_});
+    while (true) {
+      buckets_ = new Bucket[num_buckets];
+      num_buckets_ = num_buckets;
+      if (MoveEntriesFrom(sources)) {
+        break;
+      }
+      sources.push_back({buckets_, num_buckets_});
+      num_buckets *= 2;
+    }
+
+    for (const std::pair<Bucket*, int>& source : sources) {
+      delete[] source.first;
+    }
+  }
+
+  /**
+   * Moves the valid entries of the given tables into buckets_, invalidating
+   * them in their source.
+   *
+   * @return if all entries were moved
+   */
+  bool MoveEntriesFrom(const std::vector<std::pair<Bucket*, int>>& sources) {
+    for (const std::pair<Bucket*, int>& source : sources) {
+      for (int i = 0; i < source.second; ++i) {
+        Bucket& from = source.first[i];
+        for (int j = 0; j < kSlotsPerBucket; ++j) {
+          if (!from.IsValid(j)) {
+            continue;
+          }
+          int bucket_idx = 0;
+          int slot_idx = 0;
+          if (!MakeRoom(from.hashcodes[j], &bucket_idx, &slot_idx)) {
+            return false;
+          }
+          buckets_[bucket_idx].hashcodes[slot_idx] = from.hashcodes[j];
+          buckets_[bucket_idx].entries[slot_idx] = std::move(from.entries[j]);
+          from.hashcodes[j] = -1;
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+
+  // underlying table for the hashmap
+  Bucket* buckets_ = nullptr;
+
+  // number of buckets in the table, must be a power of 2 and at least 2.
+  int num_buckets_ = 0;
+
+  // number of entries in the hashmap.
+  int size_ = 0;
+
+  // hashmap will resize when number of entires exceeds
+  // num_buckets_ * kSlotsPerBucket * load_factor_
+  float load_factor_ = 0;
+
+  // reused by MakeRoom() so that inserting doesn't allocate
+  std::vector<SearchNode> search_queue_;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,507 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+
+namespace dsalgo {
+
+/**
+ * Insertion-ordered hashmap that keeps its entries packed in a contiguous
+ * array.
+ *
+ * Keys and values live in a dense array in the order they were inserted.
+ * Lookups go through a separate linear-probing index table of 32-bit
+ * positions in that array, so the sparse part of the hashmap costs only 4
+ * bytes per slot no matter how large the values are, and iterating the
+ * hashmap streams through the dense array without touching empty slots.
+ *
+ * Remove() leaves a hole in the dense array so that the order of the other
+ * entries is kept. Holes are skipped by iteration and squeezed out once
+ * they outnumber the entries, or when the index table grows.
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class DenseHashmap {
+
+public:
+
+  /**
+   * An entry of the dense array.
+   */
+  class Entry {
+
+  public:
+
+    const Key& key() const {
+      return k;
+    }
+
+    Val& value() {
+      return v;
+    }
+
+    const Val& value() const {
+      return v;
+    }
+
+  private:
+
+    friend class DenseHashmap;
+
+    Key k;
+    Val v;
+
+    // if hashcode is -1, the entry has been removed
+    int hashcode = -1;
+
+    inline bool IsValid() const {
+      return hashcode != -1;
+    }
+  };
+
+  /**
+   * Iterates over the entries of the hashmap in insertion order.
+   */
+  template<class E>
+  class Iterator {
+
+  public:
+
+    Iterator(E* entry, E* end) : entry_(entry), end_(end) {
+      SkipRemoved();
+    }
+
+    E& operator*() const {
+      return *entry_;
+    }
+
+    E* operator->() const {
+      return entry_;
+    }
+
+    Iterator& operator++() {
+      ++entry_;
+      SkipRemoved();
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return entry_ == other.entry_;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return entry_ != other.entry_;
+    }
+
+  private:
+
+    void SkipRemoved() {
+      while (entry_ != end_ && !entry_->IsValid()) {
+        ++entry_;
+      }
+    }
+
+    E* entry_;
+    E* end_;
+  };
+
+  typedef Iterator<Entry> iterator;
+  typedef Iterator<const Entry> const_iterator;
+
+  /**
+   * Creates a hashmap with the specified initial maximum capacity and load
+   * factor.
+   *
+   * @param init_capacity initial maximum capacity of the hashmap if the load
+   * factor were 1. Rounded up to the next power of 2.
+   * @param load_factor how soon to grow the index table. When the dense array
+   * holds index table size * load_factor entries, the index table doubles in
+   * size.
+   */
+  DenseHashmap(int init_capacity, float load_factor=0.7)
+      : load_factor_(load_factor) {
+
+    if (init_capacity < 8) {
+      init_capacity = 8;
+    }
+
+    index_size_ = IsPowerOf2(init_capacity) ?
+      init_capacity :
+      NextPowerOf2(init_capacity);
+
+    index_ = new int32_t[index_size_];
+    std::fill(index_, index_ + index_size_, -1);
+  }
+
+  DenseHashmap() : DenseHashmap(8) {}
+
+  ~DenseHashmap() {
+    FreeMem();
+  }
+
+  DenseHashmap(const DenseHashmap<Key, Val, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  DenseHashmap(DenseHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  DenseHashmap<Key, Val, Hash, Eq>& operator=(
+      const DenseHashmap<Key, Val, Hash, Eq>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  DenseHashmap<Key, Val, Hash, Eq>& operator=(
+      DenseHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Maps the given key to the given value, overwriting any previous mapping.
+   * New keys go after all the other entries in iteration order.
+   *
+   * Inserting may reallocate the dense array, so all references, pointers and
+   * iterators to entries in the hashmap are invalidated by Put().
+   *
+   * @param k key to insert
+   * @param v value to which to map the key
+   */
+  void Put(const Key& k, const Val& v) {
+    FindOrInsert(k)->v = v;
+  }
+
+  /**
+   * Gets the value to which the given key is mapped, inserting a default
+   * constructed value if the key is not in the hashmap.
+   */
+  Val& operator[](const Key& k) {
+    return FindOrInsert(k)->v;
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  Val* Get(const Key& k) const {
+    int slot = LocateSlot(k, HashCode(k));
+    return (index_[slot] != -1) ?
+      const_cast<Val*>(&entries_[index_[slot]].v) :
+      nullptr;
+  }
+
+  /**
+   * Removes the given key from the hashmap if present. Otherwise, does nothing.
+   * The other entries keep their order.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(const Key& k) {
+    int slot = LocateSlot(k, HashCode(k));
+    int entry_idx = index_[slot];
+    if (entry_idx == -1) {
+      return false;
+    }
+    RemoveSlot(slot);
+    --size_;
+
+    // the last entry can just be dropped. Otherwise, leave a hole and
+    // release the entry's resources.
+    if (entry_idx == static_cast<int>(entries_.size()) - 1) {
+      entries_.pop_back();
+    } else {
+      Entry& removed = entries_[entry_idx];
+      removed.hashcode = -1;
+      removed.k = Key();
+      removed.v = Val();
+      ++num_removed_;
+      if (num_removed_ > size_ && num_removed_ >= kMinRemovedToCompact) {
+        Rebuild(size_);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Removes all elements from this hashmap.
+   */
+  void Clear() {
+    entries_.clear();
+    std::fill(index_, index_ + index_size_, -1);
+    size_ = 0;
+    num_removed_ = 0;
+  }
+
+  /**
+   * Makes room for num_entries entries without growing the dense array or
+   * the index table.
+   */
+  void Reserve(int num_entries) {
+    entries_.reserve(num_entries);
+    if (num_entries >= load_factor_ * index_size_) {
+      Rebuild(num_entries);
+    }
+  }
+
+  /**
+   * Calls f(key, value) on every entry in this hashmap, in insertion order.
+   * f must not modify the hashmap.
+   */
+  template<class F>
+  void ForEach(F f) const {
+    const Entry* entries = entries_.data();
+    int num_entries = entries_.size();
+    if (num_removed_ == 0) {
+      for (int i = 0; i < num_entries; ++i) {
+        f(entries[i].k, entries[i].v);
+      }
+    } else {
+      for (int i = 0; i < num_entries; ++i) {
+        if (entries[i].IsValid()) {
+          f(entries[i].k, entries[i].v);
+        }
+      }
+    }
+  }
+
+  iterator begin() {
+    return iterator(entries_.data(), entries_.data() + entries_.size());
+  }
+
+  iterator end() {
+    Entry* end = entries_.data() + entries_.size();
+    return iterator(end, end);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(entries_.data(), entries_.data() + entries_.size());
+  }
+
+  const_iterator end() const {
+    const Entry* end = entries_.data() + entries_.size();
+    return const_iterator(end, end);
+  }
+
+private:
+
+  /**
+   * Frees any memory that has been allocated for this hashtable.
+   */
+  void FreeMem() {
+    if (index_ != nullptr) {
+      delete[] index_;
+      index_ = nullptr;
+    }
+    entries_.clear();
+  }
+
+  /**
+   * Copies another hashtable into this hashtable. Does not free any currently
+   * allocated memory though.
+   */
+  void CopyFrom(const DenseHashmap<Key, Val, Hash, Eq>& other) {
+    entries_ = other.entries_;
+    index_ = new int32_t[other.index_size_];
+    std::copy(other.index_, other.index_ + other.index_size_, index_);
+    index_size_ = other.index_size_;
+    size_ = other.size_;
+    num_removed_ = other.num_removed_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = other.hash_fn_;
+    eq_fn_ = other.eq_fn_;
+  }
+
+  /**
+   * Moves another hashtable into this hashtable. The other hashtable is
+   * emptied and invalidated.
+   */
+  void MoveFrom(DenseHashmap<Key, Val, Hash, Eq>& other) {
+    entries_ = std::move(other.entries_);
+    index_ = other.index_;
+    index_size_ = other.index_size_;
+    size_ = other.size_;
+    num_removed_ = other.num_removed_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = std::move(other.hash_fn_);
+    eq_fn_ = std::move(other.eq_fn_);
+
+    other.index_ = nullptr;
+  }
+
+  /**
+   * @return hash code for the given key
+   */
+  inline int HashCode(const Key& k) const {
+    return hash_fn_(k) & 0x7FFFFFFF;
+  }
+
+  /**
+   * @return the slot of the index table at which the hashcode belongs if
+   * there were no collisions.
+   */
+  inline int SlotFor(int hashcode) const {
+    return hashcode & (index_size_ - 1);
+  }
+
+  /**
+   * @return slot of the index table that points to the key's entry, or the
+   * empty slot at which the key should be inserted if the key is not in the
+   * hashmap. The index table is never full, so there is always one.
+   */
+  int LocateSlot(const Key& k, int hashcode) const {
+    int slot = SlotFor(hashcode);
+    while (index_[slot] != -1) {
+      const Entry& entry = entries_[index_[slot]];
+      if (entry.hashcode == hashcode && eq_fn_(k, entry.k)) {
+        return slot;
+      }
+      slot = (slot + 1) & (index_size_ - 1);
+    }
+    return slot;
+  }
+
+  /**
+   * @return the entry for the key, appending a new entry with a default
+   * constructed value if the key is not in the hashmap.
+   */
+  Entry* FindOrInsert(const Key& k) {
+    int hashcode = HashCode(k);
+    int slot = LocateSlot(k, hashcode);
+    if (index_[slot] != -1) {
+      return &entries_[index_[slot]];
+    }
+
+    // holes count towards the load because they are only squeezed out by
+    // rebuilding the index table
+    if (entries_.size() + 1 >= load_factor_ * index_size_) {
+      Rebuild(size_ + 1);
+      slot = LocateSlot(k, hashcode);
+    }
+
+    index_[slot] = entries_.size();
+    entries_.emplace_back();
+    Entry& entry = entries_.back();
+    entry.k = k;
+    entry.hashcode = hashcode;
+    ++size_;
+    return &entry;
+  }
+
+  /**
+   * Empties the given slot of the index table, shifting later slots in its
+   * chain of collisions back so that linear probing still finds them.
+   */
+  void RemoveSlot(int slot) {
+    int mask = index_size_ - 1;
+    int unoccupied = slot;
+    int to_check = slot;
+    while (true) {
+      to_check = (to_check + 1) & mask;
+      if (index_[to_check] == -1) {
+        break;
+      }
+
+      // an entry can fill the unoccupied slot if that doesn't move it before
+      // its home slot, i.e. it is at least as far from home as from the
+      // unoccupied slot
+      int home = SlotFor(entries_[index_[to_check]].hashcode);
+      if (((to_check - home) & mask) >= ((to_check - unoccupied) & mask)) {
+        index_[unoccupied] = index_[to_check];
+        unoccupied = to_check;
+      }
+    }
+    index_[unoccupied] = -1;
+  }
+
+  /**
+   * Squeezes the holes left by Remove() out of the dense array, keeping the
+   * order of the entries, and doubles the index table until num_entries
+   * entries fit under the load factor. Then re-indexes every entry.
+   */
+  void Rebuild(int num_entries) {
+    if (num_removed_ > 0) {
+      auto is_removed = [](const Entry& e) { return !e.IsValid(); };
+      entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+            is_removed), entries_.end());
+      num_removed_ = 0;
+    }
+
+    int new_index_size = index_size_;
+    while (num_entries >= load_factor_ * new_index_size) {
+      new_index_size *= 2;
+    }
+    if (new_index_size != index_size_) {
+      delete[] index_;
+      index_size_ = new_index_size;
+      index_ = new int32_t[index_size_];
+    }
+    std::fill(index_, index_ + index_size_, -1);
+
+    // entries are known to be distinct, so just find each one an empty slot
+    for (int i = 0; i < static_cast<int>(entries_.size()); ++i) {
+      int slot = SlotFor(entries_[i].hashcode);
+      while (index_[slot] != -1) {
+        slot = (slot + 1) & (index_size_ - 1);
+      }
+      index_[slot] = i;
+    }
+  }
+
+private:
+
+  // minimum number of holes in the dense array before Remove() squeezes them
+  // out, so small maps don't rebuild their index on every other Remove().
+  static constexpr int kMinRemovedToCompact = 16;
+
+  // keys and values in insertion order, including holes left by Remove()
+  std::vector<Entry> entries_;
+
+  // index table of positions in entries_. -1 marks an empty slot.
+  int32_t* index_ = nullptr;
+
+  // size of the index table, must be a power of 2.
+  int index_size_ = 0;
+
+  // number of entries in the hashmap.
+  int size_ = 0;
+
+  // number of holes in entries_
+  int num_removed_ = 0;
+
+  // index table will grow when entries_ (including holes) reaches
+  // index_size_ * load_factor_
+  float load_factor_ = 0;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,495 @@
+#pragma once
+
+#include "Hashmap.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <limits>
+#include <stdint.h>
+
+
+namespace dsalgo {
+
+/**
+ * Hashmap whose entries expire a given amount of time after they were put.
+ *
+ * Time is whatever integer clock the caller advances the map with, e.g.
+ * milliseconds since startup. Advance() moves the map's current time forward
+ * and does a bounded amount of reclamation work. An entry whose deadline has
+ * passed is never returned, and is reclaimed either when it's next looked up
+ * or by that background work, whichever comes first.
+ *
+ * The background work is driven by a hierarchical timer wheel. Level 0 has a
+ * slot for each of the next kSlotsPerLevel ticks, level 1 a slot for each of
+ * the next kSlotsPerLevel spans of kSlotsPerLevel ticks, and so on. Every
+ * entry sits in a doubly linked list in a slot no later than its deadline,
+ * so putting, updating and removing an entry is O(1). Each tick empties the
+ * level 0 slot for that tick, and at the start of each span, the higher
+ * level slot for that span, whose entries are reinserted into lower levels.
+ * Entries move down a level at most kLevels times, and no operation ever
+ * scans the whole table.
+ *
+ * Each level also keeps a bitmask of its slots that may have entries, so
+ * the wheel jumps straight to the next tick that empties one of them instead
+ * of turning through every tick in between. The work therefore grows with
+ * the number of entries, not with how much time has passed.
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class ExpiringHashmap {
+
+public:
+
+  /**
+   * @param now current time. Deadlines are measured from it until the first
+   * Advance().
+   */
+  ExpiringHashmap(int64_t now=0) : now_(now), wheel_time_(now) {
+    AllocWheel();
+  }
+
+  ~ExpiringHashmap() {
+    FreeMem();
+  }
+
+  ExpiringHashmap(const ExpiringHashmap<Key, Val, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  ExpiringHashmap(ExpiringHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  ExpiringHashmap<Key, Val, Hash, Eq>& operator=(
+      const ExpiringHashmap<Key, Val, Hash, Eq>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  ExpiringHashmap<Key, Val, Hash, Eq>& operator=(
+      ExpiringHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Maps the given key to the given value until ttl after the current time.
+   * If the key is already mapped, its value and deadline are both replaced.
+   *
+   * @param k key to insert
+   * @param v value to which to map the key
+   * @param ttl how long the entry lives. The entry has expired once the
+   * current time reaches its deadline, so a ttl <= 0 entry is never found.
+   */
+  void Put(const Key& k, const Val& v, int64_t ttl) {
+    Node** existing = index_.Get(k);
+    if (ttl <= 0) {
+      // already expired, so it would only wait in the wheel to be reclaimed
+      if (existing != nullptr) {
+        Erase(*existing);
+      }
+      return;
+    }
+
+    int64_t deadline = now_ + ttl;
+    if (existing != nullptr) {
+      Node* node = *existing;
+      node->v = v;
+      if (deadline >= node->deadline) {
+        // the wheel reaches the node's slot by its old deadline at the
+        // latest, and reschedules it then. Refreshing a deadline therefore
+        // doesn't touch the neighbouring nodes in the slot.
+        node->deadline = deadline;
+        return;
+      }
+      Unlink(node);
+      node->deadline = deadline;
+      Schedule(node, wheel_time_ + 1);
+      return;
+    }
+
+    Node* node = new Node(k, v);
+    node->deadline = deadline;
+    index_.Put(k, node);
+    Schedule(node, wheel_time_ + 1);
+  }
+
+  /**
+   * Gets the value to which the given key maps. An entry found expired is
+   * reclaimed.
+   *
+   * @return a pointer to the value, or nullptr if the key is not mapped or
+   * has expired. Invalidated by the next call that modifies the map.
+   */
+  Val* Get(const Key& k) {
+    Node** existing = index_.Get(k);
+    if (existing == nullptr) {
+      return nullptr;
+    }
+    Node* node = *existing;
+    if (node->deadline <= now_) {
+      Erase(node);
+      return nullptr;
+    }
+    return &node->v;
+  }
+
+  /**
+   * @return the deadline of the given key's entry, or -1 if the key is not
+   * mapped or has expired. Does not reclaim expired entries.
+   */
+  int64_t GetDeadline(const Key& k) const {
+    Node* const* existing = index_.Get(k);
+    if (existing == nullptr || (*existing)->deadline <= now_) {
+      return -1;
+    }
+    return (*existing)->deadline;
+  }
+
+  /**
+   * Removes the given key from the map if present.
+   *
+   * @return if the key was mapped and hadn't expired
+   */
+  bool Remove(const Key& k) {
+    Node** existing = index_.Get(k);
+    if (existing == nullptr) {
+      return false;
+    }
+    bool live = (*existing)->deadline > now_;
+    Erase(*existing);
+    return live;
+  }
+
+  /**
+   * Moves the current time forward to now, then reclaims expired entries
+   * until there is nothing left to reclaim or max_work units of work have
+   * been done. Each reclaimed entry, entry moved down a level of the wheel,
+   * and turn of the wheel to the next tick with entries to process costs one
+   * unit. Work left over is picked up by later calls. Time never moves
+   * backwards, so an earlier now only does the leftover work.
+   *
+   * @return if the wheel caught up with the current time, i.e. every entry
+   * that has expired has been reclaimed
+   */
+  bool Advance(int64_t now, int max_work=kDefaultMaxWork) {
+    now_ = std::max(now_, now);
+    for (int work = 0; work < max_work; ++work) {
+      if (due_->next != due_) {
+        ProcessDue(static_cast<Node*>(due_->next));
+      } else if (wheel_time_ < now_) {
+        if (index_.Size() == 0) {
+          // nothing to reclaim at any of the ticks in between
+          wheel_time_ = now_;
+          std::fill(occupied_, occupied_ + kLevels, 0);
+        } else {
+          Tick();
+        }
+      } else {
+        return true;
+      }
+    }
+    return due_->next == due_ && wheel_time_ == now_;
+  }
+
+  /**
+   * @return current time
+   */
+  int64_t Now() const {
+    return now_;
+  }
+
+  /**
+   * @return number of entries, including expired entries that haven't been
+   * reclaimed yet.
+   */
+  int Size() const {
+    return index_.Size();
+  }
+
+  /**
+   * Removes every entry. The current time stays the same.
+   */
+  void Clear() {
+    FreeNodes();
+    index_.Clear();
+    ResetWheel();
+  }
+
+private:
+
+  /**
+   * Links of a doubly linked list. Each slot of the wheel is a circular list
+   * with a sentinel Links as its head.
+   */
+  struct Links {
+    Links* prev = this;
+    Links* next = this;
+  };
+
+  /**
+   * Represents an entry in the map.
+   */
+  struct Node : public Links {
+    Key k;
+    Val v;
+    int64_t deadline = 0;
+
+    Node(const Key& key, const Val& val) : k(key), v(val) {}
+  };
+
+  static constexpr int kLevelBits = 6;
+
+  static constexpr int kSlotsPerLevel = 1 << kLevelBits;
+
+  // levels of the wheel. Deadlines further than 2^(kLevels * kLevelBits)
+  // ticks out are parked in the top level until they get closer.
+  static constexpr int kLevels = 6;
+
+  // wheel slots, plus the head of due_
+  static constexpr int kNumHeads = kLevels * kSlotsPerLevel + 1;
+
+  static constexpr int kDefaultMaxWork = 1024;
+
+  /**
+   * Allocates an empty wheel.
+   */
+  void AllocWheel() {
+    wheel_ = new Links[kNumHeads];
+    due_ = wheel_ + kNumHeads - 1;
+  }
+
+  /**
+   * Empties every slot of the wheel without touching the nodes in them.
+   */
+  void ResetWheel() {
+    for (int i = 0; i < kNumHeads; ++i) {
+      wheel_[i].prev = wheel_ + i;
+      wheel_[i].next = wheel_ + i;
+    }
+    std::fill(occupied_, occupied_ + kLevels, 0);
+  }
+
+  /**
+   * Deletes every node.
+   */
+  void FreeNodes() {
+    index_.ForEach([](const Key&, Node* node) {
+      delete node;
+    });
+  }
+
+  /**
+   * Frees any memory that has been allocated for this map.
+   */
+  void FreeMem() {
+    if (wheel_ != nullptr) {
+      FreeNodes();
+      delete[] wheel_;
+      wheel_ = nullptr;
+    }
+  }
+
+  /**
+   * Copies another map into this map, scheduling copies of its entries on a
+   * new wheel. Does not free any currently allocated memory though.
+   */
+  void CopyFrom(const ExpiringHashmap<Key, Val, Hash, Eq>& other) {
+    now_ = other.now_;
+    wheel_time_ = other.wheel_time_;
+    std::fill(occupied_, occupied_ + kLevels, 0);
+    AllocWheel();
+    index_ = Hashmap<Key, Node*, Hash, Eq>(other.index_.Size() + 1);
+    other.index_.ForEach([this](const Key& k, const Node* other_node) {
+      Node* node = new Node(k, other_node->v);
+      node->deadline = other_node->deadline;
+      index_.Put(k, node);
+      Schedule(node, wheel_time_ + 1);
+    });
+  }
+
+  /**
+   * Moves another map into this map. The other map is emptied and
+   * invalidated.
+   */
+  void MoveFrom(ExpiringHashmap<Key, Val, Hash, Eq>& other) {
+    now_ = other.now_;
+    wheel_time_ = other.wheel_time_;
+    wheel_ = other.wheel_;
+    due_ = other.due_;
+    std::copy(other.occupied_, other.occupied_ + kLevels, occupied_);
+    index_ = std::move(other.index_);
+
+    other.wheel_ = nullptr;
+    other.due_ = nullptr;
+  }
+
+  /**
+   * Appends the node to the list with the given head.
+   */
+  static void Append(Links* head, Node* node) {
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+  }
+
+  /**
+   * Removes the node from the list it is in.
+   */
+  static void Unlink(Node* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+  }
+
+  /**
+   * Moves every node of the list with the given head to the end of due_.
+   */
+  void SpliceIntoDue(Links* head) {
+    if (head->next == head) {
+      return;
+    }
+    head->next->prev = due_->prev;
+    due_->prev->next = head->next;
+    head->prev->next = due_;
+    due_->prev = head->prev;
+    head->prev = head;
+    head->next = head;
+  }
+
+  /**
+   * Unlinks, unmaps and deletes the node.
+   */
+  void Erase(Node* node) {
+    Unlink(node);
+    index_.Remove(node->k);
+    delete node;
+  }
+
+  /**
+   * Puts the node in the wheel slot for its deadline, or for earliest_tick
+   * if its deadline is earlier. Ticks up to wheel_time_ have already been
+   * processed, so earliest_tick must be after wheel_time_.
+   *
+   * A deadline goes on the lowest level whose span, starting from the
+   * current one, contains it: the level of the highest kLevelBits group of
+   * bits in which it differs from wheel_time_.
+   */
+  void Schedule(Node* node, int64_t earliest_tick) {
+    uint64_t tick = std::max(node->deadline, earliest_tick);
+    uint64_t diff = tick ^ static_cast<uint64_t>(wheel_time_);
+    int level = (63 - __builtin_clzll(diff)) / kLevelBits;
+    if (level >= kLevels) {
+      // too far out. Park it at the end of the wheel's horizon, where it
+      // will be scheduled again.
+      level = kLevels - 1;
+      tick = static_cast<uint64_t>(wheel_time_) |
+        ((uint64_t(1) << (kLevels * kLevelBits)) - 1);
+    }
+    int slot = (tick >> (level * kLevelBits)) & (kSlotsPerLevel - 1);
+    Append(wheel_ + level * kSlotsPerLevel + slot, node);
+    occupied_[level] |= uint64_t(1) << slot;
+  }
+
+  /**
+   * @return the first tick after wheel_time_ that empties a slot whose bit
+   * is set in occupied_, or the maximum int64_t if there's none.
+   *
+   * A node below the top level is always in a slot after wheel_time_'s slot
+   * on that level, in the same span of the level above, so only those slots
+   * have to be looked at. The first of them is emptied at the start of its
+   * span. Nodes parked on the top level may also be in the top level's next
+   * rotation.
+   */
+  int64_t NextBusyTick() const {
+    uint64_t t = static_cast<uint64_t>(wheel_time_);
+    uint64_t next = std::numeric_limits<int64_t>::max();
+    for (int level = 0; level < kLevels; ++level) {
+      int shift = level * kLevelBits;
+      int span_shift = shift + kLevelBits;
+      uint64_t span_start = (t >> span_shift) << span_shift;
+      int current_slot = (t >> shift) & (kSlotsPerLevel - 1);
+      uint64_t later_slots = (current_slot == kSlotsPerLevel - 1) ? 0 :
+        occupied_[level] & (~uint64_t(0) << (current_slot + 1));
+      if (later_slots != 0) {
+        next = std::min(next,
+            span_start | (uint64_t(__builtin_ctzll(later_slots)) << shift));
+      } else if (level == kLevels - 1 && occupied_[level] != 0) {
+        next = std::min(next, (span_start + (uint64_t(1) << span_shift)) |
+            (uint64_t(__builtin_ctzll(occupied_[level])) << shift));
+      }
+    }
+    return static_cast<int64_t>(next);
+  }
+
+  /**
+   * Turns the wheel to the next tick that empties a slot with nodes in it,
+   * or to the current time if that's sooner. Moves the level 0 slot for that
+   * tick, and the slot of each higher level whose next span starts at that
+   * tick, into due_, where ProcessDue() reclaims or reschedules them.
+   */
+  void Tick() {
+    int64_t next = NextBusyTick();
+    if (next > now_) {
+      // nothing to reclaim at any of the ticks in between
+      wheel_time_ = now_;
+      return;
+    }
+    wheel_time_ = next;
+    uint64_t t = static_cast<uint64_t>(wheel_time_);
+    for (int level = 0; level < kLevels; ++level) {
+      int shift = level * kLevelBits;
+      if (level > 0 && (t & ((uint64_t(1) << shift) - 1)) != 0) {
+        break;
+      }
+      int slot = (t >> shift) & (kSlotsPerLevel - 1);
+      SpliceIntoDue(wheel_ + level * kSlotsPerLevel + slot);
+      occupied_[level] &= ~(uint64_t(1) << slot);
+    }
+  }
+
+  /**
+   * Reclaims the node from due_ if it has expired, and otherwise schedules
+   * it again, on a lower level than it came from.
+   */
+  void ProcessDue(Node* node) {
+    if (node->deadline <= wheel_time_) {
+      Erase(node);
+    } else {
+      Unlink(node);
+      Schedule(node, wheel_time_ + 1);
+    }
+  }
+
+private:
+
+  // current time
+  int64_t now_ = 0;
+
+  // every tick up to and including this one has been processed by the
+  // wheel. Never after now_.
+  int64_t wheel_time_ = 0;
+
+  // kLevels levels of kSlotsPerLevel list heads, then the head of due_
+  Links* wheel_ = nullptr;
+
+  // nodes taken out of the wheel by Tick() that still have to be reclaimed
+  // or rescheduled
+  Links* due_ = nullptr;
+
+  // bit i of occupied_[level] is set if slot i of the level may have nodes
+  // in it. Removing a node doesn't clear its slot's bit, which only costs
+  // Tick() a visit to an empty slot.
+  uint64_t occupied_[kLevels] = {};
+
+  // every node, expired or not
+  Hashmap<Key, Node*, Hash, Eq> index_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+
+namespace dsalgo {
+
+/**
+ * Count-min sketch of 4-bit counters that estimates how often each hash was
+ * seen recently, for admission policies like TinyLfuCache.
+ *
+ * Counters are packed 16 to a 64-bit word. Every hash has one counter in each
+ * of kDepth rows, and its estimated frequency is the smallest of them, so
+ * collisions can only overestimate it. All of a hash's counters are in one
+ * 64-byte block, two words per row, so an update or lookup touches a single
+ * cache line instead of kDepth random ones. Increment() only bumps the
+ * counters equal to that smallest one (conservative update), which keeps the
+ * overestimates lower.
+ * Counters saturate at 15, which is plenty for comparing a popular key with
+ * an unpopular one.
+ *
+ * To favor recent history, all counters are halved every time the number of
+ * increments reaches 10 times the expected number of distinct keys.
+ *
+ * Keys have to be hashed by the caller. Hashes are mixed again before use,
+ * so identity hashes like std::hash for integers are fine.
+ */
+class FrequencySketch {
+
+public:
+
+  /**
+   * @param num_keys number of keys whose frequencies should be told apart,
+   * e.g. a cache's capacity. Takes about 8 bytes per key.
+   */
+  explicit FrequencySketch(int64_t num_keys)
+      : words_(NextPowerOf2(std::max<int64_t>(num_keys, kWordsPerBlock)), 0),
+        block_mask_(words_.size() / kWordsPerBlock - 1),
+        sample_size_(10 * std::max<int64_t>(num_keys, 1)) {}
+
+  /**
+   * Records one occurrence of the hash.
+   */
+  void Increment(uint64_t hash) {
+    uint64_t mixed = Mix(hash);
+    int64_t counters[kDepth];
+    int min_count = kMaxCount;
+    for (int i = 0; i < kDepth; ++i) {
+      counters[i] = CounterFor(mixed, i);
+      min_count = std::min(min_count, Count(counters[i]));
+    }
+    if (min_count < kMaxCount) {
+      for (int i = 0; i < kDepth; ++i) {
+        if (Count(counters[i]) == min_count) {
+          words_[counters[i] / kCountersPerWord] +=
+            1ULL << Shift(counters[i]);
+        }
+      }
+    }
+    if (++num_increments_ >= sample_size_) {
+      Age();
+    }
+  }
+
+  /**
+   * @return estimated number of occurrences of the hash, between 0 and 15
+   */
+  int Frequency(uint64_t hash) const {
+    uint64_t mixed = Mix(hash);
+    int min_count = kMaxCount;
+    for (int i = 0; i < kDepth; ++i) {
+      min_count = std::min(min_count, Count(CounterFor(mixed, i)));
+    }
+    return min_count;
+  }
+
+  /**
+   * Resets every counter to 0.
+   */
+  void Clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+    num_increments_ = 0;
+  }
+
+private:
+
+  // number of rows, i.e. counters per hash
+  static constexpr int kDepth = 4;
+
+  static constexpr int kCountersPerWord = 16;
+
+  // one cache line
+  static constexpr int kWordsPerBlock = 8;
+
+  static constexpr int kMaxCount = 15;
+
+  /**
+   * splitmix64's finalizer
+   */
+  static uint64_t Mix(uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+  }
+
+  /**
+   * @return index of the mixed hash's counter in the given row. The high 32
+   * bits pick the block, and each row takes 5 of the low 32 bits to pick one
+   * of the 32 counters in its two words of the block.
+   */
+  int64_t CounterFor(uint64_t mixed, int row) const {
+    uint64_t block = (mixed >> 32) & block_mask_;
+    uint64_t bits = mixed >> (row * 8);
+    uint64_t word = block * kWordsPerBlock + row * 2 + (bits & 1);
+    return static_cast<int64_t>(word * kCountersPerWord + ((bits >> 1) & 15));
+  }
+
+  static int Shift(int64_t counter) {
+    return (counter % kCountersPerWord) * 4;
+  }
+
+  int Count(int64_t counter) const {
+    return (words_[counter / kCountersPerWord] >> Shift(counter)) & 0xF;
+  }
+
+  /**
+   * Halves every counter, so that old occurrences count for less and less.
+   */
+  void Age() {
+    for (uint64_t& word : words_) {
+      word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    num_increments_ /= 2;
+  }
+
+private:
+
+  std::vector<uint64_t> words_;
+
+  // number of blocks - 1
+  uint64_t block_mask_ = 0;
+
+  // number of increments between agings
+  int64_t sample_size_ = 0;
+
+  int64_t num_increments_ = 0;
+};
+
+} // namespace dsalgo
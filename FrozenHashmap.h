@@ -0,0 +1,474 @@
+#pragma once
+
+#include "Hashmap.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace dsalgo {
+
+/**
+ * Header at the beginning of every serialized FrozenHashmap. Records the
+ * layout the buffer was written with, so that a buffer can't be read back
+ * with the wrong key or value types.
+ */
+struct FrozenHashmapHeader {
+  char magic[8];
+
+  // sizeof() the key, value and table entry types
+  uint32_t key_size;
+  uint32_t val_size;
+  uint32_t entry_size;
+
+  // number of entries, which is also the number of slots in the table
+  int32_t size;
+
+  // number of displacement buckets
+  int32_t num_buckets;
+
+  int32_t padding;
+};
+
+
+/**
+ * Read-only hashmap built from a fixed set of entries with a minimal perfect
+ * hash function, using hash and displace (CHD).
+ *
+ * Keys are first hashed into small buckets of about kKeysPerBucket keys.
+ * Going from the largest bucket to the smallest, the builder searches for a
+ * seed per bucket that sends every key of the bucket to a slot that is still
+ * free. Buckets with one key just take a free slot directly. The table ends
+ * up with exactly one slot per entry, and a lookup reads one seed and then
+ * one slot, no matter how many keys there are.
+ *
+ * A lookup for a key that isn't in the map also lands on some slot, so the
+ * keys are kept to tell hits from misses.
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class FrozenHashmap {
+
+public:
+
+  /**
+   * Builds a hashmap that holds exactly the given entries.
+   *
+   * @throws invalid_argument if a key appears more than once, or if two keys
+   * have the same hash
+   */
+  FrozenHashmap(const std::vector<std::pair<Key, Val>>& entries) {
+    Build(entries);
+  }
+
+  /**
+   * Builds a hashmap that holds the same entries as the given hashmap.
+   *
+   * @throws invalid_argument if two keys have the same hash
+   */
+  template<class H, class E, class I>
+  FrozenHashmap(const Hashmap<Key, Val, H, E, I>& map) {
+    std::vector<std::pair<Key, Val>> entries;
+    entries.reserve(map.Size());
+    map.ForEach([&](const Key& k, const Val& v) {
+      entries.emplace_back(k, v);
+    });
+    Build(entries);
+  }
+
+  FrozenHashmap() : FrozenHashmap(std::vector<std::pair<Key, Val>>()) {}
+
+  ~FrozenHashmap() {
+    FreeMem();
+  }
+
+  FrozenHashmap(const FrozenHashmap<Key, Val, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  FrozenHashmap(FrozenHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  FrozenHashmap<Key, Val, Hash, Eq>& operator=(
+      const FrozenHashmap<Key, Val, Hash, Eq>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  FrozenHashmap<Key, Val, Hash, Eq>& operator=(
+      FrozenHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  const Val* Get(const Key& k) const {
+    if (UNLIKELY(size_ == 0)) {
+      return nullptr;
+    }
+    const Entry& entry = entries_[SlotFor(HashCode(k))];
+    return eq_fn_(k, entry.k) ? &entry.v : nullptr;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Calls f(key, value) on every entry in this hashmap, in no particular
+   * order.
+   */
+  template<class F>
+  void ForEach(F f) const {
+    for (int i = 0; i < size_; ++i) {
+      f(entries_[i].k, entries_[i].v);
+    }
+  }
+
+  /**
+   * Writes this hashmap into a flat buffer that Deserialize() can read back,
+   * e.g. after storing it in a file or sending it to another process. Only
+   * supported for trivially copyable keys and values.
+   */
+  std::vector<char> Serialize() const {
+    static_assert(std::is_trivially_copyable<Key>::value &&
+        std::is_trivially_copyable<Val>::value,
+        "Only trivially copyable keys and values can be serialized");
+
+    FrozenHashmapHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, Magic(), sizeof(header.magic));
+    header.key_size = sizeof(Key);
+    header.val_size = sizeof(Val);
+    header.entry_size = sizeof(Entry);
+    header.size = size_;
+    header.num_buckets = num_buckets_;
+
+    size_t seeds_bytes = sizeof(int32_t) * num_buckets_;
+    size_t entries_bytes = sizeof(Entry) * size_;
+    std::vector<char> buf(sizeof(header) + seeds_bytes + entries_bytes);
+    std::memcpy(buf.data(), &header, sizeof(header));
+    std::memcpy(buf.data() + sizeof(header), seeds_, seeds_bytes);
+    if (size_ > 0) {
+      std::memcpy(buf.data() + sizeof(header) + seeds_bytes, entries_,
+          entries_bytes);
+    }
+    return buf;
+  }
+
+  /**
+   * Reads back a hashmap written by Serialize(). The buffer does not need to
+   * be aligned and is not referenced afterwards.
+   *
+   * @throws invalid_argument if the buffer wasn't written by a FrozenHashmap
+   * with the same key and value types, is truncated, or has a seed that
+   * points outside the table
+   */
+  static FrozenHashmap<Key, Val, Hash, Eq> Deserialize(const char* data,
+      size_t num_bytes) {
+    static_assert(std::is_trivially_copyable<Key>::value &&
+        std::is_trivially_copyable<Val>::value,
+        "Only trivially copyable keys and values can be serialized");
+
+    FrozenHashmapHeader header;
+    if (num_bytes < sizeof(header)) {
+      throw std::invalid_argument("Buffer too small for a FrozenHashmap.");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, Magic(), sizeof(header.magic)) != 0) {
+      throw std::invalid_argument("Buffer is not a FrozenHashmap.");
+    }
+    if (header.key_size != sizeof(Key) || header.val_size != sizeof(Val) ||
+        header.entry_size != sizeof(Entry)) {
+      throw std::invalid_argument(
+          "FrozenHashmap was written with different key or value types.");
+    }
+    if (header.size < 0 || header.num_buckets < 1) {
+      throw std::invalid_argument("FrozenHashmap header is corrupted.");
+    }
+    size_t seeds_bytes = sizeof(int32_t) * header.num_buckets;
+    size_t entries_bytes = sizeof(Entry) * header.size;
+    if (num_bytes < sizeof(header) + seeds_bytes + entries_bytes) {
+      throw std::invalid_argument("FrozenHashmap buffer is truncated.");
+    }
+
+    FrozenHashmap<Key, Val, Hash, Eq> map;
+    map.FreeMem();
+    map.size_ = header.size;
+    map.num_buckets_ = header.num_buckets;
+    map.seeds_ = new int32_t[map.num_buckets_];
+    std::memcpy(map.seeds_, data + sizeof(header), seeds_bytes);
+    for (int b = 0; b < map.num_buckets_; ++b) {
+      // a bucket with a single key stores its slot, which Get() trusts
+      if (map.seeds_[b] < 0 && -(map.seeds_[b] + 1) >= map.size_) {
+        throw std::invalid_argument("FrozenHashmap seeds are corrupted.");
+      }
+    }
+    if (map.size_ > 0) {
+      map.entries_ = new Entry[map.size_];
+      std::memcpy(map.entries_, data + sizeof(header) + seeds_bytes,
+          entries_bytes);
+    }
+    return map;
+  }
+
+private:
+
+  // average number of keys hashed to each displacement bucket. Larger
+  // buckets take less memory for seeds but longer to build.
+  static constexpr int kKeysPerBucket = 4;
+
+  /**
+   * @return identifies a buffer written by Serialize(). Includes a version
+   * number, so that a changed layout can't be misread.
+   */
+  static const char* Magic() {
+    return "DSFROZ1";
+  }
+
+  /**
+   * Represents an entry in the hashmap.
+   */
+  struct Entry {
+    Key k;
+    Val v;
+  };
+
+  /**
+   * Frees any memory that has been allocated for this hashtable.
+   */
+  void FreeMem() {
+    if (seeds_ != nullptr) {
+      delete[] seeds_;
+      seeds_ = nullptr;
+    }
+    if (entries_ != nullptr) {
+      delete[] entries_;
+      entries_ = nullptr;
+    }
+  }
+
+  /**
+   * Copies another hashtable into this hashtable. Does not free any currently
+   * allocated memory though.
+   */
+  void CopyFrom(const FrozenHashmap<Key, Val, Hash, Eq>& other) {
+    seeds_ = new int32_t[other.num_buckets_];
+    std::copy(other.seeds_, other.seeds_ + other.num_buckets_, seeds_);
+    if (other.size_ > 0) {
+      entries_ = new Entry[other.size_];
+      std::copy(other.entries_, other.entries_ + other.size_, entries_);
+    }
+    size_ = other.size_;
+    num_buckets_ = other.num_buckets_;
+    hash_fn_ = other.hash_fn_;
+    eq_fn_ = other.eq_fn_;
+  }
+
+  /**
+   * Moves another hashtable into this hashtable. The other hashtable is
+   * emptied and invalidated.
+   */
+  void MoveFrom(FrozenHashmap<Key, Val, Hash, Eq>& other) {
+    seeds_ = other.seeds_;
+    entries_ = other.entries_;
+    size_ = other.size_;
+    num_buckets_ = other.num_buckets_;
+    hash_fn_ = std::move(other.hash_fn_);
+    eq_fn_ = std::move(other.eq_fn_);
+
+    other.seeds_ = nullptr;
+    other.entries_ = nullptr;
+  }
+
+  /**
+   * @return a value in [0, n) from the high 32 bits of h, without a
+   * division.
+   */
+  static inline int Reduce(uint64_t h, int n) {
+    return static_cast<int>(((h >> 32) * static_cast<uint64_t>(n)) >> 32);
+  }
+
+  /**
+   * @return 64-bit hash code for the given key
+   */
+  inline uint64_t HashCode(const Key& k) const {
+    return MurmurMix(hash_fn_(k));
+  }
+
+  inline int BucketFor(uint64_t hashcode) const {
+    return Reduce(hashcode, num_buckets_);
+  }
+
+  /**
+   * @return the slot the hashcode is sent to by the given non-negative seed.
+   */
+  inline int SlotFor(uint64_t hashcode, int32_t seed) const {
+
+    // hashcode is already mixed, so one multiply spreads the seed enough
+    return Reduce((hashcode ^ (seed * 0xc2b2ae3d27d4eb4fULL)) *
+        0x9E3779B97F4A7C15ULL, size_);
+  }
+
+  /**
+   * @return the slot holding the hashcode, if its key is in the hashmap.
+   */
+  inline int SlotFor(uint64_t hashcode) const {
+    int32_t seed = seeds_[BucketFor(hashcode)];
+
+    // buckets with a single key store that key's slot as -(slot + 1)
+    return (seed < 0) ? -(seed + 1) : SlotFor(hashcode, seed);
+  }
+
+  /**
+   * Finds a seed for every bucket and places each entry in its slot.
+   */
+  void Build(const std::vector<std::pair<Key, Val>>& entries) {
+    size_ = static_cast<int>(entries.size());
+    num_buckets_ = std::max(1, (size_ + kKeysPerBucket - 1) / kKeysPerBucket);
+    seeds_ = new int32_t[num_buckets_];
+    std::fill(seeds_, seeds_ + num_buckets_, 0);
+    if (size_ == 0) {
+      return;
+    }
+
+    std::vector<uint64_t> hashcodes(size_);
+    for (int i = 0; i < size_; ++i) {
+      hashcodes[i] = HashCode(entries[i].first);
+    }
+
+    // group entry indices by bucket with a counting sort: the entries of
+    // bucket b are members[bucket_starts[b]] to members[bucket_starts[b + 1]]
+    std::vector<int> bucket_starts(num_buckets_ + 1, 0);
+    for (int i = 0; i < size_; ++i) {
+      ++bucket_starts[BucketFor(hashcodes[i]) + 1];
+    }
+    for (int b = 0; b < num_buckets_; ++b) {
+      bucket_starts[b + 1] += bucket_starts[b];
+    }
+    std::vector<int> members(size_);
+    std::vector<int> fill = bucket_starts;
+    for (int i = 0; i < size_; ++i) {
+      members[fill[BucketFor(hashcodes[i])]++] = i;
+    }
+
+    // place the largest buckets first, while most slots are free
+    std::vector<int> bucket_order(num_buckets_);
+    for (int b = 0; b < num_buckets_; ++b) {
+      bucket_order[b] = b;
+    }
+    std::stable_sort(bucket_order.begin(), bucket_order.end(),
+        [&](int a, int b) {
+          return bucket_starts[a + 1] - bucket_starts[a] >
+            bucket_starts[b + 1] - bucket_starts[b];
+        });
+
+    std::vector<int> entry_slots(size_, -1);
+    std::vector<bool> occupied(size_, false);
+    std::vector<int> bucket_slots;
+    int next_free_slot = 0;
+    for (int b : bucket_order) {
+      int begin = bucket_starts[b];
+      int end = bucket_starts[b + 1];
+      int bucket_size = end - begin;
+      if (bucket_size == 0) {
+        break;
+      }
+
+      if (bucket_size == 1) {
+        while (occupied[next_free_slot]) {
+          ++next_free_slot;
+        }
+        occupied[next_free_slot] = true;
+        entry_slots[members[begin]] = next_free_slot;
+        seeds_[b] = -(next_free_slot + 1);
+        continue;
+      }
+
+      // no seed can separate keys with the same hashcode
+      std::sort(members.begin() + begin, members.begin() + end,
+          [&](int x, int y) { return hashcodes[x] < hashcodes[y]; });
+      for (int i = begin + 1; i < end; ++i) {
+        if (hashcodes[members[i]] == hashcodes[members[i - 1]]) {
+          FreeMem();
+          if (eq_fn_(entries[members[i]].first,
+                entries[members[i - 1]].first)) {
+            throw std::invalid_argument(
+                "Duplicate key in entries for a FrozenHashmap.");
+          }
+          throw std::invalid_argument(
+              "Keys with the same hash code in entries for a FrozenHashmap.");
+        }
+      }
+
+      for (int32_t seed = 0; ; ++seed) {
+        bucket_slots.clear();
+        bool fits = true;
+        for (int i = begin; i < end && fits; ++i) {
+          int slot = SlotFor(hashcodes[members[i]], seed);
+          fits = !occupied[slot] && std::find(bucket_slots.begin(),
+              bucket_slots.end(), slot) == bucket_slots.end();
+          bucket_slots.push_back(slot);
+        }
+        if (fits) {
+          for (int i = begin; i < end; ++i) {
+            occupied[bucket_slots[i - begin]] = true;
+            entry_slots[members[i]] = bucket_slots[i - begin];
+          }
+          seeds_[b] = seed;
+          break;
+        }
+      }
+    }
+
+    entries_ = new Entry[size_];
+    for (int i = 0; i < size_; ++i) {
+      entries_[entry_slots[i]].k = entries[i].first;
+      entries_[entry_slots[i]].v = entries[i].second;
+    }
+  }
+
+private:
+
+  // seed of every displacement bucket
+  int32_t* seeds_ = nullptr;
+
+  // one slot per entry, all of them full
+  Entry* entries_ = nullptr;
+
+  // number of entries in the hashmap.
+  int size_ = 0;
+
+  // number of displacement buckets, at least 1.
+  int num_buckets_ = 0;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,598 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+
+namespace dsalgo {
+
+/**
+ * Set with linear probing. Same layout as Hashmap, minus the values, so
+ * membership tests don't pay for a dummy value in every slot.
+ *
+ * Key = type of the elements
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class HashSet {
+
+public:
+
+  /**
+   * Creates a set with the specified initial maximum capacity and load
+   * factor.
+   *
+   * @param init_capacity initial maximum capacity of the set if the load
+   * factor were 1. Rounded up to the next power of 2.
+   * @param load_factor how soon to resize the set. When the set contains
+   * capacity * load_factor keys, it will double in size.
+   */
+  HashSet(int init_capacity, float load_factor=0.7)
+      : load_factor_(load_factor) {
+
+    if (init_capacity < 8) {
+      init_capacity = 8;
+    }
+
+    table_size_ = IsPowerOf2(init_capacity) ?
+      init_capacity :
+      NextPowerOf2(init_capacity);
+
+    table_ = new Entry[table_size_];
+  }
+
+  HashSet() : HashSet(8) {}
+
+  ~HashSet() {
+    FreeMem();
+  }
+
+  HashSet(const HashSet<Key, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  HashSet(HashSet<Key, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  HashSet<Key, Hash, Eq>& operator=(const HashSet<Key, Hash, Eq>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  HashSet<Key, Hash, Eq>& operator=(HashSet<Key, Hash, Eq>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Adds the given key to the set.
+   *
+   * @return if the key was added, i.e. it was not in the set yet
+   */
+  bool Insert(const Key& k) {
+    int hashcode = HashCode(k);
+    int idx = LocateEntryIdx(k, hashcode);
+    if (table_[idx].IsValid()) {
+      return false;
+    }
+
+    // only resize when inserting, keeping at least one slot empty
+    if (size_ + 1 >= load_factor_ * table_size_ || size_ + 1 >= table_size_) {
+      Resize();
+      idx = LocateEntryIdx(k, hashcode);
+    }
+    table_[idx].k = k;
+    table_[idx].hashcode = hashcode;
+    ++size_;
+    return true;
+  }
+
+  /**
+   * @return if the given key is in the set
+   */
+  bool Contains(const Key& k) const {
+    return table_[LocateEntryIdx(k, HashCode(k))].IsValid();
+  }
+
+  /**
+   * Removes the given key from the set if present. Otherwise, does nothing.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(const Key& k) {
+    int remove_idx = LocateEntryIdx(k, HashCode(k));
+    if (!table_[remove_idx].IsValid()) {
+      return false;
+    }
+
+    // shift entries later in the chain of collisions back, so that linear
+    // probing still finds them. An entry can fill the unoccupied slot if that
+    // doesn't move it before its home slot.
+    int mask = table_size_ - 1;
+    int unoccupied_idx = remove_idx;
+    int idx_to_check = remove_idx;
+    while (true) {
+      idx_to_check = (idx_to_check + 1) & mask;
+      if (!table_[idx_to_check].IsValid()) {
+        break;
+      }
+      int home_idx = IndexFor(table_[idx_to_check].hashcode);
+      if (((idx_to_check - home_idx) & mask) >=
+          ((idx_to_check - unoccupied_idx) & mask)) {
+        table_[unoccupied_idx] = std::move(table_[idx_to_check]);
+        unoccupied_idx = idx_to_check;
+      }
+    }
+    table_[unoccupied_idx].Invalidate();
+    --size_;
+    return true;
+  }
+
+  /**
+   * @return number of keys in this set.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Removes all keys from this set.
+   */
+  void Clear() {
+    for (int i = 0; i < table_size_; ++i) {
+      table_[i].Invalidate();
+    }
+    size_ = 0;
+  }
+
+  /**
+   * Calls f(key) on every key in this set, in no particular order. f must not
+   * modify the set.
+   */
+  template<class F>
+  void ForEach(F f) const {
+    for (int i = 0; i < table_size_; ++i) {
+      if (table_[i].IsValid()) {
+        f(table_[i].k);
+      }
+    }
+  }
+
+private:
+
+  /**
+   * Represents an entry in the set.
+   */
+  struct Entry {
+    Key k;
+
+    // if hashcode is -1, that means the element is not valid.
+    int hashcode = -1;
+
+    inline bool IsValid() const {
+      return hashcode != -1;
+    }
+
+    inline void Invalidate() {
+      hashcode = -1;
+    }
+  };
+
+  /**
+   * Frees any memory that has been allocated for this set.
+   */
+  void FreeMem() {
+    if (table_ != nullptr) {
+      delete[] table_;
+      table_ = nullptr;
+    }
+  }
+
+  /**
+   * Copies another set into this set. Does not free any currently allocated
+   * memory though.
+   */
+  void CopyFrom(const HashSet<Key, Hash, Eq>& other) {
+    table_ = new Entry[other.table_size_];
+    std::copy(other.table_, other.table_ + other.table_size_, table_);
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = other.hash_fn_;
+    eq_fn_ = other.eq_fn_;
+  }
+
+  /**
+   * Moves another set into this set. The other set is emptied and
+   * invalidated.
+   */
+  void MoveFrom(HashSet<Key, Hash, Eq>& other) {
+    table_ = other.table_;
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = std::move(other.hash_fn_);
+    eq_fn_ = std::move(other.eq_fn_);
+
+    other.table_ = nullptr;
+  }
+
+  /**
+   * @return hash code for the given key
+   */
+  inline int HashCode(const Key& k) const {
+    return hash_fn_(k) & 0x7FFFFFFF;
+  }
+
+  /**
+   * @return the index in the underlying table at which the hashcode belongs
+   * if there were no collisions.
+   */
+  inline int IndexFor(int hashcode) const {
+    return hashcode & (table_size_ - 1);
+  }
+
+  /**
+   * @return index in the underlying table at which the key is located if the
+   * key is in the set. Otherwise, returns the empty slot at which the key
+   * should be inserted. The table is never full, so there always is one.
+   */
+  int LocateEntryIdx(const Key& k, int hashcode) const {
+    int idx = IndexFor(hashcode);
+    while (table_[idx].IsValid() &&
+        !(table_[idx].hashcode == hashcode && eq_fn_(k, table_[idx].k))) {
+      idx = (idx + 1) & (table_size_ - 1);
+    }
+    return idx;
+  }
+
+  void Resize() {
+
+    // back up old table data
+    Entry* old_table = table_;
+    int old_table_size = table_size_;
+
+    // create new table
+    while (size_ + 1 >= table_size_ * load_factor_ ||
+        size_ + 1 >= table_size_) {
+      table_size_ *= 2;
+    }
+    table_ = new Entry[table_size_];
+
+    // re-insert all the valid elements in the old table. They are known to
+    // be distinct, so they just need an empty slot.
+    for (int i = 0; i < old_table_size; ++i) {
+      if (old_table[i].IsValid()) {
+        int idx = IndexFor(old_table[i].hashcode);
+        while (table_[idx].IsValid()) {
+          idx = (idx + 1) & (table_size_ - 1);
+        }
+        table_[idx] = std::move(old_table[i]);
+      }
+    }
+
+    // free old table memory
+    delete[] old_table;
+  }
+
+private:
+
+  // underlying table for the set
+  Entry* table_ = nullptr;
+
+  // size of the underlying table, must be a power of 2.
+  int table_size_ = 0;
+
+  // number of keys in the set.
+  int size_ = 0;
+
+  // set will resize when number of keys exceeds table_size_ * load_factor_
+  float load_factor_ = 0;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+
+/**
+ * Set of integers with linear probing, where one key value is never used and
+ * can mark empty slots. Like IntHashmap, slots hold nothing but the key, so
+ * an IntHashSet<int64_t> slot is 8 bytes instead of HashSet's 16.
+ *
+ * Key = integer type of the elements
+ * EmptyKey = key value that is never inserted into the set
+ * Hash = hash function for the key
+ */
+template<
+  class Key,
+  Key EmptyKey=std::numeric_limits<Key>::max(),
+  class Hash=std::hash<Key>
+  >
+class IntHashSet {
+
+  static_assert(std::is_integral<Key>::value,
+      "IntHashSet keys must be integers");
+
+public:
+
+  /**
+   * Creates a set with the specified initial maximum capacity and load
+   * factor.
+   *
+   * @param init_capacity initial maximum capacity of the set if the load
+   * factor were 1. Rounded up to the next power of 2.
+   * @param load_factor how soon to resize the set. When the set contains
+   * capacity * load_factor keys, it will double in size.
+   */
+  IntHashSet(int init_capacity, float load_factor=0.7)
+      : load_factor_(load_factor) {
+
+    if (init_capacity < 8) {
+      init_capacity = 8;
+    }
+
+    table_size_ = IsPowerOf2(init_capacity) ?
+      init_capacity :
+      NextPowerOf2(init_capacity);
+
+    table_ = AllocTable(table_size_);
+  }
+
+  IntHashSet() : IntHashSet(8) {}
+
+  ~IntHashSet() {
+    FreeMem();
+  }
+
+  IntHashSet(const IntHashSet<Key, EmptyKey, Hash>& other) {
+    CopyFrom(other);
+  }
+
+  IntHashSet(IntHashSet<Key, EmptyKey, Hash>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  IntHashSet<Key, EmptyKey, Hash>& operator=(
+      const IntHashSet<Key, EmptyKey, Hash>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  IntHashSet<Key, EmptyKey, Hash>& operator=(
+      IntHashSet<Key, EmptyKey, Hash>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Adds the given key to the set.
+   *
+   * @return if the key was added, i.e. it was not in the set yet
+   * @throws invalid_argument if k is EmptyKey
+   */
+  bool Insert(Key k) {
+    if (UNLIKELY(k == EmptyKey)) {
+      throw std::invalid_argument(
+          "Cannot insert the empty key into an IntHashSet.");
+    }
+    int idx = LocateEntryIdx(k);
+    if (table_[idx] == k) {
+      return false;
+    }
+
+    // only resize when inserting, keeping at least one slot empty
+    if (size_ + 1 >= load_factor_ * table_size_ || size_ + 1 >= table_size_) {
+      Resize();
+      idx = LocateEntryIdx(k);
+    }
+    table_[idx] = k;
+    ++size_;
+    return true;
+  }
+
+  /**
+   * @return if the given key is in the set
+   */
+  bool Contains(Key k) const {
+    return k != EmptyKey && table_[LocateEntryIdx(k)] == k;
+  }
+
+  /**
+   * Removes the given key from the set if present. Otherwise, does nothing.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(Key k) {
+    if (UNLIKELY(k == EmptyKey)) {
+      return false;
+    }
+    int remove_idx = LocateEntryIdx(k);
+    if (table_[remove_idx] == EmptyKey) {
+      return false;
+    }
+
+    // same backward shift as IntHashmap::Remove()
+    int mask = table_size_ - 1;
+    int unoccupied_idx = remove_idx;
+    int idx_to_check = remove_idx;
+    while (true) {
+      idx_to_check = (idx_to_check + 1) & mask;
+      if (table_[idx_to_check] == EmptyKey) {
+        break;
+      }
+      int home_idx = IndexFor(table_[idx_to_check]);
+      if (((idx_to_check - home_idx) & mask) >=
+          ((idx_to_check - unoccupied_idx) & mask)) {
+        table_[unoccupied_idx] = table_[idx_to_check];
+        unoccupied_idx = idx_to_check;
+      }
+    }
+    table_[unoccupied_idx] = EmptyKey;
+    --size_;
+    return true;
+  }
+
+  /**
+   * @return number of keys in this set.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Removes all keys from this set.
+   */
+  void Clear() {
+    std::fill(table_, table_ + table_size_, EmptyKey);
+    size_ = 0;
+  }
+
+  /**
+   * Calls f(key) on every key in this set, in no particular order. f must not
+   * modify the set.
+   */
+  template<class F>
+  void ForEach(F f) const {
+    for (int i = 0; i < table_size_; ++i) {
+      if (table_[i] != EmptyKey) {
+        f(table_[i]);
+      }
+    }
+  }
+
+private:
+
+  /**
+   * Allocates a table of the given size with every slot empty.
+   */
+  static Key* AllocTable(int size) {
+    Key* table = new Key[size];
+    std::fill(table, table + size, EmptyKey);
+    return table;
+  }
+
+  /**
+   * Frees any memory that has been allocated for this set.
+   */
+  void FreeMem() {
+    if (table_ != nullptr) {
+      delete[] table_;
+      table_ = nullptr;
+    }
+  }
+
+  /**
+   * Copies another set into this set. Does not free any currently allocated
+   * memory though.
+   */
+  void CopyFrom(const IntHashSet<Key, EmptyKey, Hash>& other) {
+    table_ = new Key[other.table_size_];
+    std::copy(other.table_, other.table_ + other.table_size_, table_);
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = other.hash_fn_;
+  }
+
+  /**
+   * Moves another set into this set. The other set is emptied and
+   * invalidated.
+   */
+  void MoveFrom(IntHashSet<Key, EmptyKey, Hash>& other) {
+    table_ = other.table_;
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = std::move(other.hash_fn_);
+
+    other.table_ = nullptr;
+  }
+
+  /**
+   * @return the index in the underlying table at which the key belongs if
+   * there were no collisions.
+   */
+  inline int IndexFor(Key k) const {
+    return FibonacciIndex(hash_fn_(k), table_size_);
+  }
+
+  /**
+   * @return index in the underlying table at which the key is located if the
+   * key is in the set. Otherwise, returns the empty slot at which the key
+   * should be inserted. The table is never full, so there always is one.
+   */
+  int LocateEntryIdx(Key k) const {
+    int idx = IndexFor(k);
+    while (table_[idx] != k && table_[idx] != EmptyKey) {
+      idx = (idx + 1) & (table_size_ - 1);
+    }
+    return idx;
+  }
+
+  void Resize() {
+
+    // back up old table data
+    Key* old_table = table_;
+    int old_table_size = table_size_;
+
+    // create new table
+    while (size_ + 1 >= table_size_ * load_factor_ ||
+        size_ + 1 >= table_size_) {
+      table_size_ *= 2;
+    }
+    table_ = AllocTable(table_size_);
+
+    // re-insert all the keys in the old table. They are known to be
+    // distinct, so they just need an empty slot.
+    for (int i = 0; i < old_table_size; ++i) {
+      if (old_table[i] != EmptyKey) {
+        int idx = IndexFor(old_table[i]);
+        while (table_[idx] != EmptyKey) {
+          idx = (idx + 1) & (table_size_ - 1);
+        }
+        table_[idx] = old_table[i];
+      }
+    }
+
+    // free old table memory
+    delete[] old_table;
+  }
+
+private:
+
+  // underlying table for the set. EmptyKey marks an empty slot.
+  Key* table_ = nullptr;
+
+  // size of the underlying table, must be a power of 2.
+  int table_size_ = 0;
+
+  // number of keys in the set.
+  int size_ = 0;
+
+  // set will resize when number of keys exceeds table_size_ * load_factor_
+  float load_factor_ = 0;
+
+  Hash hash_fn_;
+};
+
+} // namespace dsalgo
@@ -1,27 +1,121 @@
+#pragma once
+
+#include "BloomFilter.h"
 #include "Utils.h"
+#include <algorithm>
 #include <assert.h>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <new>
+#include <stdint.h>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef DSALGO_HASHMAP_STATS
+#include "Profiling.h"
+#include <atomic>
+#define DSALGO_HASHMAP_STATS_ONLY(...) __VA_ARGS__
+#else
+#define DSALGO_HASHMAP_STATS_ONLY(...)
+#endif
 
 
 namespace dsalgo {
 
+/**
+ * Snapshot of a Hashmap's probing statistics, returned by
+ * Hashmap::GetStats(). Statistics are only collected if DSALGO_HASHMAP_STATS
+ * is defined before Hashmap.h is included. Otherwise, Hashmap has no
+ * GetStats() and pays nothing for them.
+ *
+ * Probe lengths are how many slots past its home slot a lookup had to go,
+ * recorded once per table searched by Get(), Put() and Remove(). Long probes
+ * for hits and misses at a moderate load factor point to a Hash that clusters
+ * keys.
+ */
+struct HashmapStats {
+  // probe lengths of at least kProbeHistogramSize - 1 share the last bucket
+  static constexpr int kProbeHistogramSize = 32;
+
+  // hit_probe_lengths[i] = number of lookups that found their key i slots
+  // past its home slot
+  int64_t hit_probe_lengths[kProbeHistogramSize] = {0};
+
+  // miss_probe_lengths[i] = number of lookups that reached an empty slot i
+  // slots past the key's home slot
+  int64_t miss_probe_lengths[kProbeHistogramSize] = {0};
+
+  // length of the longest run of occupied slots in the table
+  int64_t longest_cluster = 0;
+
+  // number of times the table grew, and the total time spent in those
+  // resizes. With incremental resizing, only covers swapping tables, not
+  // the migration work spread over later operations.
+  int64_t num_resizes = 0;
+  int64_t resize_ns = 0;
+
+  // number of entries Remove() shifted back to fill the removed slot
+  int64_t remove_shifts = 0;
+
+  // number of times a long probe made the hashmap reseed its Hash and
+  // rehash every key
+  int64_t num_reseeds = 0;
+
+  // bytes allocated for tables, including the ones incremental resizing
+  // keeps around, and that divided by the number of entries
+  int64_t table_bytes = 0;
+  double bytes_per_entry = 0;
+};
+
+/**
+ * Whether a hash function can switch to a fresh seed with Reseed(), like
+ * SeededHash.
+ */
+template<class H, class=void>
+struct IsReseedableHash : std::false_type {};
+
+template<class H>
+struct IsReseedableHash<H, decltype(std::declval<H&>().Reseed())>
+  : std::true_type {};
+
 /**
  * Hashmap with linear probing.
  *
+ * By default, a resize rehashes the whole table inside the Put() that
+ * triggers it. With SetIncrementalResize(true), the old table is kept around
+ * after a resize instead and every following Put() and Remove() migrates a
+ * bounded number of its slots into the new table, so no single operation pays
+ * for rehashing the entire map. Constructing the next table and destroying the
+ * old one are spread out over operations the same way.
+ *
+ * Index is the signed integer type used for sizes, table indices and stored
+ * hashcodes. The default int keeps entries compact, but caps the table at
+ * 2^30 slots and keeps only 31 bits of each hash. Use int64_t for maps that
+ * outgrow that: it keeps 63 bits of each hash, at the cost of 4 more bytes
+ * per entry (before padding).
+ *
  * Key = type used for lookup
  * Val = type that gets mapped to in the hashmap
  * Hash = hash function for the key
  * Eq = equality function for the key
+ * Index = signed integer type for sizes, indices and hashcodes
  */
 template<
   class Key,
   class Val,
   class Hash=std::hash<Key>,
-  class Eq=std::equal_to<Key>
+  class Eq=std::equal_to<Key>,
+  class Index=int
   >
 class Hashmap {
 
+  static_assert(std::is_same<Index, int>::value ||
+      std::is_same<Index, int64_t>::value,
+      "Hashmap Index must be int or int64_t");
+
 public:
 
   /**
@@ -36,7 +130,7 @@ public:
    * contains capacity * load_factor entries, it will double
    * in size.
    */
-  Hashmap(int init_capacity, float load_factor=0.7)
+  Hashmap(Index init_capacity, float load_factor=0.7)
       : load_factor_(load_factor) {
 
     if (init_capacity < 8) {
@@ -48,7 +142,7 @@ public:
       init_capacity :
       NextPowerOf2(init_capacity);
 
-    table_ = new Entry[table_size_]; 
+    table_ = AllocTable(table_size_);
   }
 
   Hashmap() : Hashmap(8) {}
@@ -57,23 +151,23 @@ public:
     FreeMem();
   }
 
-  Hashmap(const Hashmap<Key, Val, Hash, Eq>& other) {
+  Hashmap(const Hashmap<Key, Val, Hash, Eq, Index>& other) {
     CopyFrom(other);
   }
 
-  Hashmap(Hashmap<Key, Val, Hash, Eq>&& other) noexcept {
+  Hashmap(Hashmap<Key, Val, Hash, Eq, Index>&& other) noexcept {
     MoveFrom(other);
   }
 
-  Hashmap<Key, Val, Hash, Eq>& operator=(
-      const Hashmap<Key, Val, Hash, Eq>& other) {
+  Hashmap<Key, Val, Hash, Eq, Index>& operator=(
+      const Hashmap<Key, Val, Hash, Eq, Index>& other) {
     FreeMem();
     CopyFrom(other);
     return *this;
   }
 
-  Hashmap<Key, Val, Hash, Eq>& operator=(
-      Hashmap<Key, Val, Hash, Eq> && other) noexcept {
+  Hashmap<Key, Val, Hash, Eq, Index>& operator=(
+      Hashmap<Key, Val, Hash, Eq, Index> && other) noexcept {
     FreeMem();
     MoveFrom(other);
     return *this;
@@ -92,26 +186,50 @@ public:
    * @param v value to which to map the key
    */
   void Put(const Key& k, const Val& v) {
-    if (size_ >= load_factor_ * table_size_) {
-      Resize();
-    }
+    FindOrInsert(k).first->v = v;
+  }
 
-    int hashcode = HashCode(k);
-    int insert_idx = LocateEntryIdx(k);
-    assert(insert_idx != -1);
-    Entry& insert_entry = table_[insert_idx];
+  /**
+   * Same as Put(const Key&, const Val&), but moves the key (only if it gets
+   * inserted) and the value into the hashmap instead of copying them.
+   */
+  void Put(Key&& k, Val&& v) {
+    FindOrInsert(std::move(k)).first->v = std::move(v);
+  }
 
-    // updating entry - only have to update the value
-    if (insert_entry.IsValid()) {
-      insert_entry.v = v;
+  /**
+   * Maps the given key to a value constructed from the given arguments,
+   * overwriting any previous value.
+   *
+   * @param k key to insert
+   * @param args arguments to pass to Val's constructor
+   * @return pointer to the value, and true if the key was inserted or false if
+   * an existing value was overwritten.
+   */
+  template<class K, class... Args>
+  std::pair<Val*, bool> Emplace(K&& k, Args&&... args) {
+    std::pair<Entry*, bool> found = FindOrInsert(std::forward<K>(k));
+    found.first->v = Val(std::forward<Args>(args)...);
+    return std::make_pair(&found.first->v, found.second);
+  }
 
-    // inserting new entry - have to update both key and value
-    } else {
-      insert_entry.k = k;
-      insert_entry.v = v;
-      insert_entry.hashcode = hashcode;
-      ++size_;
+  /**
+   * Maps the given key to a value constructed from the given arguments if the
+   * key is not in the hashmap yet. Otherwise, leaves the existing value alone
+   * and does not construct anything from the arguments.
+   *
+   * @param k key to insert
+   * @param args arguments to pass to Val's constructor
+   * @return pointer to the value the key is mapped to, and whether the key was
+   * inserted.
+   */
+  template<class K, class... Args>
+  std::pair<Val*, bool> TryEmplace(K&& k, Args&&... args) {
+    std::pair<Entry*, bool> found = FindOrInsert(std::forward<K>(k));
+    if (found.second) {
+      found.first->v = Val(std::forward<Args>(args)...);
     }
+    return std::make_pair(&found.first->v, found.second);
   }
 
   /**
@@ -119,10 +237,7 @@ public:
    *
    * If the provided key is not already in the hashmap, then it will be inserted
    * into the hashmap and mapped to the default value (calls the default
-   * constructor).
-   *
-   * This is slower than using Put/Get() if you already know whether or not
-   * the element is in the hashmap.
+   * constructor). Either way, the key is only located once.
    *
    * Use Get() if you just want to check if a key is in the hashmap but
    * not create a new entry if the key doesn't exist.
@@ -131,12 +246,11 @@ public:
    * @return the value to which the given key is mapped.
    */
   Val& operator[](const Key& k) {
-    Val* v = Get(k);
-    if (v != nullptr) {
-      return *v;
-    }
-    Put(k, Val());
-    return *Get(k);
+    return *TryEmplace(k).first;
+  }
+
+  Val& operator[](Key&& k) {
+    return *TryEmplace(std::move(k)).first;
   }
 
   /**
@@ -144,16 +258,102 @@ public:
    * is not in the hashmap.
    */
   Val* Get(const Key& k) const {
-    int entry_idx = LocateEntryIdx(k);
-    if (entry_idx == -1) {
-      return nullptr;
+    return GetImpl(k);
+  }
+
+  /**
+   * Looks up a key of a different type than Key, such as a const char* for a
+   * std::string key, without constructing a Key. Only available if both Hash
+   * and Eq declare is_transparent, i.e. they can hash and compare any such
+   * type consistently with Key (see StrHash and StrEq).
+   *
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  template<class K, class H=Hash, class E=Eq,
+    class=typename H::is_transparent, class=typename E::is_transparent>
+  Val* Get(const K& k) const {
+    return GetImpl(k);
+  }
+
+  /**
+   * Looks up a batch of keys.
+   *
+   * Keys are processed kBatchSize at a time: all of their hashcodes are
+   * computed and the cache lines of their home slots are prefetched before
+   * any of them is probed, so the cache misses of the whole batch overlap
+   * instead of being waited on one after another.
+   *
+   * @param keys array of n keys to look up
+   * @param n number of keys
+   * @param vals array of n pointers. vals[i] is set to the value of keys[i],
+   * or nullptr if keys[i] is not in the hashmap.
+   */
+  void GetMany(const Key* keys, int n, Val** vals) const {
+    Index hashcodes[kBatchSize];
+    for (int batch_begin = 0; batch_begin < n; batch_begin += kBatchSize) {
+      int batch_size = (n - batch_begin < kBatchSize) ?
+        (n - batch_begin) : kBatchSize;
+      PrefetchBatch(keys + batch_begin, batch_size, hashcodes);
+      for (int i = 0; i < batch_size; ++i) {
+        vals[batch_begin + i] = GetImpl(keys[batch_begin + i], hashcodes[i]);
+      }
     }
+  }
 
-    Entry& entry = table_[entry_idx];
-    if (entry.IsValid()) {
-      return &entry.v;
-    } else {
-      return nullptr;
+  /**
+   * Maps a batch of keys to their values, like calling Put(keys[i], vals[i])
+   * for each i in order, but with the home slots of each kBatchSize keys
+   * prefetched up front like in GetMany().
+   *
+   * If SetNumThreads() allows it, large batches are instead inserted by
+   * several threads at once (see InsertParallel()), with the same result.
+   * This is the fast way to build a big hashmap from scratch.
+   *
+   * @param keys array of n keys to insert
+   * @param vals array of n values to which to map the keys
+   * @param n number of keys
+   */
+  void PutMany(const Key* keys, const Val* vals, int n) {
+    // grow up front, so that prefetched slots aren't invalidated by a resize
+    // in the middle of the batch
+    Reserve(size_ + n);
+
+    int num_threads = ThreadsFor(table_size_);
+    if (num_threads > 1 && n >= kMinParallelWork) {
+      FinishMigration();
+      size_ += InsertParallel(n, num_threads,
+          [this, keys](Index i) {
+            return HashCode(keys[i]);
+          },
+          [this, keys](Index i, const Entry& entry) {
+            return Equals(keys[i], entry.k);
+          },
+          [keys, vals](Index i, Entry& entry, bool inserted) {
+            if (inserted) {
+              entry.k = keys[i];
+            }
+            entry.v = vals[i];
+          });
+      return;
+    }
+
+    Index hashcodes[kBatchSize];
+    for (int batch_begin = 0; batch_begin < n; batch_begin += kBatchSize) {
+      int batch_size = (n - batch_begin < kBatchSize) ?
+        (n - batch_begin) : kBatchSize;
+      PrefetchBatch(keys + batch_begin, batch_size, hashcodes);
+      for (int i = 0; i < batch_size; ++i) {
+        int64_t num_reseeds = num_reseeds_;
+        FindOrInsert(keys[batch_begin + i], hashcodes[i]).first->v =
+          vals[batch_begin + i];
+
+        // the rest of the batch was hashed under the old seed
+        if (num_reseeds_ != num_reseeds) {
+          PrefetchBatch(keys + batch_begin + i + 1, batch_size - i - 1,
+              hashcodes + i + 1);
+        }
+      }
     }
   }
 
@@ -164,111 +364,31 @@ public:
    * @return if the key was removed
    */
   bool Remove(const Key& k) {
-    int remove_idx = LocateEntryIdx(k);
-    if (remove_idx == -1) {
-      return false;
-    }
-
-    Entry& entry_to_remove = table_[remove_idx];
-    if (entry_to_remove.IsValid()) {
-      int unoccupied_idx = remove_idx;
-      int idx_to_check = unoccupied_idx;
-      while (true) {
-        idx_to_check = (idx_to_check + 1) & (table_size_ - 1);
-
-        // if we reach an unoccupied spot, we're done
-        if (!table_[idx_to_check].IsValid()) {
-          break;
-        }
+    return RemoveImpl(k);
+  }
 
-        // if table is completely full and we've gone one full cycle around
-        // then we're done
-        if (idx_to_check == remove_idx) {
-          break;
-        }
+  /**
+   * Same as Remove(const Key&), but for heterogeneous keys. See Get(const K&).
+   */
+  template<class K, class H=Hash, class E=Eq,
+    class=typename H::is_transparent, class=typename E::is_transparent>
+  bool Remove(const K& k) {
+    return RemoveImpl(k);
+  }
 
-        // this is where the entry we're checking should belong if there
-        // were no collisions, a.k.a the canonical index
-        int idx_for_entry_to_check = IndexFor(table_[idx_to_check].hashcode);
-
-        // But if there were collisions and the entry was shifted via linear
-        // probing, we *may* be able to move it into the unoccupied spot
-        // under two conditions.
-        //
-        // At this point, every element from [remove_idx, idx_to_check] is
-        // occupied except for the element at unoccupied_idx.
-
-        // If there is no wraparound yet, then we can move the entry into the
-        // unoccupied spot if...
-        //    1. the candidate entry's canonical index in the table is earlier
-        //       than the unoccupied spot. This means we're just shifting the
-        //       candidate entry earlier in the chain of collisions, which will
-        //       speed up finding it in future searches.
-        //                              OR
-        //    2. the candidate entry's canonical index in the table is after the
-        //       current index that we're checking. If the candidate was
-        //       properly placed at the current index we're checking, then
-        //       everything from [0, idx_to_check] and from
-        //       [idx_for_entry_to_check, table_end] must be occupied. This
-        //       means that the candidate entry belongs at
-        //       idx_for_entry_to_check and wrapped all the way around due
-        //       to collisions with the linear probing. So by moving the
-        //       candidate entry to an earlier spot, we're just shifting the
-        //       candidate entry to earlier in the chain of collisions.
-        //
-        // In either case, we're just shifting the candidate entry to earlier
-        // in the chain of collisions.
-        bool not_wrapped_around_and_can_move =
-          (idx_to_check > unoccupied_idx) &&
-          (idx_for_entry_to_check <= unoccupied_idx ||
-           idx_for_entry_to_check > idx_to_check);
-
-        // If there is wrapround, then we can move the entry into the unoccupied
-        // spot if...
-        //    1. the candidate entry's canonical index in the table is earlier
-        //       than the unoccupied spot.
-        //                          AND
-        //    2. the candidate entry's canonical index in the table is greater
-        //       than the current index we're checking.
-        //
-        // The first condition guarantees that we're shifting the element
-        // earlier in the chain of collisions. The second condition guarantees
-        // we're not moving an element farther away from where it should be and
-        // thus introducing a "gap" in it's linear probing chain.
-        //
-        // As an example of why not remove when
-        // idx_for_entry_to_check <= idx_to_check, consider this table:
-        //                         [a, b, c, d]
-        // where b, c and d hash to index 3 and a hashes to index 0. (So 
-        // we inserted d, then a, then b, and then c).
-        //
-        // If we delete d, then we get an unoccupied space at index 3.
-        //                        [a, b, c, -]
-        // The remove algorithm then considers moving a down to replace d.
-        // But we shouldn't move a because it's already in the correct spot!
-        // It's only when idx_for_entry_to_check > idx_to_check (indicating
-        // that the candidate entry wrapped around due to collisions) that we're
-        // actually moving the element closer to it's canonical index.
-        bool wrapped_around_and_can_move = (idx_to_check < unoccupied_idx) &&
-          (idx_for_entry_to_check <= unoccupied_idx &&
-           idx_for_entry_to_check > idx_to_check);
-
-        if (not_wrapped_around_and_can_move || wrapped_around_and_can_move) {
-          table_[unoccupied_idx] = std::move(table_[idx_to_check]); 
-          unoccupied_idx = idx_to_check;
-        }
-      }
-      table_[unoccupied_idx].Invalidate();
-      --size_;
-      return true;
+  /**
+   * Grows the table so that it can hold num_entries entries without resizing.
+   */
+  void Reserve(Index num_entries) {
+    if (num_entries >= load_factor_ * table_size_) {
+      Resize(num_entries);
     }
-    return false;
   }
 
   /**
    * @return number of entries in this hashmap.
    */
-  int Size() const {
+  Index Size() const {
     return size_;
   }
 
@@ -276,11 +396,136 @@ public:
    * Removes all elements from this hashmap.
    */
   void Clear() {
-    for (int i = 0; i < table_size_; ++i) {
+    for (Index i = 0; i < table_size_; ++i) {
       Entry& to_clear = table_[i];
       to_clear.Invalidate();
     }
+    FreeIncrementalTables();
     size_ = 0;
+    if (use_bloom_filter_) {
+      bloom_filter_.Clear();
+    }
+  }
+
+  /**
+   * Calls f(key, value) on every entry in this hashmap, in no particular
+   * order. f must not modify the hashmap.
+   */
+  template<class F>
+  void ForEach(F f) const {
+    for (Index i = 0; i < table_size_; ++i) {
+      if (table_[i].IsValid()) {
+        f(table_[i].k, table_[i].v);
+      }
+    }
+
+    // entries that an incremental resize hasn't migrated yet
+    if (old_table_ != nullptr) {
+      for (Index i = 0; i < old_table_size_; ++i) {
+        if (old_table_[i].IsValid()) {
+          f(old_table_[i].k, old_table_[i].v);
+        }
+      }
+    }
+  }
+
+#ifdef DSALGO_HASHMAP_STATS
+  /**
+   * @return statistics collected since this hashmap was created or since
+   * the last ResetStats(). Scans the table to find the longest cluster.
+   */
+  HashmapStats GetStats() const {
+    HashmapStats stats;
+    for (int i = 0; i < HashmapStats::kProbeHistogramSize; ++i) {
+      stats.hit_probe_lengths[i] =
+        stats_.hit_probe_lengths[i].load(std::memory_order_relaxed);
+      stats.miss_probe_lengths[i] =
+        stats_.miss_probe_lengths[i].load(std::memory_order_relaxed);
+    }
+    stats.longest_cluster = LongestCluster();
+    stats.num_resizes = stats_.num_resizes;
+    stats.resize_ns = stats_.resize_ns;
+    stats.remove_shifts = stats_.remove_shifts;
+    stats.num_reseeds = stats_.num_reseeds;
+
+    int64_t num_slots = table_size_;
+    num_slots += (old_table_ != nullptr) ? old_table_size_ : 0;
+    num_slots += (next_table_ != nullptr) ? next_table_size_ : 0;
+    num_slots += (dead_table_ != nullptr) ? dead_table_size_ : 0;
+    stats.table_bytes = num_slots * sizeof(Entry);
+    stats.bytes_per_entry = (size_ > 0) ?
+      static_cast<double>(stats.table_bytes) / size_ : 0;
+    return stats;
+  }
+
+  /**
+   * Zeroes the counters reported by GetStats().
+   */
+  void ResetStats() {
+    stats_.Reset();
+  }
+#endif
+
+  /**
+   * Enables or disables incremental resizing.
+   *
+   * When enabled, a resize swaps in a table that has already been constructed
+   * a few slots at a time by earlier operations. The old table stays around
+   * and each later Put() or Remove() migrates up to kMigrationStepsPerOp of
+   * its slots, then destroys it a few slots at a time once it is empty. Get()
+   * never does any of this work, but checks both tables until the migration
+   * finishes.
+   *
+   * Disabling incremental resizing finishes any ongoing migration.
+   */
+  void SetIncrementalResize(bool incremental_resize) {
+    if (!incremental_resize) {
+      FinishMigration();
+      FreeIncrementalTables();
+    }
+    incremental_resize_ = incremental_resize;
+  }
+
+  /**
+   * Enables or disables a Bloom filter in front of Get().
+   *
+   * When enabled, the hashcode of every inserted key is also added to a
+   * BloomFilter, and Get() only probes the table if the filter may contain
+   * the hashcode. A miss then usually costs one cache line of filter instead
+   * of a probe chain of entries and key comparisons, which pays off when most
+   * lookups are for keys that aren't in the map. Puts get slightly slower.
+   *
+   * Removed keys stay in the filter until the next resize rebuilds it, so
+   * maps with many removals and few resizes gradually lose the benefit.
+   */
+  void SetBloomFilter(bool use_bloom_filter) {
+    use_bloom_filter_ = use_bloom_filter;
+    if (use_bloom_filter_) {
+      bloom_filter_ = BuildBloomFilter(table_, table_size_);
+      if (old_table_ != nullptr) {
+        old_bloom_filter_ = BuildBloomFilter(old_table_, old_table_size_);
+      }
+    } else {
+      bloom_filter_ = BloomFilter();
+      old_bloom_filter_ = BloomFilter();
+    }
+  }
+
+  /**
+   * Sets how many threads Resize() and PutMany() may use. Defaults to 1.
+   *
+   * With more than one thread, a resize that isn't incremental constructs
+   * the new table and reinserts the old table's entries in parallel, and
+   * PutMany() inserts large batches in parallel. Only tables with at least
+   * kMinParallelWork slots per thread are split up, and the number of
+   * threads used is rounded down to a power of 2.
+   *
+   * Threads are started and joined within each such call, so the hashmap is
+   * still not safe to use from several threads at once. Programs that use
+   * more than one thread have to be compiled with -pthread.
+   */
+  void SetNumThreads(int num_threads) {
+    num_threads_ = std::max(num_threads, 1);
   }
 
 private:
@@ -292,7 +537,7 @@ private:
     Key k;
     Val v;
     // if hashcode is -1, that means the element is not valid.
-    int hashcode = -1;
+    Index hashcode = -1;
 
     /**
      * @return if this is a valid hashmap entry (as opposed to just unused
@@ -310,12 +555,508 @@ private:
     }
   };
 
+  /**
+   * Locates the entry for the given key, inserting an entry for it if the key
+   * is not in the hashmap yet. The value of an inserted entry is left
+   * unspecified and must be assigned by the caller.
+   *
+   * @param k key to find or insert. Only forwarded into the table if the key
+   * gets inserted.
+   * @param hashcode hashcode for the key, or -1, if you want this function to
+   * compute it.
+   * @return the entry for the key, and whether it was inserted
+   */
+  template<class K>
+  std::pair<Entry*, bool> FindOrInsert(K&& k, Index hashcode=-1) {
+    if (incremental_resize_) {
+      DoIncrementalWork();
+    }
+
+    if (hashcode == -1) {
+      hashcode = HashCode(k);
+    }
+    Index insert_idx = LocateEntryIdx(k, hashcode);
+    DSALGO_HASHMAP_STATS_ONLY(
+        RecordProbe(table_, table_size_, hashcode, insert_idx));
+    if (insert_idx != -1 && table_[insert_idx].IsValid()) {
+      return std::make_pair(&table_[insert_idx], false);
+    }
+
+    // the key may still be waiting to be migrated out of the old table
+    if (old_table_ != nullptr) {
+      Index old_idx = LocateEntryIdxIn(old_table_, old_table_size_, k,
+          hashcode);
+      DSALGO_HASHMAP_STATS_ONLY(
+          RecordProbe(old_table_, old_table_size_, hashcode, old_idx));
+      if (old_idx != -1 && old_table_[old_idx].IsValid()) {
+        return std::make_pair(&old_table_[old_idx], false);
+      }
+    }
+
+    // only resize when inserting. The key's slot has to be located again in
+    // the new table.
+    if (insert_idx == -1 || size_ >= load_factor_ * table_size_) {
+      Resize(size_);
+      insert_idx = LocateEntryIdx(k, hashcode);
+    } else if (IsReseedableHash<Hash>::value &&
+        ((insert_idx - hashcode) & (table_size_ - 1)) > kReseedProbeLength &&
+        inserts_since_reseed_ >= size_ / 2) {
+      // random keys almost never probe this far under a seeded hash, so the
+      // keys were probably chosen to collide under the current seed. The
+      // size_ / 2 inserts between reseeds keep the rehashing amortized O(1)
+      // even if the probes stay long, e.g. at a load factor close to 1.
+      Reseed(IsReseedableHash<Hash>());
+      hashcode = HashCode(k);
+      insert_idx = LocateEntryIdx(k, hashcode);
+    }
+    assert(insert_idx != -1);
+    ++inserts_since_reseed_;
+
+    // inserting new entry - have to update both key and value
+    Entry& insert_entry = table_[insert_idx];
+    insert_entry.k = std::forward<K>(k);
+    insert_entry.hashcode = hashcode;
+    ++size_;
+    if (use_bloom_filter_) {
+      bloom_filter_.Insert(hashcode);
+    }
+    return std::make_pair(&insert_entry, true);
+  }
+
+  /**
+   * Implements Get() for any key type that Hash and Eq accept.
+   *
+   * @param hashcode hashcode for the key, or -1, if you want this function to
+   * compute it.
+   */
+  template<class K>
+  Val* GetImpl(const K& k, Index hashcode=-1) const {
+    if (hashcode == -1) {
+      hashcode = HashCode(k);
+    }
+    if (!use_bloom_filter_ || bloom_filter_.MayContain(hashcode)) {
+      Index entry_idx = LocateEntryIdx(k, hashcode);
+      DSALGO_HASHMAP_STATS_ONLY(
+          RecordProbe(table_, table_size_, hashcode, entry_idx));
+      if (entry_idx != -1 && table_[entry_idx].IsValid()) {
+        return &table_[entry_idx].v;
+      }
+    }
+
+    if (old_table_ != nullptr &&
+        (!use_bloom_filter_ || old_bloom_filter_.MayContain(hashcode))) {
+      Index entry_idx = LocateEntryIdxIn(old_table_, old_table_size_, k,
+          hashcode);
+      DSALGO_HASHMAP_STATS_ONLY(
+          RecordProbe(old_table_, old_table_size_, hashcode, entry_idx));
+      if (entry_idx != -1 && old_table_[entry_idx].IsValid()) {
+        return &old_table_[entry_idx].v;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Implements Remove() for any key type that Hash and Eq accept.
+   */
+  template<class K>
+  bool RemoveImpl(const K& k) {
+    if (incremental_resize_) {
+      DoIncrementalWork();
+    }
+
+    Index hashcode = HashCode(k);
+    Index remove_idx = LocateEntryIdx(k, hashcode);
+    DSALGO_HASHMAP_STATS_ONLY(
+        RecordProbe(table_, table_size_, hashcode, remove_idx));
+    if (remove_idx != -1 && table_[remove_idx].IsValid()) {
+      RemoveEntryAt(table_, table_size_, remove_idx);
+      --size_;
+      return true;
+    }
+
+    if (old_table_ != nullptr) {
+      remove_idx = LocateEntryIdxIn(old_table_, old_table_size_, k, hashcode);
+      DSALGO_HASHMAP_STATS_ONLY(
+          RecordProbe(old_table_, old_table_size_, hashcode, remove_idx));
+      if (remove_idx != -1 && old_table_[remove_idx].IsValid()) {
+        RemoveEntryAt(old_table_, old_table_size_, remove_idx);
+        --size_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+#ifdef DSALGO_HASHMAP_STATS
+  /**
+   * Counters behind GetStats(). Lookup counters are updated by const methods,
+   * which may run concurrently (e.g. in ConcurrentHashmap), so they are
+   * relaxed atomics. Concurrent increments can get lost, which is fine for
+   * statistics, but there is no data race.
+   */
+  struct StatsCounters {
+    std::atomic<int64_t> hit_probe_lengths[HashmapStats::kProbeHistogramSize];
+    std::atomic<int64_t> miss_probe_lengths[HashmapStats::kProbeHistogramSize];
+    int64_t num_resizes;
+    int64_t resize_ns;
+    int64_t remove_shifts;
+    int64_t num_reseeds;
+
+    StatsCounters() {
+      Reset();
+    }
+
+    void Reset() {
+      for (int i = 0; i < HashmapStats::kProbeHistogramSize; ++i) {
+        hit_probe_lengths[i].store(0, std::memory_order_relaxed);
+        miss_probe_lengths[i].store(0, std::memory_order_relaxed);
+      }
+      num_resizes = 0;
+      resize_ns = 0;
+      remove_shifts = 0;
+      num_reseeds = 0;
+    }
+  };
+
+  /**
+   * Times a Resize() from construction to destruction.
+   */
+  struct ResizeTimer {
+    StatsCounters* stats;
+    int64_t start;
+
+    ResizeTimer(StatsCounters* s) : stats(s), start(Clock::Now()) {}
+
+    ~ResizeTimer() {
+      ++stats->num_resizes;
+      stats->resize_ns += Clock::Now() - start;
+    }
+  };
+
+  /**
+   * Records the probe length of a lookup in the given table that returned
+   * idx. The lookup was a hit if the slot at idx is occupied.
+   */
+  void RecordProbe(const Entry* table, Index table_size, Index hashcode,
+      Index idx) const {
+    Index probe_length = (idx == -1) ?
+      table_size :
+      ((idx - hashcode) & (table_size - 1));
+    int bucket = (probe_length < HashmapStats::kProbeHistogramSize - 1) ?
+      probe_length : (HashmapStats::kProbeHistogramSize - 1);
+    std::atomic<int64_t>& counter = (idx != -1 && table[idx].IsValid()) ?
+      stats_.hit_probe_lengths[bucket] :
+      stats_.miss_probe_lengths[bucket];
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+  }
+
+  /**
+   * @return length of the longest run of occupied slots in table_
+   */
+  Index LongestCluster() const {
+    // start right after an empty slot so that no cluster wraps around the
+    // start of the scan
+    Index start = 0;
+    while (start < table_size_ && table_[start].IsValid()) {
+      ++start;
+    }
+    if (start == table_size_) {
+      return table_size_;
+    }
+
+    Index longest = 0;
+    Index current = 0;
+    for (Index i = 1; i <= table_size_; ++i) {
+      if (table_[(start + i) & (table_size_ - 1)].IsValid()) {
+        ++current;
+        longest = (current > longest) ? current : longest;
+      } else {
+        current = 0;
+      }
+    }
+    return longest;
+  }
+#endif
+
+  /**
+   * Computes the hashcodes of n <= kBatchSize keys and prefetches the cache
+   * line of each one's home slot.
+   */
+  void PrefetchBatch(const Key* keys, int n, Index* hashcodes) const {
+    for (int i = 0; i < n; ++i) {
+      hashcodes[i] = HashCode(keys[i]);
+      __builtin_prefetch(table_ + IndexFor(hashcodes[i]));
+    }
+  }
+
+  /**
+   * @return Bloom filter sized for a table of table_size_ slots at the load
+   * factor, holding the hashcodes of the first num_slots slots of table.
+   */
+  BloomFilter BuildBloomFilter(const Entry* table, Index num_slots) const {
+    BloomFilter filter(static_cast<int64_t>(table_size_ * load_factor_) + 1,
+        kBloomFalsePositiveRate);
+    for (Index i = 0; i < num_slots; ++i) {
+      if (table[i].IsValid()) {
+        filter.Insert(table[i].hashcode);
+      }
+    }
+    return filter;
+  }
+
+  /**
+   * @return number of threads to split work on a table of table_size slots
+   * between: the largest power of 2 that is at most num_threads_ and leaves
+   * each thread at least kMinParallelWork slots. 1 means no threads should
+   * be started.
+   */
+  int ThreadsFor(Index table_size) const {
+    int num_threads = 1;
+    while (num_threads * 2 <= num_threads_ &&
+        table_size / (num_threads * 2) >= kMinParallelWork) {
+      num_threads *= 2;
+    }
+    return num_threads;
+  }
+
+  /**
+   * Calls f(t) for each t in [0, num_threads), each on its own thread, and
+   * returns once they have all returned. f(0) runs on the calling thread.
+   */
+  template<class F>
+  static void RunOnThreads(int num_threads, const F& f) {
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+      threads.emplace_back([&f, t]() { f(t); });
+    }
+    f(0);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  /**
+   * Inserts n items into table_ with num_threads threads, where num_threads
+   * is a power of 2 that divides table_size_. The items are only accessed
+   * through the given functions:
+   *   hashcode_of(i) returns item i's hashcode, or -1 to skip the item. It
+   *     is called once per item, from any of the threads.
+   *   matches(i, entry) returns if item i's key equals the entry's key.
+   *   place(i, entry, inserted) writes item i into entry, which is either
+   *     a new entry with its hashcode already set (inserted is true) or the
+   *     entry that already holds an equal key.
+   *
+   * The table is split into num_threads equal ranges of slots, so the high
+   * bits of an item's home slot pick its range. The threads hash their share
+   * of the items and count how many fall in each range, then scatter the
+   * item indices into one array grouped by range, keeping each range's
+   * items in their original order. Thread p then inserts the items homed in
+   * range p, probing only the slots in range p, so no two threads touch the
+   * same slot. An item whose probe runs off the end of its range is set
+   * aside and inserted by the calling thread afterwards. Only clusters that
+   * cross a range boundary produce such items, so there are few of them.
+   *
+   * Since equal keys have the same home slot, they are inserted by the same
+   * thread in their original order, so the last one's place() wins, just
+   * like when inserting serially.
+   *
+   * table_ must already be large enough to hold every item under the load
+   * factor, and must not be incrementally resizing.
+   *
+   * @return number of items that were inserted rather than matched
+   */
+  template<class HashcodeOf, class Matches, class Place>
+  Index InsertParallel(Index n, int num_threads, const HashcodeOf& hashcode_of,
+      const Matches& matches, const Place& place) {
+    int range_bits = __builtin_ctzll(table_size_ / num_threads);
+    std::vector<Index> hashcodes(n);
+
+    // counts[t * num_threads + p] = number of items in thread t's share homed
+    // in range p. Then turned into the index in order at which thread t
+    // scatters its next item homed in range p.
+    std::vector<Index> counts(num_threads * num_threads, 0);
+    auto share_begin = [n, num_threads](int t) {
+      return static_cast<Index>(static_cast<int64_t>(n) * t / num_threads);
+    };
+    RunOnThreads(num_threads, [&](int t) {
+      std::vector<Index> thread_counts(num_threads, 0);
+      for (Index i = share_begin(t); i < share_begin(t + 1); ++i) {
+        hashcodes[i] = hashcode_of(i);
+        if (hashcodes[i] != -1) {
+          ++thread_counts[IndexFor(hashcodes[i]) >> range_bits];
+        }
+      }
+      std::copy(thread_counts.begin(), thread_counts.end(),
+          counts.begin() + t * num_threads);
+    });
+
+    // order[range_begin[p]] to order[range_begin[p + 1] - 1] are the items
+    // homed in range p
+    std::vector<Index> range_begin(num_threads + 1);
+    Index num_items = 0;
+    for (int p = 0; p < num_threads; ++p) {
+      range_begin[p] = num_items;
+      for (int t = 0; t < num_threads; ++t) {
+        Index count = counts[t * num_threads + p];
+        counts[t * num_threads + p] = num_items;
+        num_items += count;
+      }
+    }
+    range_begin[num_threads] = num_items;
+    std::vector<Index> order(num_items);
+    RunOnThreads(num_threads, [&](int t) {
+      Index* next_idx = &counts[t * num_threads];
+      for (Index i = share_begin(t); i < share_begin(t + 1); ++i) {
+        if (hashcodes[i] != -1) {
+          order[next_idx[IndexFor(hashcodes[i]) >> range_bits]++] = i;
+        }
+      }
+    });
+
+    // places item i at the given slot, which is empty or matches the item
+    auto place_at = [&](Index i, Index slot_idx) {
+      Entry& entry = table_[slot_idx];
+      bool inserted = !entry.IsValid();
+      if (inserted) {
+        entry.hashcode = hashcodes[i];
+      }
+      place(i, entry, inserted);
+      return inserted;
+    };
+
+    // probes from item i's home slot up to, but excluding, slot end
+    auto probe = [&](Index i, Index end) {
+      Index idx = IndexFor(hashcodes[i]);
+      while (idx != end && table_[idx].IsValid() &&
+          !(table_[idx].hashcode == hashcodes[i] && matches(i, table_[idx]))) {
+        idx = (idx + 1) & (table_size_ - 1);
+      }
+      return idx;
+    };
+
+    std::vector<std::vector<Index>> overflows(num_threads);
+    std::vector<Index> num_inserted(num_threads, 0);
+    RunOnThreads(num_threads, [&](int p) {
+      Index range_end = ((static_cast<Index>(p) + 1) << range_bits) &
+        (table_size_ - 1);
+      for (Index j = range_begin[p]; j < range_begin[p + 1]; ++j) {
+        Index i = order[j];
+        Index idx = probe(i, range_end);
+        if (idx == range_end) {
+          overflows[p].push_back(i);
+        } else if (place_at(i, idx)) {
+          ++num_inserted[p];
+        }
+      }
+    });
+
+    Index total_inserted = 0;
+    for (int p = 0; p < num_threads; ++p) {
+      total_inserted += num_inserted[p];
+      for (Index i : overflows[p]) {
+        // the table has room, so some slot stops the probe before it comes
+        // back around to the home slot
+        if (place_at(i, probe(i, -1))) {
+          ++total_inserted;
+        }
+      }
+    }
+
+    if (use_bloom_filter_) {
+      for (Index i : order) {
+        bloom_filter_.Insert(hashcodes[i]);
+      }
+    }
+    return total_inserted;
+  }
+
+  /**
+   * Allocates a table of the given size without constructing its entries.
+   */
+  static Entry* AllocRawTable(Index size) {
+    return static_cast<Entry*>(::operator new(sizeof(Entry) * size));
+  }
+
+  /**
+   * Allocates a table of the given size with all entries unallocated.
+   */
+  static Entry* AllocTable(Index size) {
+    Entry* table = AllocRawTable(size);
+    for (Index i = 0; i < size; ++i) {
+      new (table + i) Entry();
+    }
+    return table;
+  }
+
+  /**
+   * Destroys the first num_constructed entries of a table and frees it.
+   */
+  static void FreeTable(Entry* table, Index num_constructed) {
+    for (Index i = 0; i < num_constructed; ++i) {
+      table[i].~Entry();
+    }
+    ::operator delete(table);
+  }
+
+  /**
+   * Same as AllocTable(), but splits constructing the entries between
+   * num_threads threads. size must be divisible by num_threads.
+   */
+  static Entry* AllocTableParallel(Index size, int num_threads) {
+    Entry* table = AllocRawTable(size);
+    Index share = size / num_threads;
+    RunOnThreads(num_threads, [table, share](int t) {
+      for (Index i = share * t; i < share * (t + 1); ++i) {
+        new (table + i) Entry();
+      }
+    });
+    return table;
+  }
+
+  /**
+   * Same as FreeTable() for a fully constructed table, but splits destroying
+   * the entries between num_threads threads. size must be divisible by
+   * num_threads.
+   */
+  static void FreeTableParallel(Entry* table, Index size, int num_threads) {
+    Index share = size / num_threads;
+    RunOnThreads(num_threads, [table, share](int t) {
+      for (Index i = share * t; i < share * (t + 1); ++i) {
+        table[i].~Entry();
+      }
+    });
+    ::operator delete(table);
+  }
+
   /**
    * Frees any memory that has been allocated for this hashtable.
    */
   void FreeMem() {
     if (table_ != nullptr) {
-      delete[] table_;
+      FreeTable(table_, table_size_);
+      table_ = nullptr;
+    }
+    FreeIncrementalTables();
+  }
+
+  /**
+   * Frees the old, next and dead tables used by incremental resizing.
+   */
+  void FreeIncrementalTables() {
+    if (old_table_ != nullptr) {
+      FreeTable(old_table_, old_table_size_);
+      old_table_ = nullptr;
+      old_table_size_ = 0;
+      old_bloom_filter_ = BloomFilter();
+    }
+    if (next_table_ != nullptr) {
+      FreeTable(next_table_, next_table_constructed_);
+      next_table_ = nullptr;
+    }
+    while (dead_table_ != nullptr) {
+      DestroySome();
     }
   }
 
@@ -323,54 +1064,94 @@ private:
    * Copies another hashtable into this hashtable. Does not free any currently
    * allocated memory though.
    */
-  void CopyFrom(const Hashmap<Key, Val, Hash, Eq>& other) {
-    table_ = new Entry[other.table_size_];  
+  void CopyFrom(const Hashmap<Key, Val, Hash, Eq, Index>& other) {
+    table_ = AllocTable(other.table_size_);
     std::copy(other.table_, other.table_ + other.table_size_, table_);
     table_size_ = other.table_size_;
     size_ = other.size_;
     load_factor_ = other.load_factor_;
+    num_threads_ = other.num_threads_;
+    inserts_since_reseed_ = other.inserts_since_reseed_;
+    num_reseeds_ = other.num_reseeds_;
     hash_fn_ = other.hash_fn_;
     eq_fn_ = other.eq_fn_;
+
+    incremental_resize_ = other.incremental_resize_;
+    old_table_ = nullptr;
+    old_table_size_ = other.old_table_size_;
+    migrate_idx_ = other.migrate_idx_;
+    if (other.old_table_ != nullptr) {
+      old_table_ = AllocTable(other.old_table_size_);
+      std::copy(other.old_table_, other.old_table_ + other.old_table_size_,
+          old_table_);
+    }
+
+    use_bloom_filter_ = other.use_bloom_filter_;
+    bloom_filter_ = other.bloom_filter_;
+    old_bloom_filter_ = other.old_bloom_filter_;
   }
 
   /**
    * Moves another hastable into this hashtable. The other hashtable is
    * emptied and invalidated.
    */
-  void MoveFrom(Hashmap<Key, Val, Hash, Eq>& other) {
+  void MoveFrom(Hashmap<Key, Val, Hash, Eq, Index>& other) {
     table_ = other.table_;
     table_size_ = other.table_size_;
     size_ = other.size_;
     load_factor_ = other.load_factor_;
+    num_threads_ = other.num_threads_;
+    inserts_since_reseed_ = other.inserts_since_reseed_;
+    num_reseeds_ = other.num_reseeds_;
     hash_fn_ = std::move(other.hash_fn_);
     eq_fn_ = std::move(other.eq_fn_);
 
+    incremental_resize_ = other.incremental_resize_;
+    old_table_ = other.old_table_;
+    old_table_size_ = other.old_table_size_;
+    migrate_idx_ = other.migrate_idx_;
+    next_table_ = other.next_table_;
+    next_table_size_ = other.next_table_size_;
+    next_table_constructed_ = other.next_table_constructed_;
+    dead_table_ = other.dead_table_;
+    dead_table_size_ = other.dead_table_size_;
+    dead_table_destroyed_ = other.dead_table_destroyed_;
+    use_bloom_filter_ = other.use_bloom_filter_;
+    bloom_filter_ = std::move(other.bloom_filter_);
+    old_bloom_filter_ = std::move(other.old_bloom_filter_);
+
     other.table_ = nullptr;
+    other.old_table_ = nullptr;
+    other.next_table_ = nullptr;
+    other.dead_table_ = nullptr;
     // don't have to reset any of the other fields in other
   }
 
   /**
    * @return hash code for the given key
    */
-  inline int HashCode(const Key& k) const {
-    // std::hash returns a size_t, which is an unsigned int. Only keep bottom 31
-    // bits to prevent the hash from going negative when we coerce size_t into
-    // a signed int.
-    return hash_fn_(k) & ((2 << 31) - 1);
+  template<class K>
+  inline Index HashCode(const K& k) const {
+    // std::hash returns a size_t, which is unsigned. Only keep the bits below
+    // Index's sign bit so that the hashcode can't go negative (and clash with
+    // the -1 that marks unused entries) when we coerce it into an Index.
+    return static_cast<Index>(hash_fn_(k) &
+        static_cast<size_t>(std::numeric_limits<Index>::max()));
   }
 
   /**
    * @return the index in the underlying table at which the hashcode belongs.
    * Does not account for collisions in which lineary probing is required.
    */
-  inline int IndexFor(int hashcode) const {
+  inline Index IndexFor(Index hashcode) const {
     return hashcode & (table_size_ - 1);
   }
 
   /**
    * @return if the two keys are equivalent
    */
-  inline bool Equals(const Key& k1, const Key& k2) const {
+  template<class K>
+  inline bool Equals(const K& k1, const Key& k2) const {
     return eq_fn_(k1, k2);
   }
 
@@ -383,15 +1164,27 @@ private:
    * be inserted. Returns -1 if the table is completely full and the element
    * is not there.
    */
-  int LocateEntryIdx(const Key& k, int hashcode=-1) const {
+  template<class K>
+  Index LocateEntryIdx(const K& k, Index hashcode=-1) const {
     if (hashcode == -1) {
       hashcode = HashCode(k);
     }
-    int expected_idx = IndexFor(hashcode); 
-    int idx_to_check = expected_idx;
+    return LocateEntryIdxIn(table_, table_size_, k, hashcode);
+  }
+
+  /**
+   * Same as LocateEntryIdx(), but searches the given table instead of table_.
+   * Used to search the old table while an incremental resize is migrating
+   * entries out of it.
+   */
+  template<class K>
+  Index LocateEntryIdxIn(const Entry* table, Index table_size, const K& k,
+      Index hashcode) const {
+    Index expected_idx = hashcode & (table_size - 1);
+    Index idx_to_check = expected_idx;
 
-    for (int i = 0; i < table_size_; ++i) {
-      const Entry& entry_to_check = table_[idx_to_check];
+    for (Index i = 0; i < table_size; ++i) {
+      const Entry& entry_to_check = table[idx_to_check];
 
       // is the entry the one we're looking for?
       bool is_correct_entry = (entry_to_check.IsValid() &&
@@ -411,36 +1204,338 @@ private:
 
       // apply linear probing and advance forward to the next index,
       // rolling over to index 0 if we reach the end of the hashtable 
-      idx_to_check = (idx_to_check + 1) & (table_size_ - 1);
+      idx_to_check = (idx_to_check + 1) & (table_size - 1);
     }
 
     // table is completely full and the element was not found
     return -1;
   }
 
-  void Resize() {
+  /**
+   * Removes the valid entry at remove_idx from the given table, shifting
+   * entries later in its chain of collisions back so that linear probing
+   * still finds them. Does not update size_.
+   */
+  void RemoveEntryAt(Entry* table, Index table_size, Index remove_idx) {
+    Index unoccupied_idx = remove_idx;
+    Index idx_to_check = unoccupied_idx;
+    while (true) {
+      idx_to_check = (idx_to_check + 1) & (table_size - 1);
+
+      // if we reach an unoccupied spot, we're done
+      if (!table[idx_to_check].IsValid()) {
+        break;
+      }
+
+      // if table is completely full and we've gone one full cycle around
+      // then we're done
+      if (idx_to_check == remove_idx) {
+        break;
+      }
+
+      // this is where the entry we're checking should belong if there
+      // were no collisions, a.k.a the canonical index
+      Index idx_for_entry_to_check =
+          table[idx_to_check].hashcode & (table_size - 1);
+
+      // But if there were collisions and the entry was shifted via linear
+      // probing, we *may* be able to move it into the unoccupied spot
+      // under two conditions.
+      //
+      // At this point, every element from [remove_idx, idx_to_check] is
+      // occupied except for the element at unoccupied_idx.
+
+      // If there is no wraparound yet, then we can move the entry into the
+      // unoccupied spot if...
+      //    1. the candidate entry's canonical index in the table is earlier
+      //       than the unoccupied spot. This means we're just shifting the
+      //       candidate entry earlier in the chain of collisions, which will
+      //       speed up finding it in future searches.
+      //                              OR
+      //    2. the candidate entry's canonical index in the table is after the
+      //       current index that we're checking. If the candidate was
+      //       properly placed at the current index we're checking, then
+      //       everything from [0, idx_to_check] and from
+      //       [idx_for_entry_to_check, table_end] must be occupied. This
+      //       means that the candidate entry belongs at
+      //       idx_for_entry_to_check and wrapped all the way around due
+      //       to collisions with the linear probing. So by moving the
+      //       candidate entry to an earlier spot, we're just shifting the
+      //       candidate entry to earlier in the chain of collisions.
+      //
+      // In either case, we're just shifting the candidate entry to earlier
+      // in the chain of collisions.
+      bool not_wrapped_around_and_can_move =
+        (idx_to_check > unoccupied_idx) &&
+        (idx_for_entry_to_check <= unoccupied_idx ||
+         idx_for_entry_to_check > idx_to_check);
+
+      // If there is wrapround, then we can move the entry into the unoccupied
+      // spot if...
+      //    1. the candidate entry's canonical index in the table is earlier
+      //       than the unoccupied spot.
+      //                          AND
+      //    2. the candidate entry's canonical index in the table is greater
+      //       than the current index we're checking.
+      //
+      // The first condition guarantees that we're shifting the element
+      // earlier in the chain of collisions. The second condition guarantees
+      // we're not moving an element farther away from where it should be and
+      // thus introducing a "gap" in it's linear probing chain.
+      //
+      // As an example of why not remove when
+      // idx_for_entry_to_check <= idx_to_check, consider this table:
+      //                         [a, b, c, d]
+      // where b, c and d hash to index 3 and a hashes to index 0. (So 
+      // we inserted d, then a, then b, and then c).
+      //
+      // If we delete d, then we get an unoccupied space at index 3.
+      //                        [a, b, c, -]
+      // The remove algorithm then considers moving a down to replace d.
+      // But we shouldn't move a because it's already in the correct spot!
+      // It's only when idx_for_entry_to_check > idx_to_check (indicating
+      // that the candidate entry wrapped around due to collisions) that we're
+      // actually moving the element closer to it's canonical index.
+      bool wrapped_around_and_can_move = (idx_to_check < unoccupied_idx) &&
+        (idx_for_entry_to_check <= unoccupied_idx &&
+         idx_for_entry_to_check > idx_to_check);
+
+      if (not_wrapped_around_and_can_move || wrapped_around_and_can_move) {
+        table[unoccupied_idx] = std::move(table[idx_to_check]); 
+        unoccupied_idx = idx_to_check;
+        DSALGO_HASHMAP_STATS_ONLY(++stats_.remove_shifts);
+      }
+    }
+    table[unoccupied_idx].Invalidate();
+  }
+
+  /**
+   * Doubles the table until num_entries entries fit under the load factor.
+   */
+  void Resize(Index num_entries) {
+    DSALGO_HASHMAP_STATS_ONLY(ResizeTimer timer(&stats_));
+
+    // if the previous incremental resize hasn't finished yet, all of its
+    // entries have to be in table_ before table_ itself can be replaced.
+    FinishMigration();
 
     // back up old table data
     Entry* old_table = table_;
-    int old_table_size = table_size_;
+    Index old_table_size = table_size_;
 
-    // create new table
-    while (size_ >= table_size_ * load_factor_) {
+    // create new table, reusing the one incremental resizing has been
+    // constructing if it has the right size
+    while (num_entries >= table_size_ * load_factor_) {
       table_size_ *= 2;
     }
-    table_ = new Entry[table_size_];
+    int num_threads = incremental_resize_ ? 1 : ThreadsFor(table_size_);
+    if (next_table_ != nullptr && next_table_size_ == table_size_) {
+      while (next_table_constructed_ < next_table_size_) {
+        ConstructSome();
+      }
+      table_ = next_table_;
+      next_table_ = nullptr;
+    } else {
+      FreeIncrementalTables();
+      table_ = num_threads > 1 ? AllocTableParallel(table_size_, num_threads) :
+        AllocTable(table_size_);
+    }
+
+    // the filter is rebuilt for the new table, which drops removed keys.
+    // Entries are added to it as they move into the new table.
+    if (use_bloom_filter_) {
+      old_bloom_filter_ = std::move(bloom_filter_);
+      bloom_filter_ = BuildBloomFilter(table_, 0);
+    }
+
+    // let subsequent operations migrate the old table's entries
+    if (incremental_resize_) {
+      old_table_ = old_table;
+      old_table_size_ = old_table_size;
+      migrate_idx_ = 0;
+      return;
+    }
+    old_bloom_filter_ = BloomFilter();
+
+    if (num_threads > 1) {
+      // unused entries have hashcode -1 and are skipped. Keys in the old
+      // table are distinct, so no entry can match another.
+      InsertParallel(old_table_size, num_threads,
+          [old_table](Index i) {
+            return old_table[i].hashcode;
+          },
+          [](Index, const Entry&) {
+            return false;
+          },
+          [old_table](Index i, Entry& entry, bool) {
+            entry = std::move(old_table[i]);
+          });
+      FreeTableParallel(old_table, old_table_size,
+          std::min(num_threads, ThreadsFor(old_table_size)));
+      return;
+    }
 
     // re-insert all the valid elements in the old table
-    for (int i = 0; i < old_table_size; ++i) {
+    for (Index i = 0; i < old_table_size; ++i) {
       if (old_table[i].IsValid()) {
-        int insert_idx = LocateEntryIdx(old_table[i].k);
+        Index insert_idx = LocateEntryIdx(old_table[i].k,
+            old_table[i].hashcode);
         assert(insert_idx != -1);
+        if (use_bloom_filter_) {
+          bloom_filter_.Insert(old_table[i].hashcode);
+        }
         table_[insert_idx] = std::move(old_table[i]);
       }
     }
 
     // free old table memory
-    delete[] old_table;
+    FreeTable(old_table, old_table_size);
+  }
+
+  /**
+   * Switches hash_fn_ to a fresh seed and rehashes every entry into a new
+   * table of the same size.
+   */
+  void Reseed(std::true_type) {
+    FinishMigration();
+    FreeIncrementalTables();
+    hash_fn_.Reseed();
+    ++num_reseeds_;
+    DSALGO_HASHMAP_STATS_ONLY(++stats_.num_reseeds);
+
+    Entry* old_table = table_;
+    table_ = AllocTable(table_size_);
+    for (Index i = 0; i < table_size_; ++i) {
+      if (old_table[i].IsValid()) {
+        Index hashcode = HashCode(old_table[i].k);
+        Index insert_idx = LocateEntryIdx(old_table[i].k, hashcode);
+        table_[insert_idx] = std::move(old_table[i]);
+        table_[insert_idx].hashcode = hashcode;
+      }
+    }
+    FreeTable(old_table, table_size_);
+
+    if (use_bloom_filter_) {
+      bloom_filter_ = BuildBloomFilter(table_, table_size_);
+    }
+    inserts_since_reseed_ = 0;
+  }
+
+  /**
+   * Never called, since only reseedable hashes trigger reseeding.
+   */
+  void Reseed(std::false_type) {}
+
+  /**
+   * Performs a bounded amount of incremental resizing work: migrating the old
+   * table, destroying the dead table, and constructing the next table. The
+   * next table starts being constructed once the hashmap is 3/4 of the way to
+   * its next resize, which leaves enough operations to construct all of it a
+   * few slots at a time.
+   */
+  void DoIncrementalWork() {
+    if (old_table_ != nullptr) {
+      MigrateSome();
+    }
+    if (dead_table_ != nullptr) {
+      DestroySome();
+    }
+    if (next_table_ != nullptr) {
+      ConstructSome();
+    } else if (size_ >= 0.75 * load_factor_ * table_size_) {
+      next_table_size_ = table_size_ * 2;
+      next_table_ = AllocRawTable(next_table_size_);
+      next_table_constructed_ = 0;
+    }
+  }
+
+  /**
+   * Constructs up to kConstructionStepsPerOp more entries of the next table.
+   */
+  void ConstructSome() {
+    Index end = std::min(next_table_constructed_ + kConstructionStepsPerOp,
+        next_table_size_);
+    for (Index i = next_table_constructed_; i < end; ++i) {
+      new (next_table_ + i) Entry();
+    }
+    next_table_constructed_ = end;
+  }
+
+  /**
+   * Destroys up to kConstructionStepsPerOp more entries of the dead table,
+   * freeing it after the last one.
+   */
+  void DestroySome() {
+    Index end = std::min(dead_table_destroyed_ + kConstructionStepsPerOp,
+        dead_table_size_);
+    for (Index i = dead_table_destroyed_; i < end; ++i) {
+      dead_table_[i].~Entry();
+    }
+    dead_table_destroyed_ = end;
+    if (dead_table_destroyed_ == dead_table_size_) {
+      ::operator delete(dead_table_);
+      dead_table_ = nullptr;
+    }
+  }
+
+  /**
+   * Migrates up to kMigrationStepsPerOp slots of the old table into table_.
+   */
+  void MigrateSome() {
+    for (int i = 0; i < kMigrationStepsPerOp && old_table_ != nullptr; ++i) {
+      MigrateOneSlot();
+    }
+  }
+
+  /**
+   * Migrates everything that is left in the old table into table_.
+   */
+  void FinishMigration() {
+    while (old_table_ != nullptr) {
+      MigrateOneSlot();
+    }
+  }
+
+  /**
+   * Moves the entry at migrate_idx_ of the old table into table_, or advances
+   * migrate_idx_ if that slot is empty. Hands the old table off to be
+   * destroyed once every slot has been migrated.
+   *
+   * Entries are taken out of the old table with RemoveEntryAt() so the old
+   * table stays a valid linear-probing table that Get() and Remove() can
+   * search. That removal may shift a later entry back into migrate_idx_, so
+   * migrate_idx_ only advances once its slot is empty. Every slot before
+   * migrate_idx_ is always empty.
+   */
+  void MigrateOneSlot() {
+    if (migrate_idx_ == old_table_size_) {
+      // the empty old table becomes the dead table and gets destroyed by
+      // later operations
+      while (dead_table_ != nullptr) {
+        DestroySome();
+      }
+      dead_table_ = old_table_;
+      dead_table_size_ = old_table_size_;
+      dead_table_destroyed_ = 0;
+      old_table_ = nullptr;
+      old_table_size_ = 0;
+      old_bloom_filter_ = BloomFilter();
+      return;
+    }
+
+    Entry& to_migrate = old_table_[migrate_idx_];
+    if (!to_migrate.IsValid()) {
+      ++migrate_idx_;
+      return;
+    }
+
+    Index insert_idx = LocateEntryIdx(to_migrate.k, to_migrate.hashcode);
+    assert(insert_idx != -1);
+    if (use_bloom_filter_) {
+      bloom_filter_.Insert(to_migrate.hashcode);
+    }
+    table_[insert_idx] = std::move(to_migrate);
+    RemoveEntryAt(old_table_, old_table_size_, migrate_idx_);
   }
 
 private:
@@ -449,10 +1544,10 @@ private:
   Entry* table_ = nullptr;
   
   // size of the underlying table, must be a power of 2.
-  int table_size_ = 0;
+  Index table_size_ = 0;
 
   // number of entries in the hashmap.
-  int size_ = 0;
+  Index size_ = 0;
 
   // hashmap will resize when number of entires exceeds
   // table_size_ * load_factor_
@@ -461,6 +1556,90 @@ private:
   Hash hash_fn_;
 
   Eq eq_fn_;
+
+  // number of keys whose home slots GetMany() and PutMany() prefetch at a
+  // time. Large enough to keep every line fill buffer busy.
+  static constexpr int kBatchSize = 16;
+
+  // number of old table slots that each Put() or Remove() migrates during an
+  // incremental resize.
+  static constexpr int kMigrationStepsPerOp = 16;
+
+  // number of next/dead table entries that each Put() or Remove() constructs
+  // or destroys during incremental resizing.
+  static constexpr int kConstructionStepsPerOp = 64;
+
+  // false positive rate of the Bloom filter once the table is full up to the
+  // load factor. About 10 bits per entry.
+  static constexpr double kBloomFalsePositiveRate = 0.01;
+
+  // fewest table slots per thread, and fewest keys in a PutMany() batch,
+  // worth starting threads for.
+  static constexpr int kMinParallelWork = 1 << 16;
+
+  // maximum number of threads Resize() and PutMany() may use
+  int num_threads_ = 1;
+
+  // with a reseedable Hash, inserting a key this many slots past its home
+  // slot makes the hashmap reseed. Random keys at a 0.7 load factor don't
+  // come close even in a 2^25 slot table.
+  static constexpr int kReseedProbeLength = 256;
+
+  // number of keys inserted since the last reseed
+  Index inserts_since_reseed_ = 0;
+
+  // number of times hash_fn_ was reseeded, so that hashcodes computed ahead
+  // of time can tell they're stale
+  int64_t num_reseeds_ = 0;
+
+#ifdef DSALGO_HASHMAP_STATS
+  // counters behind GetStats(). Not copied or moved with the hashmap.
+  mutable StatsCounters stats_;
+#endif
+
+  // if resizes should migrate the old table incrementally
+  bool incremental_resize_ = false;
+
+  // table that an incremental resize is migrating entries out of, or nullptr
+  // if no migration is in progress.
+  Entry* old_table_ = nullptr;
+
+  // size of old_table_
+  Index old_table_size_ = 0;
+
+  // every slot of old_table_ before this index has been migrated
+  Index migrate_idx_ = 0;
+
+  // table that will replace table_ at the next resize, constructed a few
+  // entries at a time. nullptr if it hasn't been allocated yet.
+  Entry* next_table_ = nullptr;
+
+  // size of next_table_
+  Index next_table_size_ = 0;
+
+  // entries of next_table_ before this index have been constructed
+  Index next_table_constructed_ = 0;
+
+  // fully migrated old table that is being destroyed a few entries at a time,
+  // or nullptr if there is none.
+  Entry* dead_table_ = nullptr;
+
+  // size of dead_table_
+  Index dead_table_size_ = 0;
+
+  // entries of dead_table_ before this index have been destroyed
+  Index dead_table_destroyed_ = 0;
+
+  // if Get() should consult bloom_filter_ before probing
+  bool use_bloom_filter_ = false;
+
+  // hashcodes of the entries in table_ and of removed entries since the last
+  // resize. Has no blocks unless use_bloom_filter_ is set.
+  BloomFilter bloom_filter_;
+
+  // hashcodes of the entries in old_table_, while an incremental resize is
+  // migrating it.
+  BloomFilter old_bloom_filter_;
 };
 
 } // namespace dsalgo
@@ -0,0 +1,352 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+
+namespace dsalgo {
+
+/**
+ * Hashmap with linear probing for integer keys, where one key value is never
+ * used and can mark empty slots.
+ *
+ * Hashmap stores an int hashcode in every entry to mark empty slots and to
+ * avoid rehashing keys on resize. For integer keys, hashing is cheaper than
+ * loading a stored hashcode, so IntHashmap stores neither: a slot is empty if
+ * its key is EmptyKey, and hashes are recomputed whenever needed. An
+ * IntHashmap<int64_t, int64_t> slot is 16 bytes instead of Hashmap's 24.
+ *
+ * The hash is spread over the table with Fibonacci hashing (multiplying by
+ * 2^64 / golden ratio and keeping the high bits), because std::hash is the
+ * identity for integers and keys like IDs often only differ in their high
+ * bits.
+ *
+ * Key = integer type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * EmptyKey = key value that is never put in the hashmap
+ * Hash = hash function for the key
+ */
+template<
+  class Key,
+  class Val,
+  Key EmptyKey=std::numeric_limits<Key>::max(),
+  class Hash=std::hash<Key>
+  >
+class IntHashmap {
+
+  static_assert(std::is_integral<Key>::value,
+      "IntHashmap keys must be integers");
+
+public:
+
+  /**
+   * Creates a hashmap with the specified initial maximum capacity and load
+   * factor.
+   *
+   * @param init_capacity initial maximum capacity of the hashmap if the load
+   * factor were 1. Rounded up to the next power of 2.
+   * @param load_factor how soon to resize the hashmap. When the hashmap
+   * contains capacity * load_factor entries, it will double in size.
+   */
+  IntHashmap(int init_capacity, float load_factor=0.7)
+      : load_factor_(load_factor) {
+
+    if (init_capacity < 8) {
+      init_capacity = 8;
+    }
+
+    table_size_ = IsPowerOf2(init_capacity) ?
+      init_capacity :
+      NextPowerOf2(init_capacity);
+
+    table_ = AllocTable(table_size_);
+  }
+
+  IntHashmap() : IntHashmap(8) {}
+
+  ~IntHashmap() {
+    FreeMem();
+  }
+
+  IntHashmap(const IntHashmap<Key, Val, EmptyKey, Hash>& other) {
+    CopyFrom(other);
+  }
+
+  IntHashmap(IntHashmap<Key, Val, EmptyKey, Hash>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  IntHashmap<Key, Val, EmptyKey, Hash>& operator=(
+      const IntHashmap<Key, Val, EmptyKey, Hash>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  IntHashmap<Key, Val, EmptyKey, Hash>& operator=(
+      IntHashmap<Key, Val, EmptyKey, Hash>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Maps the given key to the given value, overwriting any previous mapping.
+   *
+   * If the hashmap resizes after Put() is called, then all references and
+   * pointers to values in the hashmap are invalidated.
+   *
+   * @param k key to insert
+   * @param v value to which to map the key
+   * @throws invalid_argument if k is EmptyKey
+   */
+  void Put(Key k, const Val& v) {
+    FindOrInsert(k)->v = v;
+  }
+
+  /**
+   * Gets the value to which the given key is mapped, inserting a default
+   * constructed value if the key is not in the hashmap.
+   *
+   * @throws invalid_argument if k is EmptyKey
+   */
+  Val& operator[](Key k) {
+    return FindOrInsert(k)->v;
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  Val* Get(Key k) const {
+    if (UNLIKELY(k == EmptyKey)) {
+      return nullptr;
+    }
+    int idx = LocateEntryIdx(k);
+    return (table_[idx].k != EmptyKey) ? &table_[idx].v : nullptr;
+  }
+
+  /**
+   * Removes the given key from the hashmap if present. Otherwise, does nothing.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(Key k) {
+    if (UNLIKELY(k == EmptyKey)) {
+      return false;
+    }
+    int remove_idx = LocateEntryIdx(k);
+    if (table_[remove_idx].k == EmptyKey) {
+      return false;
+    }
+
+    // shift entries later in the chain of collisions back, so that linear
+    // probing still finds them. An entry can fill the unoccupied slot if that
+    // doesn't move it before its home slot.
+    int mask = table_size_ - 1;
+    int unoccupied_idx = remove_idx;
+    int idx_to_check = remove_idx;
+    while (true) {
+      idx_to_check = (idx_to_check + 1) & mask;
+      if (table_[idx_to_check].k == EmptyKey) {
+        break;
+      }
+      int home_idx = IndexFor(table_[idx_to_check].k);
+      if (((idx_to_check - home_idx) & mask) >=
+          ((idx_to_check - unoccupied_idx) & mask)) {
+        table_[unoccupied_idx] = std::move(table_[idx_to_check]);
+        unoccupied_idx = idx_to_check;
+      }
+    }
+    table_[unoccupied_idx].k = EmptyKey;
+    table_[unoccupied_idx].v = Val();
+    --size_;
+    return true;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Removes all elements from this hashmap.
+   */
+  void Clear() {
+    for (int i = 0; i < table_size_; ++i) {
+      table_[i].k = EmptyKey;
+      table_[i].v = Val();
+    }
+    size_ = 0;
+  }
+
+  /**
+   * Calls f(key, value) on every entry in this hashmap, in no particular
+   * order. f must not modify the hashmap.
+   */
+  template<class F>
+  void ForEach(F f) const {
+    for (int i = 0; i < table_size_; ++i) {
+      if (table_[i].k != EmptyKey) {
+        f(table_[i].k, table_[i].v);
+      }
+    }
+  }
+
+private:
+
+  /**
+   * Represents an entry in the hashmap. Unused if k is EmptyKey.
+   */
+  struct Entry {
+    Key k = EmptyKey;
+    Val v;
+  };
+
+  /**
+   * Allocates a table of the given size with every entry empty.
+   */
+  static Entry* AllocTable(int size) {
+    return new Entry[size];
+  }
+
+  /**
+   * Frees any memory that has been allocated for this hashtable.
+   */
+  void FreeMem() {
+    if (table_ != nullptr) {
+      delete[] table_;
+      table_ = nullptr;
+    }
+  }
+
+  /**
+   * Copies another hashtable into this hashtable. Does not free any currently
+   * allocated memory though.
+   */
+  void CopyFrom(const IntHashmap<Key, Val, EmptyKey, Hash>& other) {
+    table_ = AllocTable(other.table_size_);
+    std::copy(other.table_, other.table_ + other.table_size_, table_);
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = other.hash_fn_;
+  }
+
+  /**
+   * Moves another hashtable into this hashtable. The other hashtable is
+   * emptied and invalidated.
+   */
+  void MoveFrom(IntHashmap<Key, Val, EmptyKey, Hash>& other) {
+    table_ = other.table_;
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = std::move(other.hash_fn_);
+
+    other.table_ = nullptr;
+  }
+
+  /**
+   * @return the index in the underlying table at which the key belongs if
+   * there were no collisions.
+   */
+  inline int IndexFor(Key k) const {
+    return FibonacciIndex(hash_fn_(k), table_size_);
+  }
+
+  /**
+   * @return index in the underlying table at which the key is located if the
+   * key is in the hashmap. Otherwise, returns the empty slot at which the key
+   * should be inserted. The table is never full, so there always is one.
+   */
+  int LocateEntryIdx(Key k) const {
+    int idx = IndexFor(k);
+    while (table_[idx].k != k && table_[idx].k != EmptyKey) {
+      idx = (idx + 1) & (table_size_ - 1);
+    }
+    return idx;
+  }
+
+  /**
+   * @return the entry for the key, inserting an entry with a default
+   * constructed value if the key is not in the hashmap.
+   */
+  Entry* FindOrInsert(Key k) {
+    if (UNLIKELY(k == EmptyKey)) {
+      throw std::invalid_argument(
+          "Cannot put the empty key into an IntHashmap.");
+    }
+    int idx = LocateEntryIdx(k);
+    if (table_[idx].k == k) {
+      return &table_[idx];
+    }
+
+    // only resize when inserting, keeping at least one slot empty
+    if (size_ + 1 >= load_factor_ * table_size_ || size_ + 1 >= table_size_) {
+      Resize();
+      idx = LocateEntryIdx(k);
+    }
+    table_[idx].k = k;
+    ++size_;
+    return &table_[idx];
+  }
+
+  void Resize() {
+
+    // back up old table data
+    Entry* old_table = table_;
+    int old_table_size = table_size_;
+
+    // create new table
+    while (size_ + 1 >= table_size_ * load_factor_ ||
+        size_ + 1 >= table_size_) {
+      table_size_ *= 2;
+    }
+    table_ = AllocTable(table_size_);
+
+    // re-insert all the valid elements in the old table. They are known to
+    // be distinct, so they just need an empty slot.
+    for (int i = 0; i < old_table_size; ++i) {
+      if (old_table[i].k != EmptyKey) {
+        int idx = IndexFor(old_table[i].k);
+        while (table_[idx].k != EmptyKey) {
+          idx = (idx + 1) & (table_size_ - 1);
+        }
+        table_[idx] = std::move(old_table[i]);
+      }
+    }
+
+    // free old table memory
+    delete[] old_table;
+  }
+
+private:
+
+  // underlying table for the hashmap
+  Entry* table_ = nullptr;
+
+  // size of the underlying table, must be a power of 2.
+  int table_size_ = 0;
+
+  // number of entries in the hashmap.
+  int size_ = 0;
+
+  // hashmap will resize when number of entires exceeds
+  // table_size_ * load_factor_
+  float load_factor_ = 0;
+
+  Hash hash_fn_;
+};
+
+} // namespace dsalgo
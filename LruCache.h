@@ -0,0 +1,342 @@
+#pragma once
+
+#include "Hashmap.h"
+#include "Utils.h"
+#include <assert.h>
+#include <functional>
+#include <utility>
+
+
+namespace dsalgo {
+
+/**
+ * Key-value cache holding at most a fixed number of entries. Putting a new
+ * key into a full cache evicts the least-recently used entry. Get() and Put()
+ * both count as a use.
+ *
+ * Like LruQueue, all entries live in one array of linked list nodes
+ * allocated up front, which are recycled rather than freed, and a Hashmap
+ * maps each key to its node. A hit costs one hash probe and unlinking and
+ * relinking one node. A miss additionally removes the evicted key from the
+ * hashmap. Nothing is allocated after construction.
+ *
+ * Hashmap masks off the low bits of a hash, and std::hash is the identity for
+ * integers, so a cache of popular integer keys, which are often consecutive
+ * IDs, would fill the index with one huge cluster. The index spreads every
+ * hash with FibonacciHash first.
+ *
+ * Key and Val must be default constructible.
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class LruCache {
+
+public:
+
+  /**
+   * @param capacity maximum number of entries. Must be at least 1.
+   */
+  LruCache(int capacity) : capacity_(capacity) {
+    assert(capacity >= 1);
+    AllocMem();
+  }
+
+  ~LruCache() {
+    FreeMem();
+  }
+
+  LruCache(const LruCache<Key, Val, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  LruCache(LruCache<Key, Val, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  LruCache& operator=(const LruCache<Key, Val, Hash, Eq>& other) {
+    if (this != &other) {
+      FreeMem();
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  LruCache& operator=(LruCache<Key, Val, Hash, Eq>&& other) noexcept {
+    if (this != &other) {
+      FreeMem();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  /**
+   * Looks up a key and marks it as most-recently used.
+   *
+   * @return the value the key is mapped to, or nullptr if the key isn't in
+   * the cache. Valid until the key is erased or evicted.
+   */
+  Val* Get(const Key& k) {
+    LruEntry** found = index_.Get(k);
+    if (found == nullptr) {
+      return nullptr;
+    }
+    MarkUsed(*found);
+    return &(*found)->v;
+  }
+
+  /**
+   * Looks up a key without marking it as used.
+   *
+   * @return the value the key is mapped to, or nullptr if the key isn't in
+   * the cache.
+   */
+  const Val* Peek(const Key& k) const {
+    LruEntry** found = index_.Get(k);
+    return found == nullptr ? nullptr : &(*found)->v;
+  }
+
+  /**
+   * Maps the key to the value and marks it as most-recently used. If the key
+   * is new and the cache is full, the least-recently used entry is evicted.
+   *
+   * @return true if the key was inserted, false if its value was replaced.
+   */
+  bool Put(const Key& k, const Val& v) {
+    std::pair<LruEntry**, bool> found = index_.TryEmplace(k);
+    if (!found.second) {
+      (*found.first)->v = v;
+      MarkUsed(*found.first);
+      return false;
+    }
+
+    LruEntry* entry = free_;
+    if (entry != nullptr) {
+      free_ = entry->next_;
+      *found.first = entry;
+      ++size_;
+    } else {
+      // full, so recycle the least-recently used entry. The index has room
+      // for one more key than the capacity, so inserting k didn't resize
+      // it. Removing the evicted key may shift k's slot, so k's node has to
+      // be stored first.
+      entry = lru_;
+      Unlink(entry);
+      *found.first = entry;
+      index_.Remove(entry->k);
+    }
+    entry->k = k;
+    entry->v = v;
+    Append(entry);
+    return true;
+  }
+
+  /**
+   * Removes a key from the cache.
+   *
+   * @return if the key was in the cache.
+   */
+  bool Erase(const Key& k) {
+    LruEntry** found = index_.Get(k);
+    if (found == nullptr) {
+      return false;
+    }
+    LruEntry* entry = *found;
+    index_.Remove(k);
+    Unlink(entry);
+    Release(entry);
+    --size_;
+    return true;
+  }
+
+  /**
+   * @return key of the least-recently used entry, the next to be evicted.
+   * The cache must not be empty.
+   */
+  const Key& GetLru() const {
+    assert(lru_ != nullptr);
+    return lru_->k;
+  }
+
+  /**
+   * Removes every entry. Keeps the preallocated nodes.
+   */
+  void Clear() {
+    while (lru_ != nullptr) {
+      LruEntry* entry = lru_;
+      Unlink(entry);
+      Release(entry);
+    }
+    index_.Clear();
+    size_ = 0;
+  }
+
+  int Size() const {
+    return size_;
+  }
+
+  int Capacity() const {
+    return capacity_;
+  }
+
+private:
+
+  /**
+   * A node of the linked list of entries, from least- to most-recently used.
+   * Unused nodes are chained through next_ into the free list.
+   */
+  struct LruEntry {
+    Key k;
+    Val v;
+    LruEntry* prev_ = nullptr;
+    LruEntry* next_ = nullptr;
+  };
+
+  /**
+   * Allocates capacity_ nodes, all on the free list, and an index big enough
+   * to never resize.
+   */
+  void AllocMem() {
+    mem_ = new LruEntry[capacity_];
+    for (int i = 0; i + 1 < capacity_; ++i) {
+      mem_[i].next_ = mem_ + i + 1;
+    }
+    free_ = mem_;
+    index_.Reserve(capacity_ + 1);
+  }
+
+  /**
+   * Releases all heap memory allocated by this LruCache.
+   */
+  void FreeMem() {
+    delete[] mem_;
+    mem_ = nullptr;
+    lru_ = nullptr;
+    mru_ = nullptr;
+    free_ = nullptr;
+    size_ = 0;
+  }
+
+  /**
+   * Deep copies another LruCache, preserving its LRU order.
+   *
+   * Note that no memory clean up is performed before copying. Call FreeMem()
+   * before calling CopyFrom() if you need to clean up the current object.
+   */
+  void CopyFrom(const LruCache<Key, Val, Hash, Eq>& other) {
+    capacity_ = other.capacity_;
+    index_ = Hashmap<Key, LruEntry*, FibonacciHash<Hash>, Eq>();
+    AllocMem();
+    for (LruEntry* curr = other.lru_; curr != nullptr; curr = curr->next_) {
+      Put(curr->k, curr->v);
+    }
+  }
+
+  /**
+   * Moves another LruCache's contents into this cache. The other cache is
+   * left empty, with a capacity of 0, and must be assigned to before reuse.
+   */
+  void MoveFrom(LruCache<Key, Val, Hash, Eq>& other) {
+    capacity_ = other.capacity_;
+    size_ = other.size_;
+    mem_ = other.mem_;
+    lru_ = other.lru_;
+    mru_ = other.mru_;
+    free_ = other.free_;
+    index_ = std::move(other.index_);
+    other.capacity_ = 0;
+    other.size_ = 0;
+    other.mem_ = nullptr;
+    other.lru_ = nullptr;
+    other.mru_ = nullptr;
+    other.free_ = nullptr;
+  }
+
+  /**
+   * Moves a linked entry to the most-recently used end of the list.
+   */
+  void MarkUsed(LruEntry* entry) {
+    if (entry != mru_) {
+      Unlink(entry);
+      Append(entry);
+    }
+  }
+
+  /**
+   * Adds an unlinked entry to the most-recently used end of the list.
+   */
+  void Append(LruEntry* entry) {
+    entry->prev_ = mru_;
+    entry->next_ = nullptr;
+    if (mru_ != nullptr) {
+      mru_->next_ = entry;
+    } else {
+      lru_ = entry;
+    }
+    mru_ = entry;
+  }
+
+  /**
+   * Removes an entry from the list, but DOES NOT free it.
+   */
+  void Unlink(LruEntry* entry) {
+    if (entry->prev_ != nullptr) {
+      entry->prev_->next_ = entry->next_;
+    } else {
+      lru_ = entry->next_;
+    }
+    if (entry->next_ != nullptr) {
+      entry->next_->prev_ = entry->prev_;
+    } else {
+      mru_ = entry->prev_;
+    }
+  }
+
+  /**
+   * Puts an unlinked entry on the free list, releasing whatever its key and
+   * value hold.
+   */
+  void Release(LruEntry* entry) {
+    entry->k = Key();
+    entry->v = Val();
+    entry->prev_ = nullptr;
+    entry->next_ = free_;
+    free_ = entry;
+  }
+
+private:
+
+  int capacity_ = 0;
+
+  int size_ = 0;
+
+  /**
+   * Memory allocated for the linked list nodes.
+   */
+  LruEntry* mem_ = nullptr;
+
+  /**
+   * The head of the linked list - the least recently used entry.
+   */
+  LruEntry* lru_ = nullptr;
+
+  /**
+   * The tail of the linked list - the most recently used entry.
+   */
+  LruEntry* mru_ = nullptr;
+
+  /**
+   * Unused nodes, linked through next_.
+   */
+  LruEntry* free_ = nullptr;
+
+  /**
+   * Maps each key to its node.
+   */
+  Hashmap<Key, LruEntry*, FibonacciHash<Hash>, Eq> index_;
+};
+
+} // namespace dsalgo
@@ -4,6 +4,7 @@
 #include "Utils.h"
 #include <assert.h>
 #include <new>
+#include <stdint.h>
 #include <vector>
 
 
@@ -15,6 +16,13 @@ namespace dsalgo {
  * time. After construction, GetLru() and MarkUsed() are both O(1).
  *
  * Every element in the LruQueue should have a unique hash.
+ *
+ * All entries live in a single array, so the linked list and the hashmap
+ * refer to entries by their 32-bit index in it rather than by pointer. Each
+ * entry carries 8 bytes of links instead of 16, and each hashmap slot a
+ * 4-byte index instead of an 8-byte pointer, e.g. 16-byte entries and
+ * 16-byte hashmap slots for 8-byte elements instead of 24 and 24. Supports
+ * up to 2^31 - 1 elements.
  */
 template <typename T>
 class LruQueue {
@@ -31,6 +39,7 @@ public:
    */
   LruQueue(const std::vector<T>& elements) : size_(elements.size()) {
     assert(elements.size() >= 1);
+    assert(elements.size() <= static_cast<size_t>(INT32_MAX));
 
     // operations will benefit from cache locality if we allocate a block of
     // memory up front rather than allocating one node of the linked list
@@ -43,8 +52,8 @@ public:
       // know which one to indicate as most-recently used.
       assert(elem_to_entry_.Get(elements[i]) == nullptr);
       PlaceNewLruEntry(mem_ + i, elements[i]);
-      AppendLruEntry(mem_ + i);
-      elem_to_entry_.Put(mem_[i].e_, (mem_ + i));
+      AppendLruEntry(i);
+      elem_to_entry_.Put(mem_[i].e_, i);
     }
   }
 
@@ -76,7 +85,7 @@ public:
    * @return The least-recently used element.
    */
   const T& GetLru() const {
-    return lru_->e_;
+    return mem_[lru_].e_;
   }
 
   /**
@@ -86,7 +95,7 @@ public:
    */
   void MarkUsed(const T& elem) {
     assert(elem_to_entry_.Get(elem) != nullptr);
-    LruEntry* entry_to_mark_used = *elem_to_entry_.Get(elem);
+    int32_t entry_to_mark_used = *elem_to_entry_.Get(elem);
     if (entry_to_mark_used != mru_) {
       RemoveLruEntry(entry_to_mark_used);
       AppendLruEntry(entry_to_mark_used);
@@ -96,12 +105,17 @@ public:
 private:
 
   /**
-   * An entry in the linked list of elements.
+   * Marks the end of the linked list.
+   */
+  static constexpr int32_t kNoEntry = -1;
+
+  /**
+   * An entry in the linked list of elements. Links are indices into mem_.
    */
   struct LruEntry {
     T e_;
-    LruEntry* next_ = nullptr;
-    LruEntry* prev_ = nullptr;
+    int32_t next_ = kNoEntry;
+    int32_t prev_ = kNoEntry;
 
     LruEntry() {}
     LruEntry(const T& e) : e_(e) {}
@@ -114,8 +128,8 @@ private:
     if (mem_ != nullptr) {
       delete[] mem_;
     }
-    lru_ = nullptr;
-    mru_ = nullptr;
+    lru_ = kNoEntry;
+    mru_ = kNoEntry;
     mem_ = nullptr;
   }
 
@@ -129,8 +143,8 @@ private:
     mem_ = other.mem_;
     size_ = other.size_;
     elem_to_entry_ = std::move(other.elem_to_entry_);
-    other.lru_ = nullptr;
-    other.mru_ = nullptr;
+    other.lru_ = kNoEntry;
+    other.mru_ = kNoEntry;
     other.mem_ = nullptr;
     other.size_ = 0;
   }
@@ -145,17 +159,13 @@ private:
   void CopyFrom(const LruQueue<T>& other) {
     size_ = other.size_;
     mem_ = new LruEntry[size_];
+    // links are indices, so they're the same in the copy
     std::copy(other.mem_, other.mem_ + other.size_, mem_);
     for (int i = 0; i < size_; ++i) {
-      elem_to_entry_.Put(mem_[i].e_, (mem_ + i));
-    }
-
-    LruEntry* curr_entry = other.lru_;
-    while (curr_entry != nullptr) {
-      LruEntry* next_entry = curr_entry->next_;
-      AppendLruEntry(*elem_to_entry_.Get(curr_entry->e_));
-      curr_entry = next_entry;
+      elem_to_entry_.Put(mem_[i].e_, i);
     }
+    lru_ = other.lru_;
+    mru_ = other.mru_;
   }
 
   /**
@@ -172,14 +182,14 @@ private:
    * Adds the given entry to the end of the LruQueue's linked list. The entry
    * is then the most-recently used element.
    */
-  void AppendLruEntry(LruEntry* entry) {
+  void AppendLruEntry(int32_t entry) {
 
     // if list is non-empty
-    if (lru_ != nullptr) {
+    if (lru_ != kNoEntry) {
 
       // append new entry to the end
-      mru_->next_ = entry;
-      entry->prev_ = mru_;
+      mem_[mru_].next_ = entry;
+      mem_[entry].prev_ = mru_;
       mru_ = entry;
 
     // if list is empty
@@ -194,23 +204,23 @@ private:
    *
    * @param entry The LruEntry to remove from the linked list
    */
-  void RemoveLruEntry(LruEntry* entry) {
+  void RemoveLruEntry(int32_t entry) {
 
     // optimize for removing the LRU because that's the point of using an
     // LRU queue.
     if (LIKELY(entry == lru_)) {
-      lru_ = entry->next_;
-      lru_->prev_ = nullptr;
-      entry->next_ = nullptr;
+      lru_ = mem_[entry].next_;
+      mem_[lru_].prev_ = kNoEntry;
+      mem_[entry].next_ = kNoEntry;
     } else {
-      LruEntry* prev_entry = entry->prev_;
-      LruEntry* next_entry = entry->next_;
-      prev_entry->next_ = next_entry;
-      if (next_entry != nullptr) {
-        next_entry->prev_ = prev_entry;
+      int32_t prev_entry = mem_[entry].prev_;
+      int32_t next_entry = mem_[entry].next_;
+      mem_[prev_entry].next_ = next_entry;
+      if (next_entry != kNoEntry) {
+        mem_[next_entry].prev_ = prev_entry;
       }
-      entry->next_ = nullptr;
-      entry->prev_ = nullptr;
+      mem_[entry].next_ = kNoEntry;
+      mem_[entry].prev_ = kNoEntry;
       if (entry == mru_) {
         mru_ = prev_entry;
       }
@@ -222,12 +232,12 @@ private:
   /**
    * The head of the linked list - the least recently used element.
    */
-  LruEntry* lru_ = nullptr;
+  int32_t lru_ = kNoEntry;
 
   /**
    * The tail of the linked list - the most recently used element.
    */
-  LruEntry* mru_ = nullptr;
+  int32_t mru_ = kNoEntry;
 
   /**
    * Memory allocated for the linked list.
@@ -237,11 +247,11 @@ private:
   int size_ = 0;
 
   /**
-   * Hashes elements to their LruEntry.
+   * Hashes elements to the index of their LruEntry.
    *
    * Use custom linear-probing hashmap instead because it's faster.
    */
-  dsalgo::Hashmap<T, LruEntry*> elem_to_entry_;
+  dsalgo::Hashmap<T, int32_t> elem_to_entry_;
 
 };
 
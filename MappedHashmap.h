@@ -0,0 +1,617 @@
+#pragma once
+
+#include "Hashmap.h"
+#include "StringRef.h"
+#include "Utils.h"
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+namespace dsalgo {
+
+/**
+ * Header at the beginning of every MappedHashmap and MappedStringHashmap file.
+ * Records the layout the file was written with, so that a file can't be
+ * queried with the wrong key or value types.
+ */
+struct MappedHashmapHeader {
+  char magic[8];
+
+  // sizeof() the key, value and table slot types
+  uint32_t key_size;
+  uint32_t val_size;
+  uint32_t slot_size;
+
+  // number of slots in the table, a power of 2
+  int32_t table_size;
+
+  // number of entries in the table
+  int32_t size;
+
+  int32_t padding;
+
+  // byte offset of the table from the beginning of the file
+  uint64_t table_offset;
+
+  // byte offset and length of the character data that string keys point into.
+  // Both are 0 if the keys aren't strings.
+  uint64_t strings_offset;
+  uint64_t strings_size;
+};
+
+
+/**
+ * Read-only mapping of a whole file into memory.
+ */
+class MappedFile {
+
+public:
+
+  /**
+   * Maps the given file read-only.
+   *
+   * @throws runtime_error if the file cannot be opened or mapped
+   */
+  MappedFile(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Could not open " + filename + " for reading.");
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+      close(fd);
+      throw std::runtime_error("Could not read the size of " + filename);
+    }
+    size_ = file_stat.st_size;
+
+    void* mem = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+
+    // the mapping keeps the file open
+    close(fd);
+    if (mem == MAP_FAILED) {
+      throw std::runtime_error("Could not mmap " + filename);
+    }
+    data_ = static_cast<const char*>(mem);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Hints that the mapping will be accessed in a random order, so the kernel
+   * only faults in the pages that lookups actually touch instead of reading
+   * ahead.
+   */
+  void AdviseRandom() const {
+    madvise(const_cast<char*>(data_), size_, MADV_RANDOM);
+  }
+
+  const char* Data() const {
+    return data_;
+  }
+
+  size_t Size() const {
+    return size_;
+  }
+
+private:
+
+  const char* data_ = nullptr;
+
+  size_t size_ = 0;
+};
+
+
+/**
+ * Writable mapping of a new file. The file is written under a temporary name
+ * and only renamed to its final name by Commit(), so readers never map a
+ * partially written file.
+ */
+class MappedFileWriter {
+
+public:
+
+  /**
+   * Creates a file of the given size and maps it for writing. The file
+   * starts out zero-filled.
+   *
+   * @throws runtime_error if the file cannot be created or mapped
+   */
+  MappedFileWriter(const std::string& filename, size_t size)
+      : filename_(filename), tmp_filename_(filename + ".tmp"), size_(size) {
+    int fd = open(tmp_filename_.c_str(), O_CREAT|O_RDWR|O_TRUNC, 00666);
+    if (fd < 0) {
+      throw std::runtime_error("Could not open " + tmp_filename_ +
+          " for writing.");
+    }
+
+    if (ftruncate(fd, size_) != 0) {
+      close(fd);
+      unlink(tmp_filename_.c_str());
+      throw std::runtime_error("Could not truncate file " + tmp_filename_ +
+          " to length " + std::to_string(size_));
+    }
+
+    void* mem = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+      unlink(tmp_filename_.c_str());
+      throw std::runtime_error("Could not mmap " + tmp_filename_);
+    }
+    data_ = static_cast<char*>(mem);
+  }
+
+  /**
+   * Discards the file if it was never committed.
+   */
+  ~MappedFileWriter() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+      unlink(tmp_filename_.c_str());
+    }
+  }
+
+  MappedFileWriter(const MappedFileWriter&) = delete;
+  MappedFileWriter& operator=(const MappedFileWriter&) = delete;
+
+  /**
+   * Flushes the file to disk and moves it to its final name, replacing any
+   * file that was there.
+   *
+   * @throws runtime_error if the file could not be flushed or renamed
+   */
+  void Commit() {
+    bool synced = (msync(data_, size_, MS_SYNC) == 0);
+    munmap(data_, size_);
+    data_ = nullptr;
+    if (!synced || rename(tmp_filename_.c_str(), filename_.c_str()) != 0) {
+      unlink(tmp_filename_.c_str());
+      throw std::runtime_error("Could not write " + filename_);
+    }
+  }
+
+  char* Data() {
+    return data_;
+  }
+
+private:
+
+  std::string filename_;
+
+  std::string tmp_filename_;
+
+  char* data_ = nullptr;
+
+  size_t size_ = 0;
+};
+
+
+/**
+ * @return the smallest power-of-2 table size that fits num_entries under
+ * the given load factor, with at least one empty slot.
+ * @throws length_error if that is more than the 2^30 slots the file format
+ * supports
+ */
+static inline int MappedTableSizeFor(int64_t num_entries, float load_factor) {
+  int64_t table_size = 8;
+  while (num_entries >= table_size * load_factor ||
+      num_entries >= table_size) {
+    table_size *= 2;
+  }
+  if (table_size > (1 << 30)) {
+    throw std::length_error("Too many entries for a mapped hashmap.");
+  }
+  return static_cast<int>(table_size);
+}
+
+/**
+ * @return number of bytes reserved for the header at the beginning of the
+ * file. Rounded up to a cache line so the table is cache-line aligned.
+ */
+static inline uint64_t MappedHeaderBytes() {
+  return (sizeof(MappedHashmapHeader) + 63) & ~63ULL;
+}
+
+/**
+ * Fills in a file header.
+ */
+static inline void InitMappedHeader(MappedHashmapHeader* hdr,
+    const char* magic, uint32_t key_size, uint32_t val_size,
+    uint32_t slot_size, int table_size, int size, uint64_t table_offset) {
+  std::memcpy(hdr->magic, magic, sizeof(hdr->magic));
+  hdr->key_size = key_size;
+  hdr->val_size = val_size;
+  hdr->slot_size = slot_size;
+  hdr->table_size = table_size;
+  hdr->size = size;
+  hdr->table_offset = table_offset;
+  hdr->strings_offset = 0;
+  hdr->strings_size = 0;
+}
+
+/**
+ * Checks that a mapped file was written with the given layout.
+ *
+ * @return the file's header
+ * @throws runtime_error if the file doesn't match the layout
+ */
+static inline const MappedHashmapHeader* ValidateMappedHeader(
+    const MappedFile& file, const std::string& filename, const char* magic,
+    uint32_t key_size, uint32_t val_size, uint32_t slot_size) {
+  if (file.Size() < sizeof(MappedHashmapHeader)) {
+    throw std::runtime_error(filename + " is too small to be a hashmap.");
+  }
+  const MappedHashmapHeader* hdr =
+    reinterpret_cast<const MappedHashmapHeader*>(file.Data());
+  if (std::memcmp(hdr->magic, magic, sizeof(hdr->magic)) != 0) {
+    throw std::runtime_error(filename + " is not a hashmap of this kind.");
+  }
+  if (hdr->key_size != key_size || hdr->val_size != val_size ||
+      hdr->slot_size != slot_size) {
+    throw std::runtime_error(filename +
+        " was written with different key or value types.");
+  }
+  if (!IsPowerOf2(hdr->table_size) || hdr->size >= hdr->table_size ||
+      hdr->table_offset + static_cast<uint64_t>(hdr->table_size) *
+      slot_size > file.Size() ||
+      hdr->strings_offset + hdr->strings_size > file.Size()) {
+    throw std::runtime_error(filename + " is truncated or corrupt.");
+  }
+  return hdr;
+}
+
+
+/**
+ * Hashmap that is queried in place from a file written by Write(), without
+ * reading the file into memory or rebuilding anything.
+ *
+ * The file holds a flat linear-probing table, laid out the same way as
+ * Hashmap's: power-of-2 size, 31-bit hashcodes, -1 marking empty slots. The
+ * file is mmap'ed read-only, so opening it is constant time and every lookup
+ * only faults in the pages it probes. Several processes that map the same
+ * file share one copy of it in the page cache.
+ *
+ * Opening only checks the header, not every slot. A corrupt table can make
+ * lookups return wrong results, but they never read outside the file or
+ * probe more than the whole table.
+ *
+ * Key and Val are copied into the file byte for byte, so they must be
+ * trivially copyable (no pointers to the heap). Use MappedStringHashmap for
+ * string keys.
+ *
+ * The hashcodes are stored in the file, so Hash must give the same hash for
+ * the same key in every process that reads the file (std::hash does for
+ * integers).
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class MappedHashmap {
+
+  static_assert(std::is_trivially_copyable<Key>::value,
+      "MappedHashmap keys must be trivially copyable");
+  static_assert(std::is_trivially_copyable<Val>::value,
+      "MappedHashmap values must be trivially copyable");
+
+public:
+
+  /**
+   * Maps a file written by Write().
+   *
+   * @param filename file to map
+   * @throws runtime_error if the file could not be mapped or was not written
+   * by a MappedHashmap with the same key and value types
+   */
+  MappedHashmap(const std::string& filename)
+      : file_(filename) {
+    const MappedHashmapHeader* hdr =
+      ValidateMappedHeader(file_, filename, Magic(), sizeof(Key), sizeof(Val),
+          sizeof(Slot));
+    table_ = reinterpret_cast<const Slot*>(file_.Data() + hdr->table_offset);
+    table_size_ = hdr->table_size;
+    size_ = hdr->size;
+    file_.AdviseRandom();
+  }
+
+  /**
+   * Writes the given hashmap to a file that MappedHashmap can map.
+   *
+   * @param filename file to write. Overwritten if it exists.
+   * @param map hashmap to write
+   * @param load_factor load factor of the table in the file
+   * @throws runtime_error if the file could not be written
+   */
+  template<class H, class E, class I>
+  static void Write(const std::string& filename,
+      const Hashmap<Key, Val, H, E, I>& map, float load_factor=0.7) {
+    int table_size = MappedTableSizeFor(map.Size(), load_factor);
+    uint64_t table_offset = MappedHeaderBytes();
+    MappedFileWriter writer(filename, table_offset +
+        static_cast<uint64_t>(table_size) * sizeof(Slot));
+
+    MappedHashmapHeader* hdr =
+      reinterpret_cast<MappedHashmapHeader*>(writer.Data());
+    InitMappedHeader(hdr, Magic(), sizeof(Key), sizeof(Val), sizeof(Slot),
+        table_size, map.Size(), table_offset);
+
+    Slot* table = reinterpret_cast<Slot*>(writer.Data() + table_offset);
+    for (int i = 0; i < table_size; ++i) {
+      table[i].hashcode = -1;
+    }
+
+    Hash hash_fn;
+    map.ForEach([&](const Key& k, const Val& v) {
+      int hashcode = hash_fn(k) & 0x7FFFFFFF;
+      int idx = hashcode & (table_size - 1);
+      while (table[idx].hashcode != -1) {
+        idx = (idx + 1) & (table_size - 1);
+      }
+      std::memcpy(&table[idx].k, &k, sizeof(Key));
+      std::memcpy(&table[idx].v, &v, sizeof(Val));
+      table[idx].hashcode = hashcode;
+    });
+    writer.Commit();
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  const Val* Get(const Key& k) const {
+    int hashcode = hash_fn_(k) & 0x7FFFFFFF;
+    int idx = hashcode & (table_size_ - 1);
+
+    // Write() never fills the table, so there is always an empty slot to
+    // stop at, unless the file is corrupt
+    for (int i = 0; i < table_size_ && table_[idx].hashcode != -1; ++i) {
+      if (table_[idx].hashcode == hashcode && eq_fn_(k, table_[idx].k)) {
+        return &table_[idx].v;
+      }
+      idx = (idx + 1) & (table_size_ - 1);
+    }
+    return nullptr;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+private:
+
+  /**
+   * Slot of the table in the file. Same layout as Hashmap's entries.
+   */
+  struct Slot {
+    Key k;
+    Val v;
+
+    // if hashcode is -1, that means the slot is empty.
+    int32_t hashcode;
+  };
+
+  /**
+   * @return identifies MappedHashmap files
+   */
+  static const char* Magic() {
+    return "DSMAP01";
+  }
+
+  MappedFile file_;
+
+  // table inside file_
+  const Slot* table_ = nullptr;
+
+  // number of slots in the table, a power of 2.
+  int table_size_ = 0;
+
+  // number of entries in the table.
+  int size_ = 0;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+
+/**
+ * Same as MappedHashmap, but for std::string keys. The keys' characters are
+ * stored after the table, and each slot refers to its key by offset, so the
+ * file can be mapped at any address.
+ *
+ * Lookups take a StringRef, so keys can be looked up straight out of a
+ * buffer. The default hash (StrHash) is stable across processes.
+ *
+ * Val = type that gets mapped to in the hashmap. Must be trivially copyable.
+ * Hash = hash function for the key. Must accept a StringRef.
+ * Eq = equality function for the key. Must accept StringRefs.
+ */
+template<
+  class Val,
+  class Hash=StrHash,
+  class Eq=StrEq
+  >
+class MappedStringHashmap {
+
+  static_assert(std::is_trivially_copyable<Val>::value,
+      "MappedStringHashmap values must be trivially copyable");
+
+public:
+
+  /**
+   * Maps a file written by Write().
+   *
+   * @param filename file to map
+   * @throws runtime_error if the file could not be mapped or was not written
+   * by a MappedStringHashmap with the same value type
+   */
+  MappedStringHashmap(const std::string& filename)
+      : file_(filename) {
+    const MappedHashmapHeader* hdr =
+      ValidateMappedHeader(file_, filename, Magic(), 0, sizeof(Val),
+          sizeof(Slot));
+    table_ = reinterpret_cast<const Slot*>(file_.Data() + hdr->table_offset);
+    table_size_ = hdr->table_size;
+    size_ = hdr->size;
+    strings_ = file_.Data() + hdr->strings_offset;
+    strings_size_ = hdr->strings_size;
+    file_.AdviseRandom();
+  }
+
+  /**
+   * Writes the given hashmap to a file that MappedStringHashmap can map.
+   *
+   * @param filename file to write. Overwritten if it exists.
+   * @param map hashmap to write
+   * @param load_factor load factor of the table in the file
+   * @throws runtime_error if the file could not be written
+   */
+  template<class H, class E, class I>
+  static void Write(const std::string& filename,
+      const Hashmap<std::string, Val, H, E, I>& map, float load_factor=0.7) {
+    uint64_t strings_size = 0;
+    map.ForEach([&](const std::string& k, const Val&) {
+      strings_size += k.size();
+    });
+
+    int table_size = MappedTableSizeFor(map.Size(), load_factor);
+    uint64_t table_offset = MappedHeaderBytes();
+    uint64_t strings_offset = table_offset +
+      static_cast<uint64_t>(table_size) * sizeof(Slot);
+    MappedFileWriter writer(filename, strings_offset + strings_size);
+
+    MappedHashmapHeader* hdr =
+      reinterpret_cast<MappedHashmapHeader*>(writer.Data());
+    InitMappedHeader(hdr, Magic(), 0, sizeof(Val), sizeof(Slot), table_size,
+        map.Size(), table_offset);
+    hdr->strings_offset = strings_offset;
+    hdr->strings_size = strings_size;
+
+    Slot* table = reinterpret_cast<Slot*>(writer.Data() + table_offset);
+    for (int i = 0; i < table_size; ++i) {
+      table[i].hashcode = -1;
+    }
+
+    char* strings = writer.Data() + strings_offset;
+    uint64_t next_string = 0;
+    Hash hash_fn;
+    map.ForEach([&](const std::string& k, const Val& v) {
+      int hashcode = hash_fn(StringRef(k)) & 0x7FFFFFFF;
+      int idx = hashcode & (table_size - 1);
+      while (table[idx].hashcode != -1) {
+        idx = (idx + 1) & (table_size - 1);
+      }
+      std::memcpy(strings + next_string, k.data(), k.size());
+      table[idx].key_offset = next_string;
+      table[idx].key_size = k.size();
+      table[idx].hashcode = hashcode;
+      std::memcpy(&table[idx].v, &v, sizeof(Val));
+      next_string += k.size();
+    });
+    writer.Commit();
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  const Val* Get(const StringRef& k) const {
+    int hashcode = hash_fn_(k) & 0x7FFFFFFF;
+    int idx = hashcode & (table_size_ - 1);
+    for (int i = 0; i < table_size_ && table_[idx].hashcode != -1; ++i) {
+      const Slot& slot = table_[idx];
+
+      // the key's characters are only trusted if they're inside the file's
+      // string data, so a corrupt slot can't send the comparison elsewhere
+      if (slot.hashcode == hashcode && slot.key_size == k.size &&
+          slot.key_size <= strings_size_ &&
+          slot.key_offset <= strings_size_ - slot.key_size &&
+          eq_fn_(k, StringRef(strings_ + slot.key_offset, slot.key_size))) {
+        return &slot.v;
+      }
+      idx = (idx + 1) & (table_size_ - 1);
+    }
+    return nullptr;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+private:
+
+  /**
+   * Slot of the table in the file. The key is stored as the offset of its
+   * characters from the beginning of the string data.
+   */
+  struct Slot {
+    uint64_t key_offset;
+    uint32_t key_size;
+
+    // if hashcode is -1, that means the slot is empty.
+    int32_t hashcode;
+
+    Val v;
+  };
+
+  /**
+   * @return identifies MappedStringHashmap files
+   */
+  static const char* Magic() {
+    return "DSSMAP1";
+  }
+
+  MappedFile file_;
+
+  // table inside file_
+  const Slot* table_ = nullptr;
+
+  // number of slots in the table, a power of 2.
+  int table_size_ = 0;
+
+  // number of entries in the table.
+  int size_ = 0;
+
+  // characters of all the keys, inside file_
+  const char* strings_ = nullptr;
+
+  // number of bytes at strings_
+  uint64_t strings_size_ = 0;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+} // namespace dsalgo
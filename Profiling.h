@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace dsalgo {
 
@@ -23,6 +25,16 @@ public:
 };
 
 
+/**
+ * Prevents the compiler from optimizing away a computation whose result is
+ * otherwise unused (e.g. a lookup whose result is ignored in a profiling loop).
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+
 /**
  * Given that a program made num_calls and took total_time, computes the time
  * per call (total_time / num_calls).
@@ -48,5 +60,25 @@ void PrintStats(int64_t total_time_ns, int num_calls,
     << ComputeTimePerCall(total_time_ns, num_calls) << std::endl;
 }
 
+
+/**
+ * Prints the median, tail percentiles and maximum of a list of per-call
+ * latencies.
+ *
+ * @param latencies_ns Time taken by each call. Gets sorted in place.
+ * @param prefix String to print in front of each line of stats.
+ */
+void PrintLatencyPercentiles(std::vector<int64_t>& latencies_ns,
+    std::string output_prefix="") {
+  std::sort(latencies_ns.begin(), latencies_ns.end());
+  int64_t n = latencies_ns.size();
+  std::cout << output_prefix << "p50 ns: " << latencies_ns[n / 2] << std::endl;
+  std::cout << output_prefix << "p99 ns: " << latencies_ns[n * 99 / 100]
+    << std::endl;
+  std::cout << output_prefix << "p999 ns: " << latencies_ns[n * 999 / 1000]
+    << std::endl;
+  std::cout << output_prefix << "max ns: " << latencies_ns[n - 1] << std::endl;
+}
+
 } // namespace dsalgo
 
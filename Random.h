@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
@@ -77,5 +78,49 @@ std::vector<std::string> RandStrs(int min_len, int max_len, int n) {
   return rand_strs;
 }
 
+
+/**
+ * Draws random integers in [0, n) from a Zipfian distribution: i is drawn
+ * with probability proportional to 1 / (i + 1)^s, so 0 is the most popular
+ * value. Useful for skewed access patterns where a few keys are hot.
+ *
+ * Precomputes the cumulative distribution, which takes O(n) memory, and
+ * draws by binary searching it.
+ */
+class ZipfGenerator {
+
+public:
+
+  /**
+   * @param n number of distinct values
+   * @param s skew. 0 is uniform, and the larger s, the more popular the
+   * most popular values.
+   */
+  ZipfGenerator(int n, double s) : cdf_(n) {
+    double sum = 0;
+    for (int i = 0; i < n; ++i) {
+      sum += 1.0 / std::pow(i + 1, s);
+      cdf_[i] = sum;
+    }
+    for (int i = 0; i < n; ++i) {
+      cdf_[i] /= sum;
+    }
+  }
+
+  /**
+   * @return next random value in [0, n)
+   */
+  int Next() const {
+    double u = rand() / (RAND_MAX + 1.0);
+    int i = std::upper_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+    return std::min(i, static_cast<int>(cdf_.size()) - 1);
+  }
+
+private:
+
+  // cdf_[i] = probability of drawing a value <= i
+  std::vector<double> cdf_;
+};
+
 } // namespace dsalgo
 
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <utility>
+
+
+namespace dsalgo {
+
+/**
+ * Hashmap with Robin Hood linear probing.
+ *
+ * Every entry remembers how far it is from the index its hash maps to (its
+ * probe distance). On insertion, an entry that is closer to its home index
+ * ("richer") than the entry being inserted gets evicted and continues probing
+ * in its place. This keeps probe distances within a table tightly bunched, so
+ * high load factors (0.9 by default) don't create long chains for unlucky keys.
+ *
+ * It also bounds unsuccessful lookups: the table is ordered such that if we
+ * have probed further than the entry sitting in the current slot, the key
+ * would have evicted that entry had it been inserted, so it is not in the
+ * table.
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class RobinHoodHashmap {
+
+public:
+
+  /**
+   * Creates a hashmap with the specified initial maximum capacity and load
+   * factor.
+   *
+   * @param init_capacity initial maximum capacity of the hashmap if the load
+   * factor were 1. Rounded up to the next power of 2.
+   * @param load_factor how soon to resize the hashmap. When the hashmap
+   * contains capacity * load_factor entries, it will double in size.
+   */
+  RobinHoodHashmap(int init_capacity, float load_factor=0.9)
+      : load_factor_(load_factor) {
+
+    if (init_capacity < 8) {
+      init_capacity = 8;
+    }
+
+    table_size_ = IsPowerOf2(init_capacity) ?
+      init_capacity :
+      NextPowerOf2(init_capacity);
+
+    table_ = new Entry[table_size_];
+  }
+
+  RobinHoodHashmap() : RobinHoodHashmap(8) {}
+
+  ~RobinHoodHashmap() {
+    FreeMem();
+  }
+
+  RobinHoodHashmap(const RobinHoodHashmap<Key, Val, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  RobinHoodHashmap(RobinHoodHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  RobinHoodHashmap<Key, Val, Hash, Eq>& operator=(
+      const RobinHoodHashmap<Key, Val, Hash, Eq>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  RobinHoodHashmap<Key, Val, Hash, Eq>& operator=(
+      RobinHoodHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Maps the given key to the given value, overwriting any previous mapping.
+   *
+   * Inserting may move other entries, so all references and pointers to
+   * values in the hashmap are invalidated by Put().
+   *
+   * @param k key to insert
+   * @param v value to which to map the key
+   */
+  void Put(const Key& k, const Val& v) {
+    int hashcode = HashCode(k);
+    int idx = LocateEntryIdx(k, hashcode);
+    if (idx != -1) {
+      table_[idx].v = v;
+      return;
+    }
+
+    if (size_ >= load_factor_ * table_size_) {
+      Resize();
+    }
+
+    Entry to_insert;
+    to_insert.k = k;
+    to_insert.v = v;
+    to_insert.hashcode = hashcode;
+    InsertNewEntry(std::move(to_insert));
+    ++size_;
+  }
+
+  /**
+   * Gets the value to which the given key is mapped, inserting a default
+   * constructed value if the key is not in the hashmap.
+   */
+  Val& operator[](const Key& k) {
+    Val* v = Get(k);
+    if (v != nullptr) {
+      return *v;
+    }
+    Put(k, Val());
+    return *Get(k);
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  Val* Get(const Key& k) const {
+    int idx = LocateEntryIdx(k, HashCode(k));
+    return (idx != -1) ? &table_[idx].v : nullptr;
+  }
+
+  /**
+   * Removes the given key from the hashmap if present. Otherwise, does nothing.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(const Key& k) {
+    int remove_idx = LocateEntryIdx(k, HashCode(k));
+    if (remove_idx == -1) {
+      return false;
+    }
+
+    // shift every following entry in the cluster back by one slot until we
+    // reach an empty slot or an entry that is already at its home index.
+    // Unlike plain linear probing, the probe distances tell us exactly which
+    // entries can move, so no wraparound cases have to be considered.
+    int unoccupied_idx = remove_idx;
+    int next_idx = (unoccupied_idx + 1) & (table_size_ - 1);
+    while (table_[next_idx].dist > 0 && next_idx != remove_idx) {
+      table_[unoccupied_idx] = std::move(table_[next_idx]);
+      --table_[unoccupied_idx].dist;
+      unoccupied_idx = next_idx;
+      next_idx = (next_idx + 1) & (table_size_ - 1);
+    }
+    table_[unoccupied_idx].Invalidate();
+    --size_;
+    return true;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Removes all elements from this hashmap.
+   */
+  void Clear() {
+    for (int i = 0; i < table_size_; ++i) {
+      table_[i].Invalidate();
+    }
+    size_ = 0;
+  }
+
+private:
+
+  /**
+   * Represents an entry in the hashmap.
+   */
+  struct Entry {
+    Key k;
+    Val v;
+    int hashcode = 0;
+
+    // distance from the index that hashcode maps to. If dist is -1, that means
+    // the entry is not valid.
+    int dist = -1;
+
+    inline bool IsValid() const {
+      return dist != -1;
+    }
+
+    inline void Invalidate() {
+      dist = -1;
+    }
+  };
+
+  /**
+   * Frees any memory that has been allocated for this hashtable.
+   */
+  void FreeMem() {
+    if (table_ != nullptr) {
+      delete[] table_;
+    }
+  }
+
+  /**
+   * Copies another hashtable into this hashtable. Does not free any currently
+   * allocated memory though.
+   */
+  void CopyFrom(const RobinHoodHashmap<Key, Val, Hash, Eq>& other) {
+    table_ = new Entry[other.table_size_];
+    std::copy(other.table_, other.table_ + other.table_size_, table_);
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = other.hash_fn_;
+    eq_fn_ = other.eq_fn_;
+  }
+
+  /**
+   * Moves another hashtable into this hashtable. The other hashtable is
+   * emptied and invalidated.
+   */
+  void MoveFrom(RobinHoodHashmap<Key, Val, Hash, Eq>& other) {
+    table_ = other.table_;
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = std::move(other.hash_fn_);
+    eq_fn_ = std::move(other.eq_fn_);
+
+    other.table_ = nullptr;
+  }
+
+  /**
+   * @return hash code for the given key
+   */
+  inline int HashCode(const Key& k) const {
+    return hash_fn_(k) & 0x7FFFFFFF;
+  }
+
+  /**
+   * @return the index in the underlying table at which the hashcode belongs
+   * if there were no collisions.
+   */
+  inline int IndexFor(int hashcode) const {
+    return hashcode & (table_size_ - 1);
+  }
+
+  /**
+   * @return index in the underlying table at which the key is located, or -1
+   * if the key is not in the hashmap.
+   */
+  int LocateEntryIdx(const Key& k, int hashcode) const {
+    int idx = IndexFor(hashcode);
+    for (int dist = 0; ; ++dist) {
+      const Entry& entry = table_[idx];
+
+      // If the entry in this slot is closer to home than we are, the key would
+      // have taken this slot when it was inserted. Empty slots have a distance
+      // of -1, so this also stops at them.
+      if (entry.dist < dist) {
+        return -1;
+      }
+      if (entry.hashcode == hashcode && eq_fn_(k, entry.k)) {
+        return idx;
+      }
+      idx = (idx + 1) & (table_size_ - 1);
+    }
+  }
+
+  /**
+   * Inserts an entry whose key is known not to be in the table, evicting
+   * richer entries along the way. Does not update size_.
+   */
+  void InsertNewEntry(Entry&& to_insert) {
+    to_insert.dist = 0;
+    int idx = IndexFor(to_insert.hashcode);
+    while (true) {
+      Entry& entry = table_[idx];
+      if (!entry.IsValid()) {
+        entry = std::move(to_insert);
+        return;
+      }
+
+      // take from the rich and give to the poor: the entry being inserted
+      // takes the slot and the displaced entry continues probing.
+      if (entry.dist < to_insert.dist) {
+        std::swap(entry, to_insert);
+      }
+      ++to_insert.dist;
+      idx = (idx + 1) & (table_size_ - 1);
+    }
+  }
+
+  void Resize() {
+
+    // back up old table data
+    Entry* old_table = table_;
+    int old_table_size = table_size_;
+
+    // create new table
+    while (size_ >= table_size_ * load_factor_) {
+      table_size_ *= 2;
+    }
+    table_ = new Entry[table_size_];
+
+    // re-insert all the valid elements in the old table
+    for (int i = 0; i < old_table_size; ++i) {
+      if (old_table[i].IsValid()) {
+        InsertNewEntry(std::move(old_table[i]));
+      }
+    }
+
+    // free old table memory
+    delete[] old_table;
+  }
+
+private:
+
+  // underlying table for the hashmap
+  Entry* table_ = nullptr;
+
+  // size of the underlying table, must be a power of 2.
+  int table_size_ = 0;
+
+  // number of entries in the hashmap.
+  int size_ = 0;
+
+  // hashmap will resize when number of entires exceeds
+  // table_size_ * load_factor_
+  float load_factor_ = 0;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+} // namespace dsalgo
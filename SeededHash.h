@@ -0,0 +1,191 @@
+#pragma once
+
+#include "StringRef.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <stdint.h>
+#include <type_traits>
+
+
+namespace dsalgo {
+
+namespace wyhash {
+
+// wyhash's default secret
+static const uint64_t kSecret[4] = {
+  0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+  0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+/**
+ * Multiplies a and b into a 128-bit product, leaving its low half in a and
+ * its high half in b.
+ */
+static inline void Mum(uint64_t* a, uint64_t* b) {
+  unsigned __int128 product = static_cast<unsigned __int128>(*a) * *b;
+  *a = static_cast<uint64_t>(product);
+  *b = static_cast<uint64_t>(product >> 64);
+}
+
+/**
+ * @return xor of the two halves of a * b
+ */
+static inline uint64_t Mix(uint64_t a, uint64_t b) {
+  Mum(&a, &b);
+  return a ^ b;
+}
+
+static inline uint64_t Read8(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+static inline uint64_t Read4(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+/**
+ * Reads 1 to 3 bytes.
+ */
+static inline uint64_t Read3(const uint8_t* p, size_t len) {
+  return (static_cast<uint64_t>(p[0]) << 16) |
+    (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+}
+
+} // namespace wyhash
+
+
+/**
+ * Seeded hash of a run of bytes. Same algorithm as wyhash (final version 4):
+ * the bytes are consumed 16 or 48 at a time with 64x64->128 bit multiplies,
+ * so it's fast for short keys and long ones alike, and without the seed,
+ * outputs can't be predicted well enough to make keys collide on purpose.
+ */
+inline uint64_t WyHash(const void* data, size_t len, uint64_t seed) {
+  using namespace wyhash;
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+  uint64_t a = 0;
+  uint64_t b = 0;
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (Read4(p) << 32) | Read4(p + ((len >> 3) << 2));
+      b = (Read4(p + len - 4) << 32) | Read4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = Read3(p, len);
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+        see1 = Mix(Read8(p + 16) ^ kSecret[2], Read8(p + 24) ^ see1);
+        see2 = Mix(Read8(p + 32) ^ kSecret[3], Read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    a = Read8(p + i - 16);
+    b = Read8(p + i - 8);
+  }
+  a ^= kSecret[1];
+  b ^= seed;
+  Mum(&a, &b);
+  return Mix(a ^ kSecret[0] ^ len, b ^ kSecret[1]);
+}
+
+/**
+ * Seeded hash of a 64-bit integer, like wyhash's wyhash64().
+ */
+inline uint64_t WyHash64(uint64_t k, uint64_t seed) {
+  using namespace wyhash;
+  uint64_t a = k ^ kSecret[0];
+  uint64_t b = seed ^ kSecret[1];
+  Mum(&a, &b);
+  return Mix(a ^ kSecret[0], b ^ kSecret[1]);
+}
+
+/**
+ * @return a different unpredictable seed on every call. Mixes a counter into
+ * entropy drawn from std::random_device once per process.
+ */
+inline uint64_t RandomSeed() {
+  static const uint64_t kProcessEntropy = []() {
+    uint64_t entropy = static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+    try {
+      std::random_device device;
+      entropy ^= (static_cast<uint64_t>(device()) << 32) | device();
+    } catch (...) {
+      // no entropy source. The clock will have to do.
+    }
+    return entropy;
+  }();
+  static std::atomic<uint64_t> counter(0);
+  return WyHash64(counter.fetch_add(1, std::memory_order_relaxed),
+      kProcessEntropy);
+}
+
+
+/**
+ * Hash function for hashmaps that may be fed keys chosen by an attacker.
+ *
+ * Every instance draws its own random seed, which is mixed into a WyHash of
+ * the key's bytes (or WyHash64 of an integer key), so keys that collide in
+ * one hashmap don't collide in another, and colliding keys can't be
+ * computed offline. Hashmap also calls Reseed() and rehashes when it sees a
+ * suspiciously long probe, see Hashmap::FindOrInsert().
+ *
+ * Accepts integers and enums, and, transparently, std::string, const char*
+ * and StringRef. Use StrEq as the equality function for heterogeneous string
+ * lookups.
+ */
+class SeededHash {
+
+public:
+
+  using is_transparent = void;
+
+  SeededHash() : seed_(RandomSeed()) {}
+
+  explicit SeededHash(uint64_t seed) : seed_(seed) {}
+
+  template<class T, class=typename std::enable_if<
+    std::is_integral<T>::value || std::is_enum<T>::value>::type>
+  size_t operator()(T k) const {
+    return WyHash64(static_cast<uint64_t>(k), seed_);
+  }
+
+  size_t operator()(const StringRef& s) const {
+    return WyHash(s.data, s.size, seed_);
+  }
+
+  /**
+   * Switches to a fresh random seed, which changes every hash.
+   */
+  void Reseed() {
+    seed_ = RandomSeed();
+  }
+
+  uint64_t Seed() const {
+    return seed_;
+  }
+
+private:
+
+  uint64_t seed_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "CacheNodePool.h"
+#include "Hashmap.h"
+#include "Utils.h"
+#include <assert.h>
+#include <functional>
+#include <utility>
+
+
+namespace dsalgo {
+
+/**
+ * Key-value cache with segmented LRU (SLRU) eviction, the simplified 2Q: a
+ * drop-in alternative to LruCache that a scan can't flush.
+ *
+ * Entries are in one of two LRU segments. New keys enter the probationary
+ * segment, and only move to the protected segment when they're hit again.
+ * The protected segment holds at most a fixed share of the capacity, and
+ * overflows back into the probationary one. Victims are always taken from
+ * the probationary segment first, so a burst of keys that are used once,
+ * like a sequential scan, only cycles through the probationary segment and
+ * leaves the keys used repeatedly in the protected one alone.
+ *
+ * Get() and Put() cost the same as LruCache's: one hash probe and a few
+ * index splices in a preallocated array of nodes.
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class SegmentedLruCache {
+
+public:
+
+  /**
+   * @param capacity maximum number of entries. Must be at least 1.
+   * @param protected_ratio share of the capacity the protected segment may
+   * hold. The rest is reserved for new keys.
+   */
+  SegmentedLruCache(int capacity, double protected_ratio=0.8)
+      : capacity_(capacity),
+        protected_capacity_(static_cast<int>(capacity * protected_ratio)),
+        nodes_(capacity) {
+    assert(capacity >= 1);
+    index_.Reserve(capacity + 1);
+  }
+
+  /**
+   * Looks up a key and marks it as used, promoting it to the protected
+   * segment.
+   *
+   * @return the value the key is mapped to, or nullptr if the key isn't in
+   * the cache. Valid until the key is erased or evicted.
+   */
+  Val* Get(const Key& k) {
+    int32_t* found = index_.Get(k);
+    if (found == nullptr) {
+      return nullptr;
+    }
+    Touch(*found);
+    return &nodes_[*found].v;
+  }
+
+  /**
+   * Looks up a key without marking it as used.
+   */
+  const Val* Peek(const Key& k) const {
+    int32_t* found = index_.Get(k);
+    return found == nullptr ? nullptr : &nodes_[*found].v;
+  }
+
+  /**
+   * Maps the key to the value. A new key enters the probationary segment,
+   * evicting the least-recently used probationary entry if the cache is
+   * full. An existing key is marked as used.
+   *
+   * @return true if the key was inserted, false if its value was replaced.
+   */
+  bool Put(const Key& k, const Val& v) {
+    std::pair<int32_t*, bool> found = index_.TryEmplace(k);
+    if (!found.second) {
+      nodes_[*found.first].v = v;
+      Touch(*found.first);
+      return false;
+    }
+
+    int32_t node;
+    if (!nodes_.Full()) {
+      node = nodes_.Alloc();
+      *found.first = node;
+    } else {
+      // the index has room for one more key than the capacity, so inserting
+      // k didn't resize it. Removing the evicted key may shift k's slot, so
+      // k's node has to be stored first.
+      List& segment = (probation_.size > 0) ? probation_ : protected_;
+      node = segment.lru;
+      nodes_.Unlink(segment, node);
+      *found.first = node;
+      index_.Remove(nodes_[node].k);
+    }
+    nodes_[node].k = k;
+    nodes_[node].v = v;
+    nodes_.PushMru(probation_, kProbation, node);
+    return true;
+  }
+
+  /**
+   * Removes a key from the cache.
+   *
+   * @return if the key was in the cache.
+   */
+  bool Erase(const Key& k) {
+    int32_t* found = index_.Get(k);
+    if (found == nullptr) {
+      return false;
+    }
+    int32_t node = *found;
+    index_.Remove(k);
+    nodes_.Unlink(SegmentOf(node), node);
+    nodes_.Free(node);
+    return true;
+  }
+
+  /**
+   * Removes every entry.
+   */
+  void Clear() {
+    nodes_ = Pool(capacity_);
+    probation_ = List();
+    protected_ = List();
+    index_.Clear();
+  }
+
+  int Size() const {
+    return probation_.size + protected_.size;
+  }
+
+  int Capacity() const {
+    return capacity_;
+  }
+
+  /**
+   * @return number of entries in the protected segment
+   */
+  int ProtectedSize() const {
+    return protected_.size;
+  }
+
+private:
+
+  typedef CacheNodePool<Key, Val> Pool;
+  typedef typename Pool::List List;
+
+  // list ids of the segments
+  static constexpr uint8_t kProbation = 0;
+  static constexpr uint8_t kProtected = 1;
+
+  List& SegmentOf(int32_t node) {
+    return nodes_[node].list == kProbation ? probation_ : protected_;
+  }
+
+  /**
+   * Marks an entry as used: moves it to the most-recently used end of the
+   * protected segment, and demotes the protected segment's least-recently
+   * used entry if that makes it overflow.
+   */
+  void Touch(int32_t node) {
+    nodes_.MoveToMru(SegmentOf(node), protected_, kProtected, node);
+    if (protected_.size > protected_capacity_) {
+      int32_t demoted = protected_.lru;
+      nodes_.Unlink(protected_, demoted);
+      nodes_.PushMru(probation_, kProbation, demoted);
+    }
+  }
+
+private:
+
+  int capacity_ = 0;
+
+  int protected_capacity_ = 0;
+
+  Pool nodes_;
+
+  List probation_;
+
+  List protected_;
+
+  /**
+   * Maps each key to its node.
+   */
+  Hashmap<Key, int32_t, FibonacciHash<Hash>, Eq> index_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,540 @@
+#pragma once
+
+#include "Utils.h"
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+#include <assert.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace dsalgo {
+
+/**
+ * A fixed-capacity linear-probing hashmap stored in shared memory that allows
+ * unlimited lock-free readers and a single writer, possibly in different
+ * processes.
+ *
+ * Like ShmQueue, the map lives in a MAP_SHARED file: one process creates it
+ * by calling ShmHashmap(filename, capacity, overwrite) and any other process
+ * attaches to it by calling ShmHashmap(filename). Every process that attaches
+ * shares the same physical pages instead of holding a private copy.
+ *
+ * Every slot has its own sequence counter (a seqlock). The writer makes the
+ * counter odd while it modifies the slot and even again afterwards. Readers
+ * copy a slot and then check that its counter was even and didn't change
+ * while they copied it, retrying the slot otherwise. Get() never takes a lock
+ * and never returns a torn value, and readers never write to shared memory,
+ * so they don't bounce cache lines between each other. A reader that reaches
+ * a slot in the middle of a write spins until the write is done, which is
+ * only a few stores.
+ *
+ * Removed entries leave a tombstone behind instead of shifting later entries
+ * back, because a shift could move an entry past a reader that is in the
+ * middle of probing. Put() reuses tombstones, and Remove() turns tombstones
+ * at the end of a cluster back into empty slots. Tombstones inside a cluster
+ * stay until a Put() reuses them, though, so heavy churn of distinct keys
+ * can still use up the empty slots. Once there are none, every miss and every
+ * Put() of a new key probes the whole table. Give a map whose keys churn
+ * plenty of spare capacity, or recreate it now and then.
+ *
+ * Put() and Remove() are limited to one writer at any moment (concurrent
+ * writers spin on a lock in the header). The table cannot be resized because
+ * the other processes have it mapped.
+ *
+ * Nothing recovers from a writer process that dies in the middle of Put() or
+ * Remove(). The header lock stays held, so every later writer spins forever,
+ * and if the writer died with a slot's counter odd, every reader that probes
+ * that slot spins forever too. The map then has to be recreated with
+ * overwrite.
+ *
+ * Keys and values are copied into shared memory byte for byte, so they must
+ * be trivially copyable. Hash must give the same hash for the same key in
+ * every process (std::hash does for integers).
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class ShmHashmap {
+
+  static_assert(std::is_trivially_copyable<Key>::value,
+      "ShmHashmap keys must be trivially copyable");
+  static_assert(std::is_trivially_copyable<Val>::value,
+      "ShmHashmap values must be trivially copyable");
+
+  // atomics are only safe to share between processes if they are lock-free
+  static_assert(ATOMIC_INT_LOCK_FREE == 2,
+      "ShmHashmap requires lock-free atomic ints");
+
+public:
+
+  /**
+   * Creates a ShmHashmap by mapping to a new shared memory region.
+   *
+   * @param filename file in which shared memory region can be swapped to disk
+   * @param capacity maximum number of entries the hashmap can hold
+   * @param overwrite overwrite the current shared memory file if it exists
+   * @throws runtime_error if we could not create the shared memory file
+   */
+  ShmHashmap(const std::string& filename, int capacity, bool overwrite)
+      : shm_file_(filename) {
+
+    if (capacity <= 0) {
+      throw std::logic_error("Capacity of shared memory should be positive.");
+    }
+
+    // if the file already exists, we should not overwrite it in case another
+    // process is using it.
+    struct stat buffer;
+    if (!overwrite && stat(shm_file_.c_str(), &buffer) == 0) {
+      throw std::runtime_error("Cannot create new file " + shm_file_ +
+          " for swapping out shared memory because it already exists."
+          " Specify overwrite=true to overwrite it.");
+    }
+
+    int fd = open(shm_file_.c_str(), O_CREAT|O_RDWR, 00666);
+    if (fd < 0) {
+      throw std::runtime_error("Could not open " + shm_file_ +
+          " for swapping out shared memory.");
+    }
+
+    // keep the table at most 3/4 full so that probe sequences stay short
+    int table_size = NextPowerOf2(capacity + capacity / 3 + 1);
+    mem_size_ = MemSizeFor(table_size);
+
+    // truncate to 0 first so that an overwritten file starts out zero-filled
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, mem_size_) != 0) {
+      close(fd);
+      throw std::runtime_error("Could not truncate file " + shm_file_ +
+          " to length " + std::to_string(mem_size_));
+    }
+    MapRegion(fd);
+
+    // set the header
+    hdr_->key_size_ = sizeof(Key);
+    hdr_->val_size_ = sizeof(Val);
+    hdr_->capacity_ = capacity;
+    hdr_->table_size_ = table_size;
+    hdr_->size_.store(0);
+    hdr_->write_lock_.clear();
+
+    // every slot starts out empty. Sequence counters start out at 0 from the
+    // zero-filled file.
+    for (int i = 0; i < table_size; ++i) {
+      table_[i].hashcode = kEmpty;
+    }
+
+    // only mark the map as initialized once everything else is visible, so
+    // processes that attach early can tell it isn't ready yet.
+    std::memcpy(hdr_->magic_, kMagic, sizeof(hdr_->magic_));
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr_->initialized_.store(1, std::memory_order_release);
+  }
+
+  /**
+   * Creates a shared memory hashmap from an existing shared memory region.
+   *
+   * @param filename file in which a shared memory region is currently being
+   * swapped out to
+   * @throws runtime_error if we could not load the shared memory file, or it
+   * holds a hashmap with different key or value types
+   */
+  ShmHashmap(const std::string& filename)
+      : shm_file_(filename) {
+
+    int fd = open(shm_file_.c_str(), O_RDWR, 00666);
+    if (fd < 0) {
+      throw std::runtime_error("Could not open " + shm_file_ +
+          " to load the shared memory region.");
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 ||
+        file_stat.st_size < static_cast<off_t>(sizeof(ShmHeader))) {
+      close(fd);
+      throw std::runtime_error(shm_file_ + " is not a shared memory hashmap.");
+    }
+    mem_size_ = file_stat.st_size;
+    MapRegion(fd);
+
+    if (hdr_->initialized_.load(std::memory_order_acquire) != 1 ||
+        std::memcmp(hdr_->magic_, kMagic, sizeof(hdr_->magic_)) != 0 ||
+        hdr_->key_size_ != sizeof(Key) || hdr_->val_size_ != sizeof(Val) ||
+        !IsPowerOf2(hdr_->table_size_) ||
+        MemSizeFor(hdr_->table_size_) > mem_size_) {
+      munmap(shared_mem_, mem_size_);
+      shared_mem_ = nullptr;
+      throw std::runtime_error(shm_file_ + " does not hold a shared memory "
+          "hashmap with these key and value types.");
+    }
+  }
+
+  ~ShmHashmap() {
+    if (shared_mem_ != nullptr) {
+      munmap(shared_mem_, mem_size_);
+    }
+  }
+
+  // the mapping is tied to this object
+  ShmHashmap(const ShmHashmap&) = delete;
+  ShmHashmap& operator=(const ShmHashmap&) = delete;
+
+  /**
+   * Maps the given key to the given value, overwriting any previous mapping.
+   *
+   * @param k key to insert
+   * @param v value to which to map the key
+   * @throws logic_error if the key is new and the hashmap is already at
+   * capacity
+   */
+  void Put(const Key& k, const Val& v) {
+    int hashcode = HashCode(k);
+
+    // wait until no other process is writing
+    while (hdr_->write_lock_.test_and_set(std::memory_order_acquire));
+
+    // only the writer modifies slots, so it can read them without the
+    // sequence counters
+    int insert_idx = -1;
+    int idx = IndexFor(hashcode);
+    for (int i = 0; i < hdr_->table_size_; ++i) {
+      Slot& slot = table_[idx];
+      if (slot.hashcode == hashcode && eq_fn_(k, slot.k)) {
+        BeginWrite(slot);
+        slot.v = v;
+        EndWrite(slot);
+        hdr_->write_lock_.clear(std::memory_order_release);
+        return;
+      }
+      if (slot.hashcode == kDeleted && insert_idx == -1) {
+        insert_idx = idx;
+      }
+      if (slot.hashcode == kEmpty) {
+        if (insert_idx == -1) {
+          insert_idx = idx;
+        }
+        break;
+      }
+      idx = (idx + 1) & (hdr_->table_size_ - 1);
+    }
+
+    if (hdr_->size_.load(std::memory_order_relaxed) >= hdr_->capacity_ ||
+        insert_idx == -1) {
+      hdr_->write_lock_.clear(std::memory_order_release);
+      throw std::logic_error("Cannot put more entries than the capacity of "
+          "the hashmap.");
+    }
+
+    Slot& slot = table_[insert_idx];
+    BeginWrite(slot);
+    slot.k = k;
+    slot.v = v;
+    slot.hashcode = hashcode;
+    EndWrite(slot);
+    hdr_->size_.fetch_add(1, std::memory_order_relaxed);
+
+    hdr_->write_lock_.clear(std::memory_order_release);
+  }
+
+  /**
+   * Copies the value mapped to the given key into *v. Takes no lock, but
+   * spins on a slot the writer is in the middle of modifying, and retries a
+   * slot if the writer modified it during the copy.
+   *
+   * @param k key to look up
+   * @param v where to copy the value if the key is found. Untouched otherwise.
+   * @return if the key was in the hashmap
+   */
+  bool Get(const Key& k, Val* v) const {
+    int hashcode = HashCode(k);
+    int idx = IndexFor(hashcode);
+    for (int i = 0; i < hdr_->table_size_; ++i) {
+      const Slot& slot = table_[idx];
+
+      // copy the slot out under its seqlock. The key has to be copied too,
+      // because comparing it in place could read a half-written key.
+      uint32_t seq;
+      int slot_hashcode;
+      alignas(Key) char k_buf[sizeof(Key)];
+      alignas(Val) char v_buf[sizeof(Val)];
+      do {
+        seq = slot.seq.load(std::memory_order_acquire);
+        while (UNLIKELY(seq & 1)) {
+          seq = slot.seq.load(std::memory_order_acquire);
+        }
+        slot_hashcode = slot.hashcode;
+        if (slot_hashcode == hashcode) {
+          std::memcpy(k_buf, &slot.k, sizeof(Key));
+          std::memcpy(v_buf, &slot.v, sizeof(Val));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+      } while (UNLIKELY(slot.seq.load(std::memory_order_relaxed) != seq));
+
+      if (slot_hashcode == kEmpty) {
+        return false;
+      }
+      if (slot_hashcode == hashcode &&
+          eq_fn_(k, *reinterpret_cast<const Key*>(k_buf))) {
+        std::memcpy(v, v_buf, sizeof(Val));
+        return true;
+      }
+      idx = (idx + 1) & (hdr_->table_size_ - 1);
+    }
+    return false;
+  }
+
+  /**
+   * @return if the given key is in the hashmap
+   */
+  bool Contains(const Key& k) const {
+    Val v;
+    return Get(k, &v);
+  }
+
+  /**
+   * Removes the given key from the hashmap if present, leaving a tombstone in
+   * its slot. If the next slot is empty, the tombstone and any tombstones
+   * right before it are emptied instead, since every probe that reaches them
+   * would stop at that empty slot anyway.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(const Key& k) {
+    int hashcode = HashCode(k);
+    while (hdr_->write_lock_.test_and_set(std::memory_order_acquire));
+
+    bool removed = false;
+    int idx = IndexFor(hashcode);
+    for (int i = 0; i < hdr_->table_size_; ++i) {
+      Slot& slot = table_[idx];
+      if (slot.hashcode == kEmpty) {
+        break;
+      }
+      if (slot.hashcode == hashcode && eq_fn_(k, slot.k)) {
+        BeginWrite(slot);
+        slot.hashcode = kDeleted;
+        EndWrite(slot);
+        hdr_->size_.fetch_sub(1, std::memory_order_relaxed);
+        removed = true;
+        EmptyTombstonesBefore((idx + 1) & (hdr_->table_size_ - 1));
+        break;
+      }
+      idx = (idx + 1) & (hdr_->table_size_ - 1);
+    }
+
+    hdr_->write_lock_.clear(std::memory_order_release);
+    return removed;
+  }
+
+  /**
+   * @return number of entries in the hashmap
+   */
+  int Size() const {
+    return hdr_->size_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @return maximum number of entries the hashmap can hold
+   */
+  int Capacity() const {
+    return hdr_->capacity_;
+  }
+
+private:
+
+  /**
+   * A slot of the table. Readers only trust what they copied out of a slot
+   * if seq was even before the copy and unchanged after it.
+   */
+  struct Slot {
+    std::atomic<uint32_t> seq;
+
+    // kEmpty, kDeleted, or the 31-bit hashcode of k
+    int hashcode;
+
+    Key k;
+    Val v;
+  };
+
+  /**
+   * Stores the layout of the hashmap and the variables required to
+   * synchronize writers.
+   */
+  struct ShmHeader {
+    /**
+     * Identifies the file as a ShmHashmap.
+     */
+    char magic_[8];
+
+    /**
+     * Set to 1 by the creating process once the rest of the region has been
+     * initialized.
+     */
+    std::atomic<int> initialized_;
+
+    /**
+     * sizeof() the key and value types the hashmap was created with.
+     */
+    int key_size_;
+    int val_size_;
+
+    /**
+     * Maximum number of entries. Constant, should never change except during
+     * creation of the ShmHashmap.
+     */
+    int capacity_;
+
+    /**
+     * Number of slots in the table, a power of 2. Constant.
+     */
+    int table_size_;
+
+    /**
+     * Number of entries in the hashmap.
+     */
+    std::atomic<int> size_;
+
+    /**
+     * Only one process can be writing at a single time. This flag prevents
+     * multiple processes from writing.
+     */
+    std::atomic_flag write_lock_;
+  };
+
+  static constexpr int kEmpty = -1;
+  static constexpr int kDeleted = -2;
+  static constexpr const char kMagic[8] = "DSSHMHM";
+
+  /**
+   * @return number of bytes of shared memory needed for a table of the given
+   * size. The table starts on its own cache line after the header.
+   */
+  static size_t MemSizeFor(int table_size) {
+    return HeaderBytes() + sizeof(Slot) * static_cast<size_t>(table_size);
+  }
+
+  static size_t HeaderBytes() {
+    return (sizeof(ShmHeader) + 63) & ~static_cast<size_t>(63);
+  }
+
+  /**
+   * Maps mem_size_ bytes of the given file and closes it.
+   */
+  void MapRegion(int fd) {
+    void* mem = mmap(NULL, mem_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+        0);
+
+    // the mapping keeps the file open
+    close(fd);
+    if (mem == MAP_FAILED) {
+      throw std::runtime_error("Could not mmap " + shm_file_);
+    }
+    shared_mem_ = static_cast<char*>(mem);
+    hdr_ = reinterpret_cast<ShmHeader*>(shared_mem_);
+    table_ = reinterpret_cast<Slot*>(shared_mem_ + HeaderBytes());
+  }
+
+  /**
+   * If the slot at idx is empty, empties the run of tombstones right before
+   * it. Only called by the writer.
+   */
+  void EmptyTombstonesBefore(int idx) {
+    if (table_[idx].hashcode != kEmpty) {
+      return;
+    }
+    int mask = hdr_->table_size_ - 1;
+    for (int i = (idx - 1) & mask; table_[i].hashcode == kDeleted;
+        i = (i - 1) & mask) {
+      BeginWrite(table_[i]);
+      table_[i].hashcode = kEmpty;
+      EndWrite(table_[i]);
+    }
+  }
+
+  /**
+   * Makes a slot's sequence counter odd, so readers retry it until
+   * EndWrite().
+   */
+  static inline void BeginWrite(Slot& slot) {
+    slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /**
+   * Makes a slot's sequence counter even again, publishing the write.
+   */
+  static inline void EndWrite(Slot& slot) {
+    slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1,
+        std::memory_order_release);
+  }
+
+  /**
+   * @return hash code for the given key
+   */
+  inline int HashCode(const Key& k) const {
+    return hash_fn_(k) & 0x7FFFFFFF;
+  }
+
+  /**
+   * @return the index in the table at which the hashcode belongs if there
+   * were no collisions.
+   */
+  inline int IndexFor(int hashcode) const {
+    return hashcode & (hdr_->table_size_ - 1);
+  }
+
+private:
+
+  /**
+   * Name of disk file on which shared memory can be swapped out onto.
+   */
+  const std::string shm_file_ = "no-file-specified";
+
+  /**
+   * Number of bytes of shared memory that are mapped.
+   */
+  size_t mem_size_ = 0;
+
+  /**
+   * Shared memory (points to the ShmHeader)
+   */
+  char* shared_mem_ = nullptr;
+
+  /**
+   * Header containing details about this hashmap (such as its capacity)
+   */
+  ShmHeader* hdr_ = nullptr;
+
+  /**
+   * Table of slots in shared memory (points to right after the ShmHeader)
+   */
+  Slot* table_ = nullptr;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+template<class Key, class Val, class Hash, class Eq>
+constexpr const char ShmHashmap<Key, Val, Hash, Eq>::kMagic[8];
+
+} // namespace dsalgo
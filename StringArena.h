@@ -0,0 +1,413 @@
+#pragma once
+
+#include "StringRef.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+namespace dsalgo {
+
+/**
+ * Bump allocator for the characters of many strings. Strings are copied into
+ * large chunks one after another, so adding a string is usually just a
+ * memcpy, strings added together sit next to each other in memory, and
+ * everything is freed at once by Clear() or the destructor instead of one
+ * string at a time.
+ *
+ * Added strings never move, so the returned StringRefs stay valid until the
+ * arena is cleared or destroyed.
+ */
+class StringArena {
+
+public:
+
+  /**
+   * @param chunk_size number of bytes to allocate at a time. Strings longer
+   * than this get a chunk of their own.
+   */
+  StringArena(size_t chunk_size=kDefaultChunkSize) : chunk_size_(chunk_size) {}
+
+  ~StringArena() {
+    FreeMem();
+  }
+
+  // copies would have to relocate every string, invalidating the references
+  // handed out so far
+  StringArena(const StringArena&) = delete;
+  StringArena& operator=(const StringArena&) = delete;
+
+  StringArena(StringArena&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  StringArena& operator=(StringArena&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Copies the given characters into the arena.
+   *
+   * @return reference to the copy
+   */
+  StringRef Add(const StringRef& s) {
+    if (chunks_.empty() || chunk_used_ + s.size > chunk_capacity_) {
+      AddChunk(s.size);
+    }
+    char* dest = chunks_.back() + chunk_used_;
+    if (s.size > 0) {
+      std::memcpy(dest, s.data, s.size);
+    }
+    chunk_used_ += s.size;
+    bytes_used_ += s.size;
+    return StringRef(dest, s.size);
+  }
+
+  /**
+   * Frees every string in the arena at once. The first chunk is kept to be
+   * reused, so refilling the arena to a similar size doesn't start with a
+   * malloc.
+   */
+  void Clear() {
+    if (chunks_.empty()) {
+      return;
+    }
+    for (size_t i = 1; i < chunks_.size(); ++i) {
+      delete[] chunks_[i];
+    }
+    chunks_.resize(1);
+    chunk_capacity_ = first_chunk_capacity_;
+    chunk_used_ = 0;
+    bytes_used_ = 0;
+  }
+
+  /**
+   * @return number of characters added since the arena was last cleared.
+   */
+  size_t BytesUsed() const {
+    return bytes_used_;
+  }
+
+private:
+
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+  /**
+   * Starts a new chunk with room for at least min_size characters. The rest
+   * of the current chunk is abandoned.
+   */
+  void AddChunk(size_t min_size) {
+    chunk_capacity_ = std::max(chunk_size_, min_size);
+    chunks_.push_back(new char[chunk_capacity_]);
+    if (chunks_.size() == 1) {
+      first_chunk_capacity_ = chunk_capacity_;
+    }
+    chunk_used_ = 0;
+  }
+
+  /**
+   * Frees any memory that has been allocated for this arena.
+   */
+  void FreeMem() {
+    for (char* chunk : chunks_) {
+      delete[] chunk;
+    }
+    chunks_.clear();
+  }
+
+  /**
+   * Moves another arena into this arena. The other arena is emptied.
+   */
+  void MoveFrom(StringArena& other) {
+    chunks_ = std::move(other.chunks_);
+    chunk_size_ = other.chunk_size_;
+    chunk_capacity_ = other.chunk_capacity_;
+    first_chunk_capacity_ = other.first_chunk_capacity_;
+    chunk_used_ = other.chunk_used_;
+    bytes_used_ = other.bytes_used_;
+
+    other.chunks_.clear();
+    other.chunk_used_ = 0;
+    other.bytes_used_ = 0;
+  }
+
+private:
+
+  // chunks of characters. Only the last one is still being filled.
+  std::vector<char*> chunks_;
+
+  size_t chunk_size_ = kDefaultChunkSize;
+
+  // size of the last chunk
+  size_t chunk_capacity_ = 0;
+
+  // size of the first chunk, which Clear() keeps
+  size_t first_chunk_capacity_ = 0;
+
+  // number of characters used in the last chunk
+  size_t chunk_used_ = 0;
+
+  size_t bytes_used_ = 0;
+};
+
+
+/**
+ * Handle to a string interned by a StringInterner. Half the size of a
+ * std::string, and carries the string's hash so hashing it is free.
+ *
+ * A StringInterner hands out exactly one handle per distinct string, so two
+ * handles from the same interner are equal if and only if they point at the
+ * same characters, without comparing them. Handles from different interners
+ * must not be compared.
+ *
+ * Handles are iterable, so they can also be Triemap keys.
+ */
+struct InternedString {
+  const char* data = nullptr;
+  uint32_t size = 0;
+
+  // low 32 bits of StrHash of the characters
+  uint32_t hash = 0;
+
+  const char* begin() const {
+    return data;
+  }
+
+  const char* end() const {
+    return data + size;
+  }
+
+  StringRef Ref() const {
+    return StringRef(data, size);
+  }
+
+  std::string ToString() const {
+    return std::string(data, size);
+  }
+
+  bool operator==(const InternedString& other) const {
+    return data == other.data;
+  }
+
+  bool operator!=(const InternedString& other) const {
+    return !(*this == other);
+  }
+};
+
+
+/**
+ * Deduplicates strings into a StringArena. Interning a string that was
+ * interned before returns the same handle without copying it again.
+ *
+ * The handles themselves are kept in a linear-probing table, so interning
+ * hashes the characters once and finding a string compares the cached hashes
+ * before any characters.
+ *
+ * Clear() frees every string at once, which invalidates all handles, so
+ * containers keyed by them have to be cleared along with the interner.
+ */
+class StringInterner {
+
+public:
+
+  StringInterner() {
+    AllocSlots(kInitTableSize);
+  }
+
+  ~StringInterner() {
+    FreeMem();
+  }
+
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  StringInterner(StringInterner&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  StringInterner& operator=(StringInterner&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * @return the handle for the given characters, copying them into the arena
+   * if they haven't been interned yet.
+   * @throws length_error if the string has 2^32 characters or more
+   */
+  InternedString Intern(const StringRef& s) {
+    uint32_t hash = static_cast<uint32_t>(hash_fn_(s));
+    int idx = FindSlot(s, hash);
+    if (slots_[idx].data != nullptr) {
+      return slots_[idx];
+    }
+    if (s.size > UINT32_MAX) {
+      throw std::length_error("String too long to intern.");
+    }
+
+    if (size_ + 1 > table_size_ * kMaxLoadFactor) {
+      Grow();
+      idx = FindSlot(s, hash);
+    }
+    StringRef copy = arena_.Add(s);
+    InternedString& handle = slots_[idx];
+    // an empty string takes no room in the arena, so its copy would start
+    // where the next string does. Point it at a literal instead.
+    handle.data = copy.size > 0 ? copy.data : "";
+    handle.size = static_cast<uint32_t>(copy.size);
+    handle.hash = hash;
+    ++size_;
+    return handle;
+  }
+
+  /**
+   * @return the handle for the given characters, or nullptr if they haven't
+   * been interned. Never copies anything, so it's cheaper than Intern() for
+   * lookups that may miss.
+   */
+  const InternedString* Find(const StringRef& s) const {
+    const InternedString& slot =
+      slots_[FindSlot(s, static_cast<uint32_t>(hash_fn_(s)))];
+    return slot.data != nullptr ? &slot : nullptr;
+  }
+
+  /**
+   * @return number of distinct strings interned.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * @return number of characters copied into the arena.
+   */
+  size_t BytesUsed() const {
+    return arena_.BytesUsed();
+  }
+
+  /**
+   * Forgets every interned string and frees them all at once. Invalidates
+   * every handle. The table keeps its size, so interning about as many
+   * strings again doesn't have to grow it.
+   */
+  void Clear() {
+    std::fill(slots_, slots_ + table_size_, InternedString());
+    size_ = 0;
+    arena_.Clear();
+  }
+
+private:
+
+  static constexpr int kInitTableSize = 16;
+
+  static constexpr float kMaxLoadFactor = 0.5;
+
+  /**
+   * @return index of the slot holding the given string, or of the empty slot
+   * where it would be inserted.
+   */
+  int FindSlot(const StringRef& s, uint32_t hash) const {
+    int mask = table_size_ - 1;
+    int idx = FibonacciIndex(hash, table_size_);
+    while (slots_[idx].data != nullptr) {
+      const InternedString& slot = slots_[idx];
+      if (slot.hash == hash && slot.size == s.size &&
+          std::memcmp(slot.data, s.data, s.size) == 0) {
+        break;
+      }
+      idx = (idx + 1) & mask;
+    }
+    return idx;
+  }
+
+  /**
+   * Doubles the table, reinserting the handles by their cached hashes.
+   */
+  void Grow() {
+    InternedString* old_slots = slots_;
+    int old_table_size = table_size_;
+    AllocSlots(table_size_ * 2);
+    int mask = table_size_ - 1;
+    for (int i = 0; i < old_table_size; ++i) {
+      if (old_slots[i].data == nullptr) {
+        continue;
+      }
+      int idx = FibonacciIndex(old_slots[i].hash, table_size_);
+      while (slots_[idx].data != nullptr) {
+        idx = (idx + 1) & mask;
+      }
+      slots_[idx] = old_slots[i];
+    }
+    delete[] old_slots;
+  }
+
+  /**
+   * Allocates an empty table with the given number of slots.
+   */
+  void AllocSlots(int table_size) {
+    slots_ = new InternedString[table_size];
+    table_size_ = table_size;
+  }
+
+  /**
+   * Frees any memory that has been allocated for the table. The arena frees
+   * itself.
+   */
+  void FreeMem() {
+    delete[] slots_;
+    slots_ = nullptr;
+  }
+
+  /**
+   * Moves another interner into this interner. The other interner is left
+   * empty but usable.
+   */
+  void MoveFrom(StringInterner& other) {
+    arena_ = std::move(other.arena_);
+    slots_ = other.slots_;
+    table_size_ = other.table_size_;
+    size_ = other.size_;
+
+    other.AllocSlots(kInitTableSize);
+    other.size_ = 0;
+  }
+
+private:
+
+  StringArena arena_;
+
+  // handle of each interned string. Empty slots have null data.
+  InternedString* slots_ = nullptr;
+
+  int table_size_ = 0;
+
+  int size_ = 0;
+
+  StrHash hash_fn_;
+};
+
+} // namespace dsalgo
+
+
+namespace std {
+
+/**
+ * Returns the hash an InternedString carries, so containers with the default
+ * std::hash don't have to look at the characters.
+ */
+template<>
+struct hash<dsalgo::InternedString> {
+  size_t operator()(const dsalgo::InternedString& s) const {
+    return s.hash;
+  }
+};
+
+} // namespace std
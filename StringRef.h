@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstring>
+#include <stdint.h>
+#include <string>
+
+
+namespace dsalgo {
+
+/**
+ * Non-owning reference to a run of characters, e.g. a token inside a request
+ * buffer. Lets hashmaps with std::string keys be searched without allocating
+ * a temporary std::string (see StrHash and StrEq).
+ *
+ * The referenced characters must outlive the StringRef.
+ */
+struct StringRef {
+  const char* data = nullptr;
+  size_t size = 0;
+
+  StringRef() {}
+  StringRef(const char* d, size_t n) : data(d), size(n) {}
+  StringRef(const char* s) : data(s), size(std::strlen(s)) {}
+  StringRef(const std::string& s) : data(s.data()), size(s.size()) {}
+
+  const char* begin() const {
+    return data;
+  }
+
+  const char* end() const {
+    return data + size;
+  }
+
+  std::string ToString() const {
+    return std::string(data, size);
+  }
+
+  bool operator==(const StringRef& other) const {
+    return size == other.size && std::memcmp(data, other.data, size) == 0;
+  }
+
+  bool operator!=(const StringRef& other) const {
+    return !(*this == other);
+  }
+};
+
+
+/**
+ * Transparent hash function for strings. Gives the same hash for a
+ * std::string, a const char* and a StringRef holding the same characters.
+ */
+struct StrHash {
+  using is_transparent = void;
+
+  size_t operator()(const StringRef& s) const {
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < s.size; ++i) {
+      hash ^= static_cast<unsigned char>(s.data[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+};
+
+
+/**
+ * Transparent equality function for strings. Compares any mix of
+ * std::string, const char* and StringRef by their characters.
+ */
+struct StrEq {
+  using is_transparent = void;
+
+  bool operator()(const StringRef& s1, const StringRef& s2) const {
+    return s1 == s2;
+  }
+};
+
+} // namespace dsalgo
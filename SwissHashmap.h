@@ -0,0 +1,452 @@
+#pragma once
+
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+#include <functional>
+#include <stdint.h>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace dsalgo {
+
+/**
+ * Scans a group of control bytes at once. Each control byte is either one of
+ * the special values kEmpty/kDeleted (sign bit set) or the bottom 7 bits of a
+ * full slot's hash (sign bit clear).
+ *
+ * With AVX2, a group is 32 control bytes. With SSE2, a group is 16 control
+ * bytes. Otherwise, the group is scanned one byte at a time.
+ */
+struct CtrlGroup {
+
+  static constexpr int8_t kEmpty = -128;
+  static constexpr int8_t kDeleted = -2;
+
+#if defined(__AVX2__)
+  static constexpr int kWidth = 32;
+
+  /**
+   * @return bitmask of the bytes in the group that are equal to b
+   */
+  static inline uint32_t Match(const int8_t* group, int8_t b) {
+    __m256i ctrl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(group));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(b), ctrl));
+  }
+
+  /**
+   * @return bitmask of the bytes in the group that are empty or deleted
+   */
+  static inline uint32_t MatchEmptyOrDeleted(const int8_t* group) {
+    __m256i ctrl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(group));
+    return _mm256_movemask_epi8(ctrl);
+  }
+
+#elif defined(__SSE2__)
+  static constexpr int kWidth = 16;
+
+  static inline uint32_t Match(const int8_t* group, int8_t b) {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(b), ctrl));
+  }
+
+  static inline uint32_t MatchEmptyOrDeleted(const int8_t* group) {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return _mm_movemask_epi8(ctrl);
+  }
+
+#else
+  static constexpr int kWidth = 16;
+
+  static inline uint32_t Match(const int8_t* group, int8_t b) {
+    uint32_t mask = 0;
+    for (int i = 0; i < kWidth; ++i) {
+      mask |= static_cast<uint32_t>(group[i] == b) << i;
+    }
+    return mask;
+  }
+
+  static inline uint32_t MatchEmptyOrDeleted(const int8_t* group) {
+    uint32_t mask = 0;
+    for (int i = 0; i < kWidth; ++i) {
+      mask |= static_cast<uint32_t>(group[i] < 0) << i;
+    }
+    return mask;
+  }
+#endif
+
+  static inline uint32_t MatchEmpty(const int8_t* group) {
+    return Match(group, kEmpty);
+  }
+};
+
+
+/**
+ * Open-addressing hashmap that keeps a separate array of 1-byte control tags
+ * (Swiss-table style).
+ *
+ * Each control tag holds 7 bits of the key's hash or marks the slot as
+ * empty/deleted. Lookups scan a whole group of tags with a single SIMD compare
+ * and only touch the Entry memory of slots whose tag matches, so most probe
+ * steps never pull keys or values into cache. This also makes high load
+ * factors (0.875 by default) cheap.
+ *
+ * Key = type used for lookup
+ * Val = type that gets mapped to in the hashmap
+ * Hash = hash function for the key
+ * Eq = equality function for the key
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class SwissHashmap {
+
+public:
+
+  /**
+   * Creates a hashmap with the specified initial maximum capacity and load
+   * factor.
+   *
+   * @param init_capacity initial number of slots. Rounded up to a power of 2
+   * that is at least one group wide.
+   * @param load_factor how soon to resize the hashmap. Deleted slots count
+   * toward the load because they lengthen probe sequences.
+   */
+  SwissHashmap(int init_capacity, float load_factor=0.875)
+      : load_factor_(load_factor) {
+
+    if (init_capacity < CtrlGroup::kWidth) {
+      init_capacity = CtrlGroup::kWidth;
+    }
+
+    capacity_ = IsPowerOf2(init_capacity) ?
+      init_capacity :
+      NextPowerOf2(init_capacity);
+
+    AllocTable();
+  }
+
+  SwissHashmap() : SwissHashmap(CtrlGroup::kWidth) {}
+
+  ~SwissHashmap() {
+    FreeMem();
+  }
+
+  SwissHashmap(const SwissHashmap<Key, Val, Hash, Eq>& other) {
+    CopyFrom(other);
+  }
+
+  SwissHashmap(SwissHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  SwissHashmap<Key, Val, Hash, Eq>& operator=(
+      const SwissHashmap<Key, Val, Hash, Eq>& other) {
+    FreeMem();
+    CopyFrom(other);
+    return *this;
+  }
+
+  SwissHashmap<Key, Val, Hash, Eq>& operator=(
+      SwissHashmap<Key, Val, Hash, Eq>&& other) noexcept {
+    FreeMem();
+    MoveFrom(other);
+    return *this;
+  }
+
+  /**
+   * Maps the given key to the given value, overwriting any previous mapping.
+   *
+   * If the hashmap resizes after Put() is called, then all references and
+   * pointers to values in the hashmap are invalidated.
+   *
+   * @param k key to insert
+   * @param v value to which to map the key
+   */
+  void Put(const Key& k, const Val& v) {
+    size_t hash = hash_fn_(k);
+    int idx = LocateEntryIdx(k, hash);
+    if (idx != -1) {
+      slots_[idx].v = v;
+      return;
+    }
+
+    if (size_ + num_deleted_ >= load_factor_ * capacity_) {
+      Resize();
+    }
+
+    idx = LocateInsertIdx(hash);
+    if (ctrl_[idx] == CtrlGroup::kDeleted) {
+      --num_deleted_;
+    }
+    ctrl_[idx] = H2(hash);
+    slots_[idx].k = k;
+    slots_[idx].v = v;
+    ++size_;
+  }
+
+  /**
+   * Gets the value to which the given key is mapped, inserting a default
+   * constructed value if the key is not in the hashmap.
+   */
+  Val& operator[](const Key& k) {
+    Val* v = Get(k);
+    if (v != nullptr) {
+      return *v;
+    }
+    Put(k, Val());
+    return *Get(k);
+  }
+
+  /**
+   * @return the value associated with the given key, or nullptr if the key
+   * is not in the hashmap.
+   */
+  Val* Get(const Key& k) const {
+    int idx = LocateEntryIdx(k, hash_fn_(k));
+    return (idx != -1) ? &slots_[idx].v : nullptr;
+  }
+
+  /**
+   * Removes the given key from the hashmap if present. Otherwise, does nothing.
+   *
+   * @param k the key to remove
+   * @return if the key was removed
+   */
+  bool Remove(const Key& k) {
+    int idx = LocateEntryIdx(k, hash_fn_(k));
+    if (idx == -1) {
+      return false;
+    }
+
+    // Lookups stop at the first group that has an empty slot. If this slot's
+    // group already has an empty slot, every lookup that reaches this group
+    // stops here anyway, so the slot can be marked empty. Otherwise, we have
+    // to leave a tombstone so that lookups continue on to later groups.
+    const int8_t* group = ctrl_ + (idx & ~(CtrlGroup::kWidth - 1));
+    if (CtrlGroup::MatchEmpty(group) != 0) {
+      ctrl_[idx] = CtrlGroup::kEmpty;
+    } else {
+      ctrl_[idx] = CtrlGroup::kDeleted;
+      ++num_deleted_;
+    }
+    --size_;
+    return true;
+  }
+
+  /**
+   * @return number of entries in this hashmap.
+   */
+  int Size() const {
+    return size_;
+  }
+
+  /**
+   * Removes all elements from this hashmap.
+   */
+  void Clear() {
+    std::memset(ctrl_, CtrlGroup::kEmpty, capacity_);
+    size_ = 0;
+    num_deleted_ = 0;
+  }
+
+private:
+
+  /**
+   * Represents a slot in the hashmap. Whether or not the slot is in use is
+   * tracked by the control byte at the same index.
+   */
+  struct Entry {
+    Key k;
+    Val v;
+  };
+
+  /**
+   * @return bits of the hash used to select the first group to probe.
+   */
+  static inline size_t H1(size_t hash) {
+    return hash >> 7;
+  }
+
+  /**
+   * @return bits of the hash stored in the control byte.
+   */
+  static inline int8_t H2(size_t hash) {
+    return static_cast<int8_t>(hash & 0x7F);
+  }
+
+  /**
+   * Allocates empty control bytes and slots for capacity_ entries.
+   */
+  void AllocTable() {
+    num_groups_ = capacity_ / CtrlGroup::kWidth;
+    ctrl_ = new int8_t[capacity_];
+    std::memset(ctrl_, CtrlGroup::kEmpty, capacity_);
+    slots_ = new Entry[capacity_];
+  }
+
+  /**
+   * Frees any memory that has been allocated for this hashtable.
+   */
+  void FreeMem() {
+    delete[] ctrl_;
+    delete[] slots_;
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+  }
+
+  /**
+   * Copies another hashtable into this hashtable. Does not free any currently
+   * allocated memory though.
+   */
+  void CopyFrom(const SwissHashmap<Key, Val, Hash, Eq>& other) {
+    capacity_ = other.capacity_;
+    AllocTable();
+    std::memcpy(ctrl_, other.ctrl_, capacity_);
+    std::copy(other.slots_, other.slots_ + capacity_, slots_);
+    size_ = other.size_;
+    num_deleted_ = other.num_deleted_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = other.hash_fn_;
+    eq_fn_ = other.eq_fn_;
+  }
+
+  /**
+   * Moves another hashtable into this hashtable. The other hashtable is
+   * emptied and invalidated.
+   */
+  void MoveFrom(SwissHashmap<Key, Val, Hash, Eq>& other) {
+    ctrl_ = other.ctrl_;
+    slots_ = other.slots_;
+    capacity_ = other.capacity_;
+    num_groups_ = other.num_groups_;
+    size_ = other.size_;
+    num_deleted_ = other.num_deleted_;
+    load_factor_ = other.load_factor_;
+    hash_fn_ = std::move(other.hash_fn_);
+    eq_fn_ = std::move(other.eq_fn_);
+
+    other.ctrl_ = nullptr;
+    other.slots_ = nullptr;
+  }
+
+  /**
+   * @return the index of the slot holding the given key, or -1 if the key is
+   * not in the hashmap.
+   */
+  int LocateEntryIdx(const Key& k, size_t hash) const {
+    int8_t h2 = H2(hash);
+    int group_idx = H1(hash) & (num_groups_ - 1);
+
+    // triangular probing over groups visits every group exactly once when the
+    // number of groups is a power of 2.
+    for (int probe = 1; probe <= num_groups_; ++probe) {
+      const int8_t* group = ctrl_ + group_idx * CtrlGroup::kWidth;
+      for (uint32_t match = CtrlGroup::Match(group, h2); match != 0;
+          match &= match - 1) {
+        int idx = group_idx * CtrlGroup::kWidth + __builtin_ctz(match);
+        if (LIKELY(eq_fn_(slots_[idx].k, k))) {
+          return idx;
+        }
+      }
+
+      // an empty slot means the key would have been inserted into this group
+      // if it were in the hashmap.
+      if (CtrlGroup::MatchEmpty(group) != 0) {
+        return -1;
+      }
+      group_idx = (group_idx + probe) & (num_groups_ - 1);
+    }
+    return -1;
+  }
+
+  /**
+   * @return the index of the first empty or deleted slot along the hash's
+   * probe sequence. The table must not be full.
+   */
+  int LocateInsertIdx(size_t hash) const {
+    int group_idx = H1(hash) & (num_groups_ - 1);
+    for (int probe = 1; probe <= num_groups_; ++probe) {
+      const int8_t* group = ctrl_ + group_idx * CtrlGroup::kWidth;
+      uint32_t match = CtrlGroup::MatchEmptyOrDeleted(group);
+      if (match != 0) {
+        return group_idx * CtrlGroup::kWidth + __builtin_ctz(match);
+      }
+      group_idx = (group_idx + probe) & (num_groups_ - 1);
+    }
+    assert(false);
+    return -1;
+  }
+
+  /**
+   * Grows the table, or if most of the load is tombstones, rehashes it at the
+   * same size to clear them out.
+   */
+  void Resize() {
+    int8_t* old_ctrl = ctrl_;
+    Entry* old_slots = slots_;
+    int old_capacity = capacity_;
+
+    // if at least half of the load is live entries, grow the table. Otherwise,
+    // rehashing at the current size frees up enough tombstones.
+    if (size_ >= load_factor_ * capacity_ / 2) {
+      do {
+        capacity_ *= 2;
+      } while (size_ + 1 >= load_factor_ * capacity_);
+    }
+    AllocTable();
+    num_deleted_ = 0;
+
+    for (int i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] >= 0) {
+        size_t hash = hash_fn_(old_slots[i].k);
+        int insert_idx = LocateInsertIdx(hash);
+        ctrl_[insert_idx] = H2(hash);
+        slots_[insert_idx] = std::move(old_slots[i]);
+      }
+    }
+
+    delete[] old_ctrl;
+    delete[] old_slots;
+  }
+
+private:
+
+  // control bytes, one per slot
+  int8_t* ctrl_ = nullptr;
+
+  // keys and values, only valid where the control byte is non-negative
+  Entry* slots_ = nullptr;
+
+  // number of slots, must be a power of 2 and a multiple of the group width
+  int capacity_ = 0;
+
+  // capacity_ / CtrlGroup::kWidth
+  int num_groups_ = 0;
+
+  // number of entries in the hashmap
+  int size_ = 0;
+
+  // number of tombstones in the control bytes
+  int num_deleted_ = 0;
+
+  // hashmap will resize when size_ + num_deleted_ exceeds
+  // capacity_ * load_factor_
+  float load_factor_ = 0;
+
+  Hash hash_fn_;
+
+  Eq eq_fn_;
+};
+
+} // namespace dsalgo
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "CacheNodePool.h"
+#include "FrequencySketch.h"
+#include "Hashmap.h"
+#include "Utils.h"
+#include <algorithm>
+#include <assert.h>
+#include <functional>
+#include <utility>
+
+
+namespace dsalgo {
+
+/**
+ * Key-value cache with W-TinyLFU eviction, from Einziger, Friedman and
+ * Manes, "TinyLFU: A Highly Efficient Cache Admission Policy" (2017), as used
+ * by Caffeine. A drop-in alternative to LruCache that keeps the keys that are
+ * used most often, even through scans.
+ *
+ * New keys enter a small LRU window, 1% of the capacity. The rest is the
+ * main cache, a SegmentedLruCache-style probationary and protected segment.
+ * When the window overflows, its least-recently used key becomes a candidate
+ * for the main cache, and is only admitted if it has been used more often
+ * recently than the main cache's victim, which is evicted instead. Otherwise
+ * the candidate is evicted. How often keys were used is estimated by a
+ * FrequencySketch of every key looked up, cached or not, so a scan's keys,
+ * each seen once, never displace popular ones. The window lets bursts of
+ * new keys that are reused right away still get hits.
+ *
+ * Get() records the key in the sketch whether it hits or not. Put() doesn't,
+ * since in a read-through cache, it follows a Get() that missed.
+ */
+template<
+  class Key,
+  class Val,
+  class Hash=std::hash<Key>,
+  class Eq=std::equal_to<Key>
+  >
+class TinyLfuCache {
+
+public:
+
+  /**
+   * @param capacity maximum number of entries. Must be at least 1.
+   */
+  TinyLfuCache(int capacity)
+      : capacity_(capacity),
+        window_capacity_(std::max(1, capacity / 100)),
+        main_capacity_(capacity - window_capacity_),
+        protected_capacity_(static_cast<int>(main_capacity_ * 0.8)),
+        nodes_(capacity + 1),
+        sketch_(capacity) {
+    assert(capacity >= 1);
+    index_.Reserve(capacity + 2);
+  }
+
+  /**
+   * Looks up a key, records it in the frequency sketch, and marks it as
+   * used if it's cached.
+   *
+   * @return the value the key is mapped to, or nullptr if the key isn't in
+   * the cache. Valid until the key is erased or evicted.
+   */
+  Val* Get(const Key& k) {
+    sketch_.Increment(hash_fn_(k));
+    int32_t* found = index_.Get(k);
+    if (found == nullptr) {
+      return nullptr;
+    }
+    Touch(*found);
+    return &nodes_[*found].v;
+  }
+
+  /**
+   * Looks up a key without recording it or marking it as used.
+   */
+  const Val* Peek(const Key& k) const {
+    int32_t* found = index_.Get(k);
+    return found == nullptr ? nullptr : &nodes_[*found].v;
+  }
+
+  /**
+   * Maps the key to the value. A new key enters the window, which may make
+   * the window's least-recently used key compete with the main cache's
+   * victim. An existing key is marked as used.
+   *
+   * @return true if the key was inserted, false if its value was replaced.
+   */
+  bool Put(const Key& k, const Val& v) {
+    std::pair<int32_t*, bool> found = index_.TryEmplace(k);
+    if (!found.second) {
+      nodes_[*found.first].v = v;
+      Touch(*found.first);
+      return false;
+    }
+
+    // there's always a spare node, since the pool has one more than the
+    // capacity
+    int32_t node = nodes_.Alloc();
+    *found.first = node;
+    nodes_[node].k = k;
+    nodes_[node].v = v;
+    nodes_.PushMru(window_, kWindow, node);
+    if (window_.size > window_capacity_) {
+      AdmitOrEvict(window_.lru);
+    }
+    return true;
+  }
+
+  /**
+   * Removes a key from the cache. Its frequency is still remembered.
+   *
+   * @return if the key was in the cache.
+   */
+  bool Erase(const Key& k) {
+    int32_t* found = index_.Get(k);
+    if (found == nullptr) {
+      return false;
+    }
+    int32_t node = *found;
+    index_.Remove(k);
+    nodes_.Unlink(SegmentOf(node), node);
+    nodes_.Free(node);
+    return true;
+  }
+
+  /**
+   * Removes every entry, and forgets every frequency.
+   */
+  void Clear() {
+    nodes_ = Pool(capacity_ + 1);
+    window_ = List();
+    probation_ = List();
+    protected_ = List();
+    sketch_.Clear();
+    index_.Clear();
+  }
+
+  int Size() const {
+    return window_.size + probation_.size + protected_.size;
+  }
+
+  int Capacity() const {
+    return capacity_;
+  }
+
+private:
+
+  typedef CacheNodePool<Key, Val> Pool;
+  typedef typename Pool::List List;
+
+  // list ids of the segments
+  static constexpr uint8_t kWindow = 0;
+  static constexpr uint8_t kProbation = 1;
+  static constexpr uint8_t kProtected = 2;
+
+  List& SegmentOf(int32_t node) {
+    switch (nodes_[node].list) {
+      case kWindow: return window_;
+      case kProbation: return probation_;
+      default: return protected_;
+    }
+  }
+
+  /**
+   * Marks an entry as used. Window entries stay in the window. Main cache
+   * entries move to the protected segment, which overflows into the
+   * probationary one, as in SegmentedLruCache.
+   */
+  void Touch(int32_t node) {
+    if (nodes_[node].list == kWindow) {
+      nodes_.MoveToMru(window_, window_, kWindow, node);
+      return;
+    }
+    nodes_.MoveToMru(SegmentOf(node), protected_, kProtected, node);
+    if (protected_.size > protected_capacity_) {
+      int32_t demoted = protected_.lru;
+      nodes_.Unlink(protected_, demoted);
+      nodes_.PushMru(probation_, kProbation, demoted);
+    }
+  }
+
+  /**
+   * Moves the candidate out of the window into the main cache if the main
+   * cache has room or the candidate is used more often than the main cache's
+   * victim, evicting the loser.
+   */
+  void AdmitOrEvict(int32_t candidate) {
+    nodes_.Unlink(window_, candidate);
+    if (probation_.size + protected_.size < main_capacity_) {
+      nodes_.PushMru(probation_, kProbation, candidate);
+      return;
+    }
+
+    int32_t victim = (probation_.size > 0) ? probation_.lru : protected_.lru;
+    if (victim != Pool::kNoNode &&
+        sketch_.Frequency(hash_fn_(nodes_[candidate].k)) >
+        sketch_.Frequency(hash_fn_(nodes_[victim].k))) {
+      nodes_.Unlink(SegmentOf(victim), victim);
+      Evict(victim);
+      nodes_.PushMru(probation_, kProbation, candidate);
+    } else {
+      Evict(candidate);
+    }
+  }
+
+  /**
+   * Forgets an unlinked entry.
+   */
+  void Evict(int32_t node) {
+    index_.Remove(nodes_[node].k);
+    nodes_.Free(node);
+  }
+
+private:
+
+  int capacity_ = 0;
+
+  int window_capacity_ = 0;
+
+  int main_capacity_ = 0;
+
+  int protected_capacity_ = 0;
+
+  Pool nodes_;
+
+  List window_;
+
+  List probation_;
+
+  List protected_;
+
+  FrequencySketch sketch_;
+
+  /**
+   * Maps each key to its node.
+   */
+  Hashmap<Key, int32_t, FibonacciHash<Hash>, Eq> index_;
+
+  Hash hash_fn_;
+};
+
+} // namespace dsalgo
@@ -1,4 +1,7 @@
 #pragma once
+#include <stddef.h>
+#include <stdint.h>
+
 #define LIKELY(condition) __builtin_expect(static_cast<bool>(condition), 1)
 #define UNLIKELY(condition) __builtin_expect(static_cast<bool>(condition), 0)
 
@@ -24,5 +27,63 @@ static inline bool IsPowerOf2(int x) {
 	return x > 0 && ((x & (x - 1)) == 0);
 }
 
+static inline int64_t NextPowerOf2(int64_t x) {
+	x--;
+	x |= x >> 1;
+	x |= x >> 2;
+	x |= x >> 4;
+	x |= x >> 8;
+	x |= x >> 16;
+	x |= x >> 32;
+	x++;
+	return x;
+}
+
+static inline bool IsPowerOf2(int64_t x) {
+	return x > 0 && ((x & (x - 1)) == 0);
+}
+
+/**
+ * Maps a hash to an index in a table whose size is a power of 2 by
+ * multiplying it by 2^64 / golden ratio and keeping the high bits (Fibonacci
+ * hashing). Unlike masking off the low bits, every bit of the hash affects
+ * the index, so it works for identity hashes of integers. table_size must
+ * be at least 2.
+ */
+static inline int FibonacciIndex(uint64_t hash, int table_size) {
+	int shift = 64 - __builtin_ctz(table_size);
+	return static_cast<int>((hash * 0x9E3779B97F4A7C15ULL) >> shift);
+}
+
+/**
+ * murmur3's 64-bit finalizer: scrambles a hash so that every bit of it
+ * affects every bit of the result. Maps 0 to 0.
+ */
+static inline uint64_t MurmurMix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+/**
+ * Wraps a hash function so that every bit of its hash affects the low bits,
+ * which are all Hashmap looks at: multiplies by 2^64 / golden ratio like
+ * FibonacciIndex() and keeps the high half. Use it as a Hashmap's Hash when
+ * the keys' hashes may only differ in their high bits, like std::hash of
+ * integer IDs.
+ */
+template<class Hash>
+struct FibonacciHash {
+	Hash hash_fn;
+
+	template<class K>
+	size_t operator()(const K& k) const {
+		return (static_cast<uint64_t>(hash_fn(k)) * 0x9E3779B97F4A7C15ULL) >> 32;
+	}
+};
+
 } // namespace dsalgo
 
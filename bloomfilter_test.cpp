@@ -0,0 +1,126 @@
+#include "BloomFilter.h"
+#include "Random.h"
+#include <assert.h>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+void testNoFalseNegatives() {
+  BloomFilter test(10000);
+  assert(test.MayContain(0) == false);
+  assert(test.Insert(0) == false);
+  for (uint64_t i = 0; i < 10000; ++i) {
+    test.Insert(i * 7);
+    for (uint64_t j = 0; j <= i; j += 101) {
+      assert(test.MayContain(j * 7));
+    }
+  }
+  for (uint64_t i = 0; i < 10000; ++i) {
+    assert(test.MayContain(i * 7));
+  }
+
+  // inserting again reports the hash as present
+  for (uint64_t i = 0; i < 10000; ++i) {
+    assert(test.Insert(i * 7) == true);
+  }
+}
+
+
+void testFalsePositiveRate() {
+  for (double target : {0.1, 0.01, 0.001}) {
+    int num_keys = 100000;
+    BloomFilter test(num_keys, target);
+    for (int i = 0; i < num_keys; ++i) {
+      test.Insert(std::hash<int>()(i));
+    }
+
+    int false_positives = 0;
+    int num_lookups = 1000000;
+    for (int i = num_keys; i < num_keys + num_lookups; ++i) {
+      false_positives += test.MayContain(std::hash<int>()(i));
+    }
+    double rate = static_cast<double>(false_positives) / num_lookups;
+    assert(rate < 1.5 * target);
+  }
+}
+
+
+void testBulk() {
+  int n = 1000;
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < n; ++i) {
+    hashes.push_back(static_cast<uint64_t>(RandInt(0, 1 << 30)) << 20);
+  }
+
+  BloomFilter bulk(n);
+  BloomFilter single(n);
+  bool was_present[1000];
+  bulk.InsertMany(hashes.data(), n / 2, was_present);
+  for (int i = 0; i < n / 2; ++i) {
+    assert(was_present[i] == single.Insert(hashes[i]));
+  }
+  bulk.InsertMany(hashes.data() + n / 2, n - n / 2);
+  for (int i = n / 2; i < n; ++i) {
+    single.Insert(hashes[i]);
+  }
+
+  bool results[1000];
+  bulk.MayContainMany(hashes.data(), n, results);
+  for (int i = 0; i < n; ++i) {
+    assert(results[i]);
+  }
+  std::vector<uint64_t> others;
+  for (int i = 0; i < n; ++i) {
+    others.push_back(hashes[i] + 1);
+  }
+  bulk.MayContainMany(others.data(), n, results);
+  for (int i = 0; i < n; ++i) {
+    assert(results[i] == single.MayContain(others[i]));
+  }
+}
+
+
+void testClearCopyAndMove() {
+  BloomFilter original(1000);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    original.Insert(i);
+  }
+
+  BloomFilter copy_construct = original;
+  BloomFilter copy_assign;
+  copy_assign = original;
+  original.Clear();
+  for (uint64_t i = 0; i < 1000; ++i) {
+    assert(copy_construct.MayContain(i));
+    assert(copy_assign.MayContain(i));
+  }
+  int still_present = 0;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    still_present += original.MayContain(i);
+  }
+  assert(still_present == 0);
+
+  BloomFilter move_construct = std::move(copy_construct);
+  BloomFilter move_assign;
+  move_assign = std::move(copy_assign);
+  assert(copy_construct.SizeBytes() == 0);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    assert(move_construct.MayContain(i));
+    assert(move_assign.MayContain(i));
+  }
+  assert(move_assign.SizeBytes() == original.SizeBytes());
+}
+
+
+int main() {
+  ReseedRand();
+  testNoFalseNegatives();
+  testFalsePositiveRate();
+  testBulk();
+  testClearCopyAndMove();
+  return 0;
+}
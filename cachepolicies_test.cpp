@@ -0,0 +1,247 @@
+#include "ArcCache.h"
+#include "FrequencySketch.h"
+#include "LruCache.h"
+#include "Random.h"
+#include "SegmentedLruCache.h"
+#include "TinyLfuCache.h"
+#include <assert.h>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+
+using namespace dsalgo;
+
+
+void testFrequencySketch() {
+  FrequencySketch sketch(1000);
+  std::hash<int> hash;
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j < i % 8; ++j) {
+      sketch.Increment(hash(i));
+    }
+  }
+
+  // counts never go under, and collisions rarely push them over
+  int num_exact = 0;
+  for (int i = 0; i < 1000; ++i) {
+    assert(sketch.Frequency(hash(i)) >= i % 8);
+    num_exact += (sketch.Frequency(hash(i)) == i % 8);
+  }
+  assert(num_exact > 950);
+
+  // counters saturate at 15
+  for (int j = 0; j < 100; ++j) {
+    sketch.Increment(hash(-1));
+  }
+  assert(sketch.Frequency(hash(-1)) == 15);
+
+  sketch.Clear();
+  assert(sketch.Frequency(hash(-1)) == 0);
+  assert(sketch.Frequency(hash(7)) == 0);
+}
+
+
+void testFrequencySketchAging() {
+  // counts are halved every 10 * 100 increments
+  FrequencySketch sketch(100);
+  for (int j = 0; j < 12; ++j) {
+    sketch.Increment(1);
+  }
+  assert(sketch.Frequency(1) == 12);
+  for (int i = 0; i < 1000 - 12; ++i) {
+    sketch.Increment(1000 + i % 500);
+  }
+  assert(sketch.Frequency(1) == 6);
+}
+
+
+/**
+ * Checks that a cache maps keys like a plain hashmap would, minus evicted
+ * keys, and never holds more than its capacity.
+ */
+template<class Cache>
+void testRandomized(int capacity) {
+  Cache test(capacity);
+  std::unordered_map<int, int> last_put;
+  for (int i = 0; i < 50000; ++i) {
+    int operation = RandInt(0, 9);
+    int key = RandInt(0, 3 * capacity + 5);
+    if (operation < 4) {
+      bool cached = test.Peek(key) != nullptr;
+      assert(test.Put(key, i) == !cached);
+      last_put[key] = i;
+      assert(*test.Peek(key) == i);
+    } else if (operation < 9) {
+      int* val = test.Get(key);
+      assert(val == nullptr || *val == last_put[key]);
+    } else {
+      bool cached = test.Peek(key) != nullptr;
+      assert(test.Erase(key) == cached);
+      assert(test.Get(key) == nullptr);
+    }
+    assert(test.Size() <= test.Capacity());
+  }
+
+  test.Clear();
+  assert(test.Size() == 0);
+  for (int i = 0; i < capacity; ++i) {
+    test.Put(i, i);
+  }
+  assert(test.Size() <= capacity);
+  assert(test.Size() > 0);
+}
+
+
+/**
+ * Warms up a cache with hot keys, runs a scan of keys that are each used
+ * once through it, and returns how many hot keys are still cached.
+ */
+template<class Cache>
+int HotKeysAfterScan(int capacity, int num_hot) {
+  Cache test(capacity);
+  for (int round = 0; round < 4; ++round) {
+    for (int k = 0; k < num_hot; ++k) {
+      if (test.Get(k) == nullptr) {
+        test.Put(k, -k);
+      }
+    }
+  }
+  for (int k = num_hot; k < num_hot + 10 * capacity; ++k) {
+    if (test.Get(k) == nullptr) {
+      test.Put(k, -k);
+    }
+  }
+  int num_cached = 0;
+  for (int k = 0; k < num_hot; ++k) {
+    num_cached += (test.Peek(k) != nullptr);
+  }
+  return num_cached;
+}
+
+
+void testScanResistance() {
+  // a scan flushes an LRU cache, but not the others
+  int lru = HotKeysAfterScan<LruCache<int, int>>(100, 50);
+  int segmented = HotKeysAfterScan<SegmentedLruCache<int, int>>(100, 50);
+  int arc = HotKeysAfterScan<ArcCache<int, int>>(100, 50);
+  int tiny_lfu = HotKeysAfterScan<TinyLfuCache<int, int>>(100, 50);
+  assert(lru == 0);
+  assert(segmented == 50);
+  assert(arc == 50);
+  assert(tiny_lfu == 50);
+}
+
+
+void testSegmentedLru() {
+  SegmentedLruCache<std::string, int> test(5, 0.4);
+  test.Put("a", 1);
+  test.Put("b", 2);
+  test.Put("c", 3);
+  assert(*test.Get("a") == 1);
+  assert(*test.Get("b") == 2);
+  assert(test.ProtectedSize() == 2);
+
+  // hitting c overflows the protected segment, demoting a
+  assert(*test.Get("c") == 3);
+  assert(test.ProtectedSize() == 2);
+  test.Put("d", 4);
+  test.Put("e", 5);
+  test.Put("f", 6);
+
+  // victims come from the probationary segment: a, then d
+  assert(test.Peek("a") == nullptr);
+  assert(*test.Peek("b") == 2);
+  assert(*test.Peek("c") == 3);
+  test.Put("g", 7);
+  assert(test.Peek("d") == nullptr);
+  assert(test.Size() == 5);
+
+  // only protected entries left to evict
+  SegmentedLruCache<int, int> one(1);
+  one.Put(1, 1);
+  assert(*one.Get(1) == 1);
+  one.Put(2, 2);
+  assert(one.Get(1) == nullptr);
+  assert(*one.Get(2) == 2);
+}
+
+
+void testArc() {
+  ArcCache<int, int> test(4);
+  for (int k = 0; k < 4; ++k) {
+    test.Put(k, k);
+  }
+  test.Get(0);
+  test.Get(1);
+  assert(test.TargetRecencySize() == 0);
+
+  // T1 is over its target, so 2 and 3 become ghosts in B1
+  test.Put(4, 4);
+  test.Put(5, 5);
+  assert(test.Get(2) == nullptr);
+  assert(test.Get(3) == nullptr);
+  assert(*test.Get(0) == 0);
+
+  // putting a ghost back grows T1's target
+  assert(test.Put(2, 20));
+  assert(test.TargetRecencySize() == 1);
+  assert(*test.Get(2) == 20);
+  assert(test.Size() == 4);
+
+  // a key that's cached or a ghost is forgotten by Erase, but only a cached
+  // one counts as erased
+  assert(!test.Erase(3));
+  assert(test.Erase(2));
+  assert(test.Size() == 3);
+  assert(test.Put(3, 3));
+  assert(test.Put(6, 6));
+  assert(test.Size() == 4);
+  assert(test.TargetRecencySize() == 1);
+}
+
+
+void testTinyLfu() {
+  TinyLfuCache<int, int> test(100);
+
+  // fill the cache with keys that were each looked up once
+  for (int k = 0; k < 100; ++k) {
+    test.Get(k);
+    test.Put(k, k);
+  }
+
+  // a new key that's popular gets in, evicting one of them
+  for (int j = 0; j < 5; ++j) {
+    test.Get(1000);
+  }
+  test.Put(1000, 1000);
+  test.Put(1001, 1001);
+  assert(*test.Peek(1000) == 1000);
+  assert(test.Size() == 100);
+
+  // a key that's no more popular than the victims doesn't
+  test.Get(1002);
+  test.Put(1002, 1002);
+  test.Put(1003, 1003);
+  assert(test.Peek(1002) == nullptr);
+  assert(test.Size() == 100);
+}
+
+
+int main() {
+  ReseedRand();
+  testFrequencySketch();
+  testFrequencySketchAging();
+  testSegmentedLru();
+  testArc();
+  testTinyLfu();
+  testScanResistance();
+  for (int capacity : {1, 2, 10, 300}) {
+    testRandomized<LruCache<int, int>>(capacity);
+    testRandomized<SegmentedLruCache<int, int>>(capacity);
+    testRandomized<ArcCache<int, int>>(capacity);
+    testRandomized<TinyLfuCache<int, int>>(capacity);
+  }
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include "ClockQueue.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+void testSecondChance() {
+  ClockQueue<int> test({0, 1, 2, 3, 4});
+
+  // nothing is used yet, so elements are evicted in order, and asking again
+  // doesn't move on
+  assert(test.GetLru() == 0);
+  assert(test.GetLru() == 0);
+
+  test.MarkUsed(0);
+  test.MarkUsed(2);
+  assert(test.GetLru() == 1);
+  test.MarkUsed(1);
+
+  // 2 was used since the hand last passed it, so it gets a second chance
+  assert(test.GetLru() == 3);
+  test.MarkUsed(3);
+  assert(test.GetLru() == 4);
+  test.MarkUsed(4);
+
+  // 0's bit was cleared when the hand passed it
+  assert(test.GetLru() == 0);
+
+  // if everything was used, the hand goes all the way around
+  for (int i = 0; i < 5; ++i) {
+    test.MarkUsed(i);
+  }
+  assert(test.GetLru() == 0);
+}
+
+
+void testCycle(const std::vector<int>& elems) {
+  // marking the victim as used moves on to the next element, like LruQueue
+  ClockQueue<int> test(elems);
+  for (int i = 0; i < 5 * static_cast<int>(elems.size()) + 1; ++i) {
+    assert(test.GetLru() == elems[i % elems.size()]);
+    test.MarkUsed(test.GetLru());
+  }
+}
+
+
+void testCycle() {
+  testCycle({0});
+  testCycle({0, 1});
+  testCycle({5, 3, 1, 0, 2, 4, 6, 8, 7, 9});
+}
+
+
+void testCopyAndMove() {
+  std::vector<int> elems = {0, 1, 2, 3, 4, 5};
+  ClockQueue<int> test(elems);
+  test.MarkUsed(0);
+  test.MarkUsed(3);
+
+  // copies keep the reference bits and the hand
+  ClockQueue<int> copy(test);
+  assert(copy.GetLru() == 1);
+  copy.MarkUsed(1);
+  assert(copy.GetLru() == 2);
+  assert(test.GetLru() == 1);
+
+  test = copy;
+  assert(test.GetLru() == 2);
+  test.MarkUsed(2);
+  assert(test.GetLru() == 4);
+  assert(copy.GetLru() == 2);
+
+  ClockQueue<int> moved(std::move(copy));
+  assert(moved.GetLru() == 2);
+  ClockQueue<int> move_assigned({-1, -2});
+  move_assigned = std::move(moved);
+  move_assigned.MarkUsed(2);
+  assert(move_assigned.GetLru() == 4);
+}
+
+
+void testRandomized() {
+  // compare against a straightforward CLOCK
+  int n = 100;
+  std::vector<int> elems = RandN(0, 1000000, n);
+  for (int i = 0; i < n; ++i) {
+    elems[i] = elems[i] * n + i;
+  }
+  ClockQueue<int> test(elems);
+  std::vector<bool> refs(n, false);
+  int hand = 0;
+  for (int i = 0; i < 100000; ++i) {
+    if (RandInt(0, 3) == 0) {
+      while (refs[hand]) {
+        refs[hand] = false;
+        hand = (hand + 1) % n;
+      }
+      assert(test.GetLru() == elems[hand]);
+    } else {
+      int slot = RandInt(0, n - 1);
+      refs[slot] = true;
+      test.MarkUsed(elems[slot]);
+    }
+  }
+}
+
+
+void testMultiThreaded() {
+  std::vector<int> elems;
+  for (int i = 0; i < 1000; ++i) {
+    elems.push_back(i);
+  }
+  ClockQueue<int> test(elems);
+
+  // hits from several threads while one thread evicts
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&test, t]() {
+      for (int i = 0; i < 100000; ++i) {
+        test.MarkUsed((i * 31 + t) % 1000);
+      }
+    });
+  }
+  for (int i = 0; i < 10000; ++i) {
+    int victim = test.GetLru();
+    assert(victim >= 0 && victim < 1000);
+    test.MarkUsed(victim);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+
+int main() {
+  ReseedRand();
+  testSecondChance();
+  testCycle();
+  testCopyAndMove();
+  testRandomized();
+  testMultiThreaded();
+  return 0;
+}
@@ -0,0 +1,145 @@
+#include "ConcurrentHashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+void testPutAndGet() {
+  ConcurrentHashmap<std::string, int> test(8);
+  assert(test.NumShards() == 8);
+
+  int num_elems = 1000;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    assert(test.Size() == i + 1);
+  }
+
+  int v = 0;
+  for (int i = 0; i < num_elems; ++i) {
+    assert(test.Get(std::to_string(i), &v) == true);
+    assert(v == i);
+    assert(test.Contains(std::to_string(i)));
+  }
+
+  // a missing key leaves the output untouched
+  v = 12345;
+  assert(test.Get("-1", &v) == false);
+  assert(v == 12345);
+  assert(!test.Contains("-1"));
+
+  for (int i = 0; i < num_elems; i += 2) {
+    assert(test.Remove(std::to_string(i)) == true);
+    assert(test.Remove(std::to_string(i)) == false);
+  }
+  assert(test.Size() == num_elems / 2);
+
+  test.Clear();
+  assert(test.Size() == 0);
+  assert(!test.Contains("1"));
+}
+
+
+void testShardCounts() {
+  // shard counts get rounded up to a power of 2
+  ConcurrentHashmap<int, int> test(10);
+  assert(test.NumShards() == 16);
+  for (int i = 0; i < 16000; ++i) {
+    test.Put(i, i);
+  }
+  assert(test.Size() == 16000);
+
+  ConcurrentHashmap<int, int> single_shard(1);
+  assert(single_shard.NumShards() == 1);
+  for (int i = 0; i < 100; ++i) {
+    single_shard.Put(i, i);
+  }
+  assert(single_shard.Size() == 100);
+}
+
+
+void testRandomized() {
+  ReseedRand();
+  ConcurrentHashmap<std::string, int> test(4);
+  std::unordered_map<std::string, int> correct_map;
+  for (int i = 0; i < 5000; ++i) {
+    int operation = RandInt(0, 2);
+    if (operation < 2) {
+      std::string rand_key = RandStr(1, 3);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test.Put(rand_key, rand_val);
+    } else if (!correct_map.empty()) {
+      std::string key_to_remove = correct_map.begin()->first;
+      correct_map.erase(key_to_remove);
+      assert(test.Remove(key_to_remove) == true);
+    }
+    assert(test.Size() == static_cast<int>(correct_map.size()));
+  }
+  for (const auto& entry : correct_map) {
+    int v = 0;
+    assert(test.Get(entry.first, &v) == true);
+    assert(v == entry.second);
+  }
+}
+
+
+void testMultiThreaded() {
+  constexpr int N_THREADS = 8;
+  constexpr int N_KEYS_PER_THREAD = 20000;
+  ConcurrentHashmap<int, int> test;
+
+  // every thread writes its own range of keys while reading back the keys it
+  // has already written and the keys of other threads.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < N_THREADS; ++t) {
+    threads.emplace_back([&test, t]() {
+      int begin = t * N_KEYS_PER_THREAD;
+      for (int i = 0; i < N_KEYS_PER_THREAD; ++i) {
+        test.Put(begin + i, -(begin + i));
+        int v = 0;
+        assert(test.Get(begin + i, &v) == true);
+        assert(v == -(begin + i));
+
+        // keys owned by other threads are either missing or correct
+        int other = (begin + i + N_KEYS_PER_THREAD) %
+          (N_THREADS * N_KEYS_PER_THREAD);
+        if (test.Get(other, &v)) {
+          assert(v == -other);
+        }
+      }
+
+      // remove every other key
+      for (int i = 0; i < N_KEYS_PER_THREAD; i += 2) {
+        assert(test.Remove(begin + i) == true);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  assert(test.Size() == N_THREADS * N_KEYS_PER_THREAD / 2);
+  for (int i = 0; i < N_THREADS * N_KEYS_PER_THREAD; ++i) {
+    int v = 0;
+    assert(test.Get(i, &v) == (i % 2 == 1));
+    if (i % 2 == 1) {
+      assert(v == -i);
+    }
+  }
+}
+
+
+int main() {
+  testPutAndGet();
+  testShardCounts();
+  testRandomized();
+  testMultiThreaded();
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "ConcurrentLruCache.h"
+#include "LruCache.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+void testPutAndGet() {
+  ConcurrentLruCache<std::string, int> test(3, 1);
+  assert(test.NumShards() == 1);
+  assert(test.Capacity() == 3);
+  assert(test.Put("a", 1));
+  assert(test.Put("b", 2));
+  assert(test.Put("c", 3));
+
+  // hitting a makes b the next to be evicted
+  int v = 0;
+  assert(test.Get("a", &v));
+  assert(v == 1);
+  assert(test.Put("d", 4));
+  assert(test.Size() == 3);
+  assert(!test.Get("b", &v));
+  assert(v == 1);
+
+  assert(!test.Put("c", 5));
+  assert(test.Get("c", &v));
+  assert(v == 5);
+  assert(test.Erase("c"));
+  assert(!test.Erase("c"));
+  assert(test.Size() == 2);
+
+  test.Clear();
+  assert(test.Size() == 0);
+  assert(!test.Get("a", &v));
+  assert(test.Put("a", 6));
+  assert(test.Get("a", &v));
+  assert(v == 6);
+}
+
+
+void testShardCounts() {
+  // capacity is split evenly across the shards, rounding up
+  ConcurrentLruCache<int, int> test(1000, 10);
+  assert(test.NumShards() == 16);
+  assert(test.Capacity() == 16 * 63);
+  for (int i = 0; i < 100000; ++i) {
+    test.Put(i, i);
+  }
+  assert(test.Size() <= test.Capacity());
+  assert(test.Size() > test.Capacity() / 2);
+}
+
+
+void testMatchesLruCache() {
+  // with a single shard and thread, every hit is replayed before the next
+  // eviction, so the cache is exactly LRU
+  for (int capacity : {1, 7, 200}) {
+    ConcurrentLruCache<int, int> test(capacity, 1);
+    LruCache<int, int> correct(capacity);
+    for (int i = 0; i < 50000; ++i) {
+      int operation = RandInt(0, 9);
+      int key = RandInt(0, 2 * capacity + 5);
+      if (operation < 4) {
+        assert(test.Put(key, i) == correct.Put(key, i));
+      } else if (operation < 9) {
+        int v = -1;
+        int* expected = correct.Get(key);
+        assert(test.Get(key, &v) == (expected != nullptr));
+        assert(expected == nullptr || v == *expected);
+      } else {
+        assert(test.Erase(key) == correct.Erase(key));
+      }
+      assert(test.Size() == correct.Size());
+    }
+  }
+}
+
+
+void testMultiThreaded() {
+  ConcurrentLruCache<int, int> test(2000, 8);
+  int num_threads = 4;
+  int num_keys = 5000;
+
+  // every key is only ever mapped to its negation, so any hit must see it
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&test, t, num_keys]() {
+      for (int i = 0; i < 100000; ++i) {
+        int key = (i * 7919 + t * 104729) % num_keys;
+        if (i % 4 == 0) {
+          test.Put(key, -key);
+        } else if (i % 97 == 0) {
+          test.Erase(key);
+        } else {
+          int v = 1;
+          if (test.Get(key, &v)) {
+            assert(v == -key);
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  assert(test.Size() <= test.Capacity());
+
+  // the shards are still consistent after the concurrent hits
+  for (int key = 0; key < num_keys; ++key) {
+    test.Put(key, -key);
+  }
+  assert(test.Size() == test.Capacity());
+  int hits = 0;
+  for (int key = 0; key < num_keys; ++key) {
+    int v = 1;
+    if (test.Get(key, &v)) {
+      assert(v == -key);
+      ++hits;
+    }
+  }
+  assert(hits == test.Capacity());
+}
+
+
+int main() {
+  ReseedRand();
+  testPutAndGet();
+  testShardCounts();
+  testMatchesLruCache();
+  testMultiThreaded();
+  return 0;
+}
@@ -0,0 +1,275 @@
+#include "CuckooHashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+
+using namespace dsalgo;
+
+
+void testPutAndGet() {
+
+  // test hashmap with full load factor
+  CuckooHashmap<std::string, int> test(8, 1.0);
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    assert(test.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test.Get(std::to_string(j)) == j);
+      assert(test[std::to_string(j)] == j);
+    }
+  }
+
+  // test hashmap with recommended load factor
+  CuckooHashmap<std::string, int> test_rec_lf;
+  for (int i = 0; i < num_elems; ++i) {
+    test_rec_lf.Put(std::to_string(i), i);
+    assert(test_rec_lf.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test_rec_lf.Get(std::to_string(j)) == j);
+    }
+  }
+
+  // test hashmap with very small load factor
+  CuckooHashmap<std::string, int> test_small_lf(8, 0.001);
+  for (int i = 0; i < num_elems; ++i) {
+    test_small_lf.Put(std::to_string(i), i);
+    assert(test_small_lf.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test_small_lf.Get(std::to_string(j)) == j);
+    }
+  }
+}
+
+
+void testRemoveAndGet() {
+  CuckooHashmap<std::string, int> test;
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    if (i % 16 == 0) {
+      for (int j = 0; j < i; ++j) {
+        assert(test.Remove(std::to_string(j)) == true);
+      }
+      for (int j = 0; j < i; ++j) {
+        test.Put(std::to_string(j), j);
+      }
+    }
+    assert(test.Size() == i + 1);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*test.Get(std::to_string(i)) == i);
+  }
+  for (int i = -1000; i < -500; ++i) {
+    assert(test.Get(std::to_string(i)) == nullptr);
+    assert(test.Remove(std::to_string(i)) == false);
+  }
+}
+
+
+/**
+ * Hashes 4 consecutive integers to the same hash code, so they fill up
+ * whole buckets.
+ */
+struct GroupOf4Hash {
+  size_t operator()(int k) const {
+    return k / 4;
+  }
+};
+
+
+/**
+ * Hashes every key to the same hash code.
+ */
+struct ConstantHash {
+  size_t operator()(int k) const {
+    return 0;
+  }
+};
+
+
+void testFullBuckets() {
+  // keys arrive a bucketful at a time and the table is allowed to fill up,
+  // so many inserts have to move entries to their alternate buckets
+  CuckooHashmap<int, int, GroupOf4Hash> test(8, 1.0);
+  int num_elems = 8000;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(i, i);
+    assert(test.Size() == i + 1);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*test.Get(i) == i);
+  }
+  for (int i = 0; i < num_elems; i += 2) {
+    assert(test.Remove(i) == true);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert((test.Get(i) != nullptr) == (i % 2 == 1));
+  }
+
+  // 8 keys with the same hash code fit, but a 9th can never fit
+  CuckooHashmap<int, int, ConstantHash> test_constant;
+  for (int i = 0; i < 8; ++i) {
+    test_constant.Put(i, i);
+  }
+  bool threw = false;
+  try {
+    test_constant.Put(8, 8);
+  } catch (const std::length_error& e) {
+    threw = true;
+  }
+  assert(threw);
+  assert(test_constant.Size() == 8);
+  for (int i = 0; i < 8; ++i) {
+    assert(*test_constant.Get(i) == i);
+  }
+}
+
+
+void testStructuredKeys() {
+  // keys that share a hash code if the hash's halves are just XORed
+  // together
+  CuckooHashmap<int64_t, int64_t> test;
+  int num_elems = 5000;
+  for (int64_t x = 0; x < num_elems; ++x) {
+    test.Put(x * ((1LL << 32) + 1), x);
+  }
+  assert(test.Size() == num_elems);
+  for (int64_t x = 0; x < num_elems; ++x) {
+    assert(*test.Get(x * ((1LL << 32) + 1)) == x);
+    assert(test.Get(x << 32) == nullptr || x == 0);
+  }
+
+  // and keys that only differ in their high bits
+  CuckooHashmap<int64_t, int64_t> high_bits;
+  for (int64_t x = 0; x < num_elems; ++x) {
+    high_bits.Put(x << 40, x);
+  }
+  for (int64_t x = 0; x < num_elems; ++x) {
+    assert(*high_bits.Get(x << 40) == x);
+  }
+}
+
+
+void testClear() {
+  CuckooHashmap<std::string, int> test;
+  for (int i = 0; i < 110; ++i) {
+    test[std::to_string(i)] = i;
+    if (i % 16 == 0) {
+      test.Clear();
+    }
+  }
+
+  // only 97-109 should be in the map
+  assert(test.Size() == 13);
+  for (int i = 97; i < 110; ++i) {
+    assert(test[std::to_string(i)] == i);
+  }
+  for (int i = 0; i < 97; ++i) {
+    assert(test.Get(std::to_string(i)) == nullptr);
+  }
+}
+
+
+void testCopyAndMove() {
+  CuckooHashmap<std::string, int> original;
+  int num_elems = 456;
+  for (int i = 0; i < num_elems; ++i) {
+    original.Put(std::to_string(i), i);
+  }
+
+  CuckooHashmap<std::string, int> copy_construct = original;
+  CuckooHashmap<std::string, int> copy_assign;
+  copy_assign["-1"] = -1;
+  copy_assign = original;
+  for (int i = 0; i < 300; ++i) {
+    original.Remove(std::to_string(i));
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*copy_construct.Get(std::to_string(i)) == i);
+    assert(*copy_assign.Get(std::to_string(i)) == i);
+  }
+  assert(copy_assign.Get("-1") == nullptr);
+
+  CuckooHashmap<std::string, int> move_construct = std::move(copy_construct);
+  CuckooHashmap<std::string, int> move_assign;
+  move_assign["-1"] = -1;
+  move_assign = std::move(copy_assign);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*move_construct.Get(std::to_string(i)) == i);
+    assert(*move_assign.Get(std::to_string(i)) == i);
+  }
+  assert(move_assign.Get("-1") == nullptr);
+}
+
+
+void testRandomized(CuckooHashmap<std::string, int>& test_map, int num_ops) {
+  std::unordered_map<std::string, int> correct_map;
+
+  for (int i = 0; i < num_ops; ++i) {
+    int operation = RandInt(0, 75);
+
+    // insert via Put
+    if (0 <= operation && operation < 25) {
+      std::string rand_key = RandStr(5, 10);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map.Put(rand_key, rand_val);
+
+    // insert via operator[]
+    } else if (25 <= operation && operation < 50) {
+      std::string rand_key = RandStr(5, 10);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map[rand_key] = rand_val;
+
+    // remove a key
+    } else if (50 <= operation && operation < 75) {
+      if (!correct_map.empty()) {
+        std::string key_to_remove = correct_map.begin()->first;
+        correct_map.erase(key_to_remove);
+        assert(test_map.Remove(key_to_remove) == true);
+      }
+    }
+
+    assert(test_map.Size() == static_cast<int>(correct_map.size()));
+    for (const auto& entry : correct_map) {
+      assert(*test_map.Get(entry.first) == entry.second);
+    }
+  }
+}
+
+
+void testRandomized() {
+  ReseedRand();
+
+  // use recommended load factor
+  CuckooHashmap<std::string, int> test;
+  testRandomized(test, 5000);
+
+  // use high load factor
+  test = CuckooHashmap<std::string, int>(8, 1);
+  testRandomized(test, 1000);
+
+  // use small load factor
+  test = CuckooHashmap<std::string, int>(8, 0.01);
+  testRandomized(test, 5000);
+}
+
+
+int main() {
+  testPutAndGet();
+  testRemoveAndGet();
+  testFullBuckets();
+  testStructuredKeys();
+  testClear();
+  testCopyAndMove();
+  testRandomized();
+  return 0;
+}
@@ -0,0 +1,250 @@
+#include "DenseHashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+void testPutAndGet() {
+
+  // test hashmap with full load factor
+  DenseHashmap<std::string, int> test(8, 1.0);
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    assert(test.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test.Get(std::to_string(j)) == j);
+      assert(test[std::to_string(j)] == j);
+    }
+  }
+
+  // test hashmap with very small load factor
+  DenseHashmap<std::string, int> test_small_lf(8, 0.001);
+  for (int i = 0; i < num_elems; ++i) {
+    test_small_lf.Put(std::to_string(i), i);
+    assert(test_small_lf.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test_small_lf.Get(std::to_string(j)) == j);
+    }
+  }
+}
+
+
+void testRemoveAndGet() {
+  DenseHashmap<std::string, int> test;
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    if (i % 16 == 0) {
+      for (int j = 0; j < i; ++j) {
+        assert(test.Remove(std::to_string(j)) == true);
+      }
+      for (int j = 0; j < i; ++j) {
+        test.Put(std::to_string(j), j);
+      }
+    }
+    assert(test.Size() == i + 1);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*test.Get(std::to_string(i)) == i);
+  }
+  for (int i = -1000; i < -500; ++i) {
+    assert(test.Get(std::to_string(i)) == nullptr);
+    assert(test.Remove(std::to_string(i)) == false);
+  }
+}
+
+
+/**
+ * @return keys of the hashmap in iteration order
+ */
+std::vector<int> IterationOrder(const DenseHashmap<int, int>& test) {
+  std::vector<int> keys;
+  for (const DenseHashmap<int, int>::Entry& entry : test) {
+    assert(entry.value() == -entry.key());
+    keys.push_back(entry.key());
+  }
+
+  // ForEach visits the same entries in the same order
+  std::vector<int> for_each_keys;
+  test.ForEach([&](int k, int v) {
+    for_each_keys.push_back(k);
+  });
+  assert(keys == for_each_keys);
+  return keys;
+}
+
+
+void testInsertionOrder() {
+  DenseHashmap<int, int> test;
+  std::vector<int> expected;
+  for (int i = 0; i < 1000; ++i) {
+    int k = RandInt(-1000000, 1000000);
+    if (test.Get(k) == nullptr) {
+      expected.push_back(k);
+    }
+    test.Put(k, -k);
+  }
+  assert(IterationOrder(test) == expected);
+
+  // overwriting doesn't move an entry
+  test.Put(expected[0], -expected[0]);
+  assert(IterationOrder(test) == expected);
+
+  // removing keeps the order of the others, through however many compactions
+  for (int i = 0; i < static_cast<int>(expected.size()); ++i) {
+    if (i % 3 != 0) {
+      assert(test.Remove(expected[i]));
+    }
+  }
+  std::vector<int> remaining;
+  for (int i = 0; i < static_cast<int>(expected.size()); i += 3) {
+    remaining.push_back(expected[i]);
+  }
+  assert(IterationOrder(test) == remaining);
+
+  // re-inserting a removed key puts it at the end
+  test.Put(expected[1], -expected[1]);
+  remaining.push_back(expected[1]);
+  assert(IterationOrder(test) == remaining);
+
+  // values can be modified through iterators
+  for (DenseHashmap<int, int>::Entry& entry : test) {
+    entry.value() = entry.key() * 2;
+  }
+  for (int k : remaining) {
+    assert(*test.Get(k) == k * 2);
+  }
+}
+
+
+void testClear() {
+  DenseHashmap<std::string, int> test;
+  for (int i = 0; i < 110; ++i) {
+    test[std::to_string(i)] = i;
+    if (i % 16 == 0) {
+      test.Clear();
+    }
+  }
+
+  // only 97-109 should be in the map
+  assert(test.Size() == 13);
+  for (int i = 97; i < 110; ++i) {
+    assert(test[std::to_string(i)] == i);
+  }
+  for (int i = 0; i < 97; ++i) {
+    assert(test.Get(std::to_string(i)) == nullptr);
+  }
+  assert(test.begin()->key() == "97");
+}
+
+
+void testCopyAndMove() {
+  DenseHashmap<std::string, int> original;
+  int num_elems = 456;
+  for (int i = 0; i < num_elems; ++i) {
+    original.Put(std::to_string(i), i);
+  }
+
+  DenseHashmap<std::string, int> copy_construct = original;
+  DenseHashmap<std::string, int> copy_assign;
+  copy_assign["-1"] = -1;
+  copy_assign = original;
+  for (int i = 0; i < 300; ++i) {
+    original.Remove(std::to_string(i));
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*copy_construct.Get(std::to_string(i)) == i);
+    assert(*copy_assign.Get(std::to_string(i)) == i);
+  }
+  assert(copy_assign.Get("-1") == nullptr);
+
+  DenseHashmap<std::string, int> move_construct = std::move(copy_construct);
+  DenseHashmap<std::string, int> move_assign;
+  move_assign["-1"] = -1;
+  move_assign = std::move(copy_assign);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*move_construct.Get(std::to_string(i)) == i);
+    assert(*move_assign.Get(std::to_string(i)) == i);
+  }
+  assert(move_assign.Get("-1") == nullptr);
+}
+
+
+void testRandomized(DenseHashmap<std::string, int>& test_map, int num_ops) {
+  std::unordered_map<std::string, int> correct_map;
+
+  for (int i = 0; i < num_ops; ++i) {
+    int operation = RandInt(0, 75);
+
+    // insert via Put
+    if (0 <= operation && operation < 25) {
+      std::string rand_key = RandStr(5, 10);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map.Put(rand_key, rand_val);
+
+    // insert via operator[]
+    } else if (25 <= operation && operation < 50) {
+      std::string rand_key = RandStr(5, 10);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map[rand_key] = rand_val;
+
+    // remove a key
+    } else if (50 <= operation && operation < 75) {
+      if (!correct_map.empty()) {
+        std::string key_to_remove = correct_map.begin()->first;
+        correct_map.erase(key_to_remove);
+        assert(test_map.Remove(key_to_remove) == true);
+      }
+    }
+
+    assert(test_map.Size() == static_cast<int>(correct_map.size()));
+    for (const auto& entry : correct_map) {
+      assert(*test_map.Get(entry.first) == entry.second);
+    }
+    int num_iterated = 0;
+    for (const auto& entry : test_map) {
+      assert(correct_map.at(entry.key()) == entry.value());
+      ++num_iterated;
+    }
+    assert(num_iterated == test_map.Size());
+  }
+}
+
+
+void testRandomized() {
+  ReseedRand();
+
+  // use recommended load factor
+  DenseHashmap<std::string, int> test;
+  testRandomized(test, 5000);
+
+  // use high load factor
+  test = DenseHashmap<std::string, int>(8, 1);
+  testRandomized(test, 1000);
+
+  // use small load factor
+  test = DenseHashmap<std::string, int>(8, 0.01);
+  testRandomized(test, 5000);
+}
+
+
+int main() {
+  testPutAndGet();
+  testRemoveAndGet();
+  testInsertionOrder();
+  testClear();
+  testCopyAndMove();
+  testRandomized();
+  return 0;
+}
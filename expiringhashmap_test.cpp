@@ -0,0 +1,219 @@
+#include "ExpiringHashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+/**
+ * Advances the map until the wheel has caught up with now.
+ */
+template<class Map>
+void AdvanceFully(Map& test, int64_t now) {
+  while (!test.Advance(now, 1000)) {}
+}
+
+
+void testPutAndGet() {
+  ExpiringHashmap<std::string, int> test;
+  test.Put("a", 1, 10);
+  test.Put("b", 2, 20);
+  test.Put("c", 3, 0);
+  assert(*test.Get("a") == 1);
+  assert(*test.Get("b") == 2);
+  assert(test.Get("c") == nullptr);
+  assert(test.Get("d") == nullptr);
+  assert(test.GetDeadline("a") == 10);
+  assert(test.GetDeadline("d") == -1);
+  assert(test.Size() == 2);
+
+  assert(test.Advance(9));
+  assert(test.Now() == 9);
+  assert(*test.Get("a") == 1);
+  assert(test.Size() == 2);
+
+  // reclaimed by the wheel
+  assert(test.Advance(10));
+  assert(test.Size() == 1);
+  assert(test.Get("a") == nullptr);
+  assert(*test.Get("b") == 2);
+
+  // putting an existing key replaces its value and deadline
+  test.Put("b", 4, 5);
+  assert(test.GetDeadline("b") == 15);
+  assert(test.Advance(14));
+  assert(*test.Get("b") == 4);
+  assert(test.Advance(15));
+  assert(test.Size() == 0);
+
+  // time doesn't go backwards
+  assert(test.Advance(3));
+  assert(test.Now() == 15);
+}
+
+
+void testLazyExpiry() {
+  ExpiringHashmap<int, int> test;
+  for (int i = 0; i < 100; ++i) {
+    test.Put(i, i, i + 1);
+  }
+
+  // no background work, so expired entries are only reclaimed on access
+  assert(!test.Advance(50, 0));
+  assert(test.Size() == 100);
+  assert(test.GetDeadline(10) == -1);
+  assert(test.GetDeadline(50) == 51);
+  assert(test.Get(10) == nullptr);
+  assert(test.Size() == 99);
+  assert(test.Remove(20) == false);
+  assert(test.Size() == 98);
+  assert(test.Remove(60) == true);
+  assert(test.Size() == 97);
+  for (int i = 0; i < 100; ++i) {
+    assert((test.Get(i) != nullptr) == (i >= 50 && i != 60));
+  }
+  assert(test.Size() == 49);
+
+  // the wheel catches up later, with bounded work per call
+  AdvanceFully(test, 90);
+  assert(test.Size() == 10);
+}
+
+
+void testRemoveAndClear() {
+  ExpiringHashmap<int, int> test(1000);
+  for (int i = 0; i < 100; ++i) {
+    test.Put(i, -i, 100);
+  }
+  for (int i = 0; i < 100; i += 2) {
+    assert(test.Remove(i));
+    assert(!test.Remove(i));
+  }
+  assert(test.Size() == 50);
+  AdvanceFully(test, 1099);
+  assert(test.Size() == 50);
+  AdvanceFully(test, 1100);
+  assert(test.Size() == 0);
+
+  for (int i = 0; i < 100; ++i) {
+    test.Put(i, i, 100);
+  }
+  test.Clear();
+  assert(test.Size() == 0);
+  assert(test.Get(1) == nullptr);
+  test.Put(1, 1, 1);
+  assert(*test.Get(1) == 1);
+  AdvanceFully(test, 1101);
+  assert(test.Size() == 0);
+}
+
+
+void testFarDeadlines() {
+  ExpiringHashmap<int, int> test;
+  test.Put(1, 1, 1LL << 40);
+  test.Put(2, 2, 100000);
+  test.Put(3, 3, 5000);
+  AdvanceFully(test, 1 << 20);
+  assert(test.Size() == 1);
+  assert(*test.Get(1) == 1);
+  assert(test.GetDeadline(1) == 1LL << 40);
+
+  // an empty map skips straight to the current time
+  test.Remove(1);
+  assert(test.Advance(1LL << 50, 1));
+  test.Put(4, 4, 70);
+  AdvanceFully(test, (1LL << 50) + 69);
+  assert(test.Size() == 1);
+  AdvanceFully(test, (1LL << 50) + 70);
+  assert(test.Size() == 0);
+}
+
+
+void testSparseAdvance() {
+  // a millisecond clock advanced once a second, with 100 puts a second
+  // that live for 5 seconds and are never read again. The wheel keeps up,
+  // although each call skips 1000 ticks.
+  ExpiringHashmap<int, int> test;
+  int key = 0;
+  for (int64_t second = 1; second <= 2000; ++second) {
+    test.Advance(second * 1000);
+    for (int i = 0; i < 100; ++i) {
+      test.Put(key++, 0, 5000);
+    }
+    assert(test.Size() <= 600);
+  }
+}
+
+
+void testRandomized() {
+  ReseedRand();
+  ExpiringHashmap<int, int> test;
+  std::unordered_map<int, std::pair<int, int64_t>> correct_map;
+  int64_t now = 0;
+  for (int i = 0; i < 20000; ++i) {
+    int operation = RandInt(0, 99);
+    int key = RandInt(0, 2000);
+    if (operation < 50) {
+      // ttls across the first few levels of the wheel
+      int64_t ttl = RandInt(0, 3) == 0 ? RandInt(0, 300000) : RandInt(0, 200);
+      test.Put(key, i, ttl);
+      correct_map[key] = std::make_pair(i, now + ttl);
+    } else if (operation < 70) {
+      auto it = correct_map.find(key);
+      bool live = it != correct_map.end() && it->second.second > now;
+      assert(test.Remove(key) == live);
+      if (it != correct_map.end()) {
+        correct_map.erase(it);
+      }
+    } else if (operation < 90) {
+      auto it = correct_map.find(key);
+      int* val = test.Get(key);
+      if (it != correct_map.end() && it->second.second > now) {
+        assert(*val == it->second.first);
+      } else {
+        assert(val == nullptr);
+      }
+    } else {
+      now += RandInt(0, 3) == 0 ? RandInt(0, 5000) : RandInt(0, 10);
+      AdvanceFully(test, now);
+      for (auto it = correct_map.begin(); it != correct_map.end();) {
+        if (it->second.second <= now) {
+          it = correct_map.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      assert(test.Size() == static_cast<int>(correct_map.size()));
+    }
+  }
+
+  // copies and moves keep every entry and deadline
+  ExpiringHashmap<int, int> copy = test;
+  ExpiringHashmap<int, int> moved = std::move(test);
+  for (const auto& entry : correct_map) {
+    if (entry.second.second > now) {
+      assert(*copy.Get(entry.first) == entry.second.first);
+      assert(moved.GetDeadline(entry.first) == entry.second.second);
+    }
+  }
+  AdvanceFully(copy, now + 400000);
+  AdvanceFully(moved, now + 400000);
+  assert(copy.Size() == 0);
+  assert(moved.Size() == 0);
+}
+
+
+int main() {
+  testPutAndGet();
+  testLazyExpiry();
+  testRemoveAndClear();
+  testFarDeadlines();
+  testSparseAdvance();
+  testRandomized();
+  return 0;
+}
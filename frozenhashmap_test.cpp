@@ -0,0 +1,215 @@
+#include "FrozenHashmap.h"
+#include "Hashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+void testBuildFromEntries() {
+  for (int num_elems : {0, 1, 2, 3, 5, 17, 128, 1000, 100000}) {
+    std::vector<std::pair<std::string, int>> entries;
+    for (int i = 0; i < num_elems; ++i) {
+      entries.push_back({std::to_string(i), i});
+    }
+    FrozenHashmap<std::string, int> test(entries);
+    assert(test.Size() == num_elems);
+    for (int i = 0; i < num_elems; ++i) {
+      assert(*test.Get(std::to_string(i)) == i);
+    }
+    for (int i = -1000; i < 0; ++i) {
+      assert(test.Get(std::to_string(i)) == nullptr);
+    }
+  }
+
+  FrozenHashmap<std::string, int> empty;
+  assert(empty.Size() == 0);
+  assert(empty.Get("0") == nullptr);
+}
+
+
+void testBuildFromHashmap() {
+  Hashmap<int, std::string> original;
+  int num_elems = 5000;
+  for (int i = 0; i < num_elems; ++i) {
+    original.Put(i * 7, std::to_string(i));
+  }
+  FrozenHashmap<int, std::string> test(original);
+  assert(test.Size() == num_elems);
+  for (int i = 0; i < num_elems * 7; ++i) {
+    if (i % 7 == 0) {
+      assert(*test.Get(i) == std::to_string(i / 7));
+    } else {
+      assert(test.Get(i) == nullptr);
+    }
+  }
+
+  // every slot is used exactly once
+  int count = 0;
+  test.ForEach([&](int k, const std::string& v) {
+    assert(*original.Get(k) == v);
+    ++count;
+  });
+  assert(count == num_elems);
+}
+
+
+/**
+ * Hashes every key to the same hash code.
+ */
+struct ConstantHash {
+  size_t operator()(int k) const {
+    return 0;
+  }
+};
+
+
+void testInvalidEntries() {
+  std::vector<std::pair<int, int>> duplicates = {{1, 1}, {2, 2}, {1, 3}};
+  bool threw = false;
+  try {
+    FrozenHashmap<int, int> test(duplicates);
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+
+  std::vector<std::pair<int, int>> collisions = {{1, 1}, {2, 2}};
+  threw = false;
+  try {
+    FrozenHashmap<int, int, ConstantHash> test(collisions);
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+
+void testSerialize() {
+  std::vector<std::pair<int64_t, double>> entries;
+  int num_elems = 10000;
+  for (int i = 0; i < num_elems; ++i) {
+    entries.push_back({static_cast<int64_t>(i) << 33, i / 2.0});
+  }
+  FrozenHashmap<int64_t, double> original(entries);
+  std::vector<char> buf = original.Serialize();
+
+  // read back from an unaligned copy of the buffer
+  std::vector<char> unaligned(buf.size() + 1);
+  std::copy(buf.begin(), buf.end(), unaligned.begin() + 1);
+  FrozenHashmap<int64_t, double> test =
+    FrozenHashmap<int64_t, double>::Deserialize(unaligned.data() + 1,
+        buf.size());
+  assert(test.Size() == num_elems);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*test.Get(static_cast<int64_t>(i) << 33) == i / 2.0);
+    assert(test.Get((static_cast<int64_t>(i) << 33) + 1) == nullptr);
+  }
+
+  // wrong types and truncated buffers are rejected
+  bool threw = false;
+  try {
+    FrozenHashmap<int64_t, int>::Deserialize(buf.data(), buf.size());
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+  threw = false;
+  try {
+    FrozenHashmap<int64_t, double>::Deserialize(buf.data(), buf.size() - 1);
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+
+  // so are seeds pointing past the last slot
+  std::vector<char> corrupted = buf;
+  int32_t bad_seed = -(num_elems + 1);
+  std::memcpy(corrupted.data() + sizeof(FrozenHashmapHeader), &bad_seed,
+      sizeof(bad_seed));
+  threw = false;
+  try {
+    FrozenHashmap<int64_t, double>::Deserialize(corrupted.data(),
+        corrupted.size());
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+
+  // empty maps round trip too
+  FrozenHashmap<int64_t, double> empty;
+  std::vector<char> empty_buf = empty.Serialize();
+  assert((FrozenHashmap<int64_t, double>::Deserialize(empty_buf.data(),
+          empty_buf.size()).Size() == 0));
+}
+
+
+void testCopyAndMove() {
+  std::vector<std::pair<std::string, int>> entries;
+  int num_elems = 456;
+  for (int i = 0; i < num_elems; ++i) {
+    entries.push_back({std::to_string(i), i});
+  }
+  FrozenHashmap<std::string, int> original(entries);
+
+  FrozenHashmap<std::string, int> copy_construct = original;
+  FrozenHashmap<std::string, int> copy_assign;
+  copy_assign = original;
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*copy_construct.Get(std::to_string(i)) == i);
+    assert(*copy_assign.Get(std::to_string(i)) == i);
+  }
+
+  FrozenHashmap<std::string, int> move_construct = std::move(copy_construct);
+  FrozenHashmap<std::string, int> move_assign;
+  move_assign = std::move(copy_assign);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*move_construct.Get(std::to_string(i)) == i);
+    assert(*move_assign.Get(std::to_string(i)) == i);
+  }
+}
+
+
+void testRandomized() {
+  ReseedRand();
+
+  for (int run = 0; run < 20; ++run) {
+    std::unordered_map<std::string, int> correct_map;
+    int num_elems = RandInt(0, 2000);
+    for (int i = 0; i < num_elems; ++i) {
+      correct_map[RandStr(1, 10)] = RandInt(-100000, 100000);
+    }
+    std::vector<std::pair<std::string, int>> entries(correct_map.begin(),
+        correct_map.end());
+    FrozenHashmap<std::string, int> test(entries);
+
+    assert(test.Size() == static_cast<int>(correct_map.size()));
+    for (const auto& entry : correct_map) {
+      assert(*test.Get(entry.first) == entry.second);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      std::string k = RandStr(1, 10);
+      const int* v = test.Get(k);
+      assert((v != nullptr) == (correct_map.count(k) > 0));
+    }
+  }
+}
+
+
+int main() {
+  testBuildFromEntries();
+  testBuildFromHashmap();
+  testInvalidEntries();
+  testSerialize();
+  testCopyAndMove();
+  testRandomized();
+  return 0;
+}
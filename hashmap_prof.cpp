@@ -1,8 +1,24 @@
+#include "ConcurrentHashmap.h"
+#include "CuckooHashmap.h"
+#include "DenseHashmap.h"
+#include "ExpiringHashmap.h"
+#include "FrozenHashmap.h"
+#include "HashSet.h"
 #include "Hashmap.h"
+#include "MappedHashmap.h"
 #include "Profiling.h"
 #include "Random.h"
+#include "RobinHoodHashmap.h"
+#include "SeededHash.h"
+#include "StringRef.h"
+#include "StringArena.h"
+#include "SwissHashmap.h"
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
 #include <unordered_map>
+#include <unordered_set>
 
 
 using namespace dsalgo;
@@ -26,6 +42,18 @@ void ProfilePut(int num_inserts, int num_runs) {
   std::cout << "dsalgo Hashmap" << std::endl;
   PrintStats(stop - start, num_runs * num_inserts, "\t");
 
+  SwissHashmap<std::string, std::string> test_swiss;
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::string& e : rand_elems) {
+      test_swiss.Put(e, e);
+    }
+    test_swiss.Clear();
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo SwissHashmap" << std::endl;
+  PrintStats(stop - start, num_runs * num_inserts, "\t");
+
   std::unordered_map<std::string, std::string> test_std;
   start = Clock::Now();
   for (int i = 0; i < num_runs; ++i) {
@@ -62,6 +90,8 @@ void ProfileGet(int num_gets, int num_runs) {
   int64_t stop = 0;
 
   Hashmap<std::string, std::string> test;
+  SwissHashmap<std::string, std::string> test_swiss;
+  DenseHashmap<std::string, std::string> test_dense;
   std::unordered_map<std::string, std::string> test_std;
   for (int i = 0; i < static_cast<int>(rand_elems.size()) / 2; ++i) {
     // insert some, and leave out others so that we profile both getting
@@ -69,6 +99,8 @@ void ProfileGet(int num_gets, int num_runs) {
     bool should_insert = (RandInt(0, 1) == 0);
     if (should_insert) {
       test.Put(rand_elems[i], rand_elems[i]);
+      test_swiss.Put(rand_elems[i], rand_elems[i]);
+      test_dense.Put(rand_elems[i], rand_elems[i]);
       test_std.insert({rand_elems[i], rand_elems[i]});
     }
   }
@@ -83,6 +115,26 @@ void ProfileGet(int num_gets, int num_runs) {
   std::cout  << "dsalgo Hashmap" << std::endl;
   PrintStats(stop - start, num_runs * num_gets, "\t");
 
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int j = 0; j < num_gets; ++j) {
+      test_swiss.Get(rand_elems[j]);
+    }
+  }
+  stop = Clock::Now();
+  std::cout  << "dsalgo SwissHashmap" << std::endl;
+  PrintStats(stop - start, num_runs * num_gets, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int j = 0; j < num_gets; ++j) {
+      test_dense.Get(rand_elems[j]);
+    }
+  }
+  stop = Clock::Now();
+  std::cout  << "dsalgo DenseHashmap" << std::endl;
+  PrintStats(stop - start, num_runs * num_gets, "\t");
+
   start = Clock::Now();
   for (int i = 0; i < num_runs; ++i) {
     for (int j = 0; j < num_gets; ++j) {
@@ -110,6 +162,816 @@ void ProfileGetVariousSizes() {
 }
 
 
+/**
+ * Profiles looking up keys that are substrings of a larger buffer (like tokens
+ * of a parsed request). Compares building a temporary std::string for each
+ * lookup against looking up a StringRef with a transparent hash.
+ */
+void ProfileGetFromBuffer(int num_keys, int num_runs) {
+  std::vector<std::string> rand_elems = RandStrs(8, 16, num_keys);
+  std::string buf;
+  std::vector<std::pair<int, int>> token_bounds;
+  for (const std::string& e : rand_elems) {
+    token_bounds.push_back({static_cast<int>(buf.size()),
+        static_cast<int>(e.size())});
+    buf += e;
+  }
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  Hashmap<std::string, int, StrHash, StrEq> test;
+  for (int i = 0; i < num_keys; i += 2) {
+    test.Put(rand_elems[i], i);
+  }
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::pair<int, int>& bounds : token_bounds) {
+      DoNotOptimize(test.Get(buf.substr(bounds.first, bounds.second)));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap std::string lookup" << std::endl;
+  PrintStats(stop - start, num_runs * num_keys, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::pair<int, int>& bounds : token_bounds) {
+      DoNotOptimize(test.Get(
+            StringRef(buf.data() + bounds.first, bounds.second)));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap StringRef lookup" << std::endl;
+  PrintStats(stop - start, num_runs * num_keys, "\t");
+}
+
+
+/**
+ * Profiles repeatedly building and clearing a map keyed by tokens of a
+ * buffer, with std::string keys that are allocated one by one against keys
+ * interned into a StringArena that is freed at once.
+ */
+void ProfileRebuildStringKeys(int num_keys, int num_runs) {
+  std::vector<std::string> rand_elems = RandStrs(16, 48, num_keys);
+  std::string buf;
+  std::vector<std::pair<int, int>> token_bounds;
+  for (const std::string& e : rand_elems) {
+    token_bounds.push_back({static_cast<int>(buf.size()),
+        static_cast<int>(e.size())});
+    buf += e;
+  }
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  Hashmap<std::string, int> test;
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int j = 0; j < num_keys; ++j) {
+      const std::pair<int, int>& bounds = token_bounds[j];
+      test[buf.substr(bounds.first, bounds.second)] = j;
+    }
+    DoNotOptimize(test.Get(rand_elems[i % num_keys]));
+    test.Clear();
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap std::string keys" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+
+  StringInterner interner;
+  Hashmap<InternedString, int> test_interned;
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int j = 0; j < num_keys; ++j) {
+      const std::pair<int, int>& bounds = token_bounds[j];
+      test_interned[interner.Intern(
+          StringRef(buf.data() + bounds.first, bounds.second))] = j;
+    }
+    DoNotOptimize(test_interned.Get(*interner.Find(rand_elems[i % num_keys])));
+    test_interned.Clear();
+    interner.Clear();
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap InternedString keys" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+}
+
+
+/**
+ * Value large enough that empty slots in a sparse table cost real memory
+ * traffic when iterating.
+ */
+struct Payload {
+  int64_t fields[8];
+};
+
+
+/**
+ * Profiles scanning every entry of a map and summing a field of each value.
+ */
+void ProfileIterate(int num_entries, int num_runs) {
+  int64_t start = 0;
+  int64_t stop = 0;
+  int64_t sum = 0;
+
+  Hashmap<int, Payload> test;
+  DenseHashmap<int, Payload> test_dense;
+  std::unordered_map<int, Payload> test_std;
+  for (int i = 0; i < num_entries; ++i) {
+    Payload p;
+    std::fill(p.fields, p.fields + 8, i);
+    test.Put(i, p);
+    test_dense.Put(i, p);
+    test_std.insert({i, p});
+  }
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    test.ForEach([&](int k, const Payload& v) {
+      sum += v.fields[0];
+    });
+  }
+  stop = Clock::Now();
+  DoNotOptimize(sum);
+  std::cout << "dsalgo Hashmap" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_entries,
+      "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    test_dense.ForEach([&](int k, const Payload& v) {
+      sum += v.fields[0];
+    });
+  }
+  stop = Clock::Now();
+  DoNotOptimize(sum);
+  std::cout << "dsalgo DenseHashmap" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_entries,
+      "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const auto& entry : test_std) {
+      sum += entry.second.fields[0];
+    }
+  }
+  stop = Clock::Now();
+  DoNotOptimize(sum);
+  std::cout << "std::unordered_map" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_entries,
+      "\t");
+}
+
+
+void ProfileIterateVariousSizes() {
+  std::cout << "=== Profiling Hashmap Iterate Medium Size ===" << std::endl;
+  ProfileIterate(1000, 10000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Iterate Large Size ===" << std::endl;
+  ProfileIterate(1000000, 10);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Profiles starting up with a populated map: rebuilding a Hashmap by replaying
+ * Put() against mapping a snapshot written by MappedHashmap and doing the
+ * first num_lookups lookups in it.
+ */
+void ProfileMappedStartup(int num_keys, int num_lookups) {
+  const std::string filename = "/tmp/hashmap_prof.map";
+  std::vector<int64_t> keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(RandInt(0, 1 << 30) * 4LL + i);
+  }
+  Hashmap<int64_t, int64_t> original;
+  for (int64_t k : keys) {
+    original.Put(k, k);
+  }
+  MappedHashmap<int64_t, int64_t>::Write(filename, original);
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  start = Clock::Now();
+  Hashmap<int64_t, int64_t> rebuilt;
+  for (int64_t k : keys) {
+    rebuilt.Put(k, k);
+  }
+  for (int i = 0; i < num_lookups; ++i) {
+    DoNotOptimize(rebuilt.Get(keys[RandInt(0, num_keys - 1)]));
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap rebuild" << std::endl;
+  PrintStats(stop - start, 1, "\t");
+
+  start = Clock::Now();
+  MappedHashmap<int64_t, int64_t> mapped(filename);
+  for (int i = 0; i < num_lookups; ++i) {
+    DoNotOptimize(mapped.Get(keys[RandInt(0, num_keys - 1)]));
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo MappedHashmap map" << std::endl;
+  PrintStats(stop - start, 1, "\t");
+  unlink(filename.c_str());
+}
+
+
+/**
+ * Profiles building a Hashmap from a vector of keys: one Put() per key
+ * against a single PutMany(), serially and with one thread per core.
+ */
+void ProfileBulkBuild(int num_keys) {
+  std::vector<int64_t> keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(RandInt(0, 1 << 30) * 4LL + i);
+  }
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  start = Clock::Now();
+  {
+    Hashmap<int64_t, int64_t> test;
+    for (int64_t k : keys) {
+      test.Put(k, k);
+    }
+    DoNotOptimize(test.Get(keys[0]));
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap Put" << std::endl;
+  PrintStats(stop - start, num_keys, "\t");
+
+  int num_cores = std::max<int>(std::thread::hardware_concurrency(), 1);
+  for (int num_threads : {1, num_cores}) {
+    start = Clock::Now();
+    {
+      Hashmap<int64_t, int64_t> test;
+      test.SetNumThreads(num_threads);
+      test.PutMany(keys.data(), keys.data(), num_keys);
+      DoNotOptimize(test.Get(keys[0]));
+    }
+    stop = Clock::Now();
+    std::cout << "dsalgo Hashmap PutMany with " << num_threads << " threads" <<
+      std::endl;
+    PrintStats(stop - start, num_keys, "\t");
+  }
+}
+
+
+/**
+ * Profiles membership tests on a set of 64-bit IDs: a Hashmap with dummy
+ * values against HashSet and the sentinel-key IntHashSet. Half of the
+ * lookups are hits.
+ */
+void ProfileContains(int num_keys, int num_runs) {
+  // random odd IDs, so that even IDs are misses
+  std::vector<int64_t> keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(((static_cast<int64_t>(RandInt(0, 1 << 30)) << 32) |
+          (static_cast<int64_t>(RandInt(0, 1 << 30)) << 1)) | 1);
+  }
+  std::vector<int64_t> lookups;
+  for (int i = 0; i < num_keys; ++i) {
+    lookups.push_back(keys[RandInt(0, num_keys - 1)] - (i % 2));
+  }
+
+  Hashmap<int64_t, bool> test_map;
+  HashSet<int64_t> test_set;
+  IntHashSet<int64_t> test_int_set;
+  std::unordered_set<int64_t> test_std;
+  for (int64_t k : keys) {
+    test_map.Put(k, true);
+    test_set.Insert(k);
+    test_int_set.Insert(k);
+    test_std.insert(k);
+  }
+
+  int64_t start = 0;
+  int64_t stop = 0;
+  int64_t found = 0;
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int64_t k : lookups) {
+      found += test_map.Get(k) != nullptr;
+    }
+  }
+  stop = Clock::Now();
+  DoNotOptimize(found);
+  std::cout << "dsalgo Hashmap<int64_t, bool>" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int64_t k : lookups) {
+      found += test_set.Contains(k);
+    }
+  }
+  stop = Clock::Now();
+  DoNotOptimize(found);
+  std::cout << "dsalgo HashSet" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int64_t k : lookups) {
+      found += test_int_set.Contains(k);
+    }
+  }
+  stop = Clock::Now();
+  DoNotOptimize(found);
+  std::cout << "dsalgo IntHashSet" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int64_t k : lookups) {
+      found += test_std.count(k);
+    }
+  }
+  stop = Clock::Now();
+  DoNotOptimize(found);
+  std::cout << "std::unordered_set" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+}
+
+
+void ProfileContainsVariousSizes() {
+  std::cout << "=== Profiling Set Contains Medium Size ===" << std::endl;
+  ProfileContains(1000, 10000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Set Contains Large Size ===" << std::endl;
+  ProfileContains(4000000, 3);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Profiles a map that is built once and then only read: Hashmap against a
+ * FrozenHashmap built from it. Half of the lookups are hits.
+ */
+void ProfileFrozenGet(int num_keys, int num_runs) {
+  std::vector<std::string> rand_elems = RandStrs(8, 16, num_keys);
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  Hashmap<std::string, int> test;
+  for (int i = 0; i < num_keys; i += 2) {
+    test.Put(rand_elems[i], i);
+  }
+
+  start = Clock::Now();
+  FrozenHashmap<std::string, int> test_frozen(test);
+  stop = Clock::Now();
+  std::cout << "dsalgo FrozenHashmap build" << std::endl;
+  PrintStats(stop - start, test.Size(), "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::string& e : rand_elems) {
+      DoNotOptimize(test.Get(e));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::string& e : rand_elems) {
+      DoNotOptimize(test_frozen.Get(e));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo FrozenHashmap" << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys, "\t");
+}
+
+
+void ProfileFrozenGetVariousSizes() {
+  std::cout << "=== Profiling Frozen Hashmap Get Medium Size ===" << std::endl;
+  ProfileFrozenGet(1000, 1000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Frozen Hashmap Get Large Size ===" << std::endl;
+  ProfileFrozenGet(1000000, 3);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Profiles looking up keys in batches with GetMany() against looking them up
+ * one at a time with Get(). Half of the keys are in the map.
+ */
+void ProfileGetMany(int num_keys, int batch_size, int num_runs) {
+  std::vector<std::string> rand_elems = RandStrs(8, 16, num_keys);
+  std::vector<std::string*> vals(batch_size);
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  Hashmap<std::string, std::string> test;
+  for (int i = 0; i < num_keys; i += 2) {
+    test.Put(rand_elems[i], rand_elems[i]);
+  }
+
+  // look keys up in a random order so that consecutive keys don't land in
+  // nearby slots
+  std::vector<std::string> lookups;
+  for (int i = 0; i < num_keys; ++i) {
+    lookups.push_back(rand_elems[RandInt(0, num_keys - 1)]);
+  }
+  int num_batches = num_keys / batch_size;
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int b = 0; b < num_batches; ++b) {
+      for (int j = 0; j < batch_size; ++j) {
+        vals[j] = test.Get(lookups[b * batch_size + j]);
+      }
+      DoNotOptimize(vals.data());
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap Get loop" << std::endl;
+  PrintStats(stop - start, num_runs * num_batches * batch_size, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (int b = 0; b < num_batches; ++b) {
+      test.GetMany(lookups.data() + b * batch_size, batch_size, vals.data());
+      DoNotOptimize(vals.data());
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap GetMany" << std::endl;
+  PrintStats(stop - start, num_runs * num_batches * batch_size, "\t");
+}
+
+
+void ProfileGetManyVariousSizes() {
+  std::cout << "=== Profiling Hashmap GetMany Medium Size, Batch 16 ===" <<
+    std::endl;
+  ProfileGetMany(1000, 16, 1000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap GetMany Large Size, Batch 16 ===" <<
+    std::endl;
+  ProfileGetMany(1000000, 16, 3);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap GetMany Large Size, Batch 256 ===" <<
+    std::endl;
+  ProfileGetMany(1000000, 256, 3);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Profiles lookups of keys that are not in the map when the map is filled up
+ * to just under the given load factor.
+ */
+void ProfileGetMissHighLoad(int table_size, float load_factor, int num_runs) {
+  int num_elems = static_cast<int>(table_size * load_factor) - 1;
+  std::vector<std::string> rand_elems = RandStrs(8, 16, num_elems);
+  std::vector<std::string> missing_elems = RandStrs(17, 24, num_elems);
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  Hashmap<std::string, std::string> test(table_size, load_factor);
+  RobinHoodHashmap<std::string, std::string> test_rh(table_size, load_factor);
+  CuckooHashmap<std::string, std::string> test_cuckoo(table_size, load_factor);
+  for (const std::string& e : rand_elems) {
+    test.Put(e, e);
+    test_rh.Put(e, e);
+    test_cuckoo.Put(e, e);
+  }
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::string& e : missing_elems) {
+      DoNotOptimize(test.Get(e));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap" << std::endl;
+  PrintStats(stop - start, num_runs * num_elems, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::string& e : missing_elems) {
+      DoNotOptimize(test_rh.Get(e));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo RobinHoodHashmap" << std::endl;
+  PrintStats(stop - start, num_runs * num_elems, "\t");
+
+  start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    for (const std::string& e : missing_elems) {
+      DoNotOptimize(test_cuckoo.Get(e));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo CuckooHashmap" << std::endl;
+  PrintStats(stop - start, num_runs * num_elems, "\t");
+}
+
+
+/**
+ * Profiles lookups where most keys are not in the map, with and without the
+ * Bloom filter in front of Get().
+ */
+void ProfileGetMostlyMisses(int num_keys, float hit_rate, int num_runs) {
+  std::vector<std::string> rand_elems = RandStrs(8, 16, num_keys);
+  std::vector<std::string> lookups;
+  for (int i = 0; i < num_keys; ++i) {
+    lookups.push_back((RandInt(0, 999) < hit_rate * 1000) ?
+        rand_elems[RandInt(0, num_keys - 1)] : RandStr(8, 16) + "#");
+  }
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  for (bool use_bloom_filter : {false, true}) {
+    Hashmap<std::string, std::string> test;
+    test.SetBloomFilter(use_bloom_filter);
+    for (const std::string& e : rand_elems) {
+      test.Put(e, e);
+    }
+
+    start = Clock::Now();
+    for (int i = 0; i < num_runs; ++i) {
+      for (const std::string& e : lookups) {
+        DoNotOptimize(test.Get(e));
+      }
+    }
+    stop = Clock::Now();
+    std::cout << "dsalgo Hashmap" <<
+      (use_bloom_filter ? " (Bloom filter)" : "") << std::endl;
+    PrintStats(stop - start, static_cast<int64_t>(num_runs) * num_keys,
+        "\t");
+  }
+}
+
+
+void ProfileGetMostlyMissesVariousSizes() {
+  std::cout << "=== Profiling Hashmap Get 15% Hits Medium Size ===" <<
+    std::endl;
+  ProfileGetMostlyMisses(1000, 0.15, 1000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Get 15% Hits Large Size ===" << std::endl;
+  ProfileGetMostlyMisses(1000000, 0.15, 3);
+  std::cout << "\n\n\n";
+}
+
+
+void ProfileGetMissHighLoadVariousLoads() {
+  std::cout << "=== Profiling Hashmap Get Miss Load 0.7 ===" << std::endl;
+  ProfileGetMissHighLoad(1 << 16, 0.7, 10);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Get Miss Load 0.9 ===" << std::endl;
+  ProfileGetMissHighLoad(1 << 16, 0.9, 10);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Get Miss Load 0.95 ===" << std::endl;
+  ProfileGetMissHighLoad(1 << 16, 0.95, 10);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Profiles the latency of each individual Put() while growing a map from
+ * empty, with and without incremental resizing.
+ */
+void ProfilePutLatency(int num_inserts) {
+  std::vector<std::string> rand_elems = RandStrs(8, 16, num_inserts);
+  std::vector<int64_t> latencies(num_inserts);
+
+  for (bool incremental : {false, true}) {
+    Hashmap<std::string, std::string> test;
+    test.SetIncrementalResize(incremental);
+    int64_t total_start = Clock::Now();
+    for (int i = 0; i < num_inserts; ++i) {
+      int64_t start = Clock::Now();
+      test.Put(rand_elems[i], rand_elems[i]);
+      latencies[i] = Clock::Now() - start;
+    }
+    int64_t total_stop = Clock::Now();
+    std::cout << "dsalgo Hashmap" <<
+      (incremental ? " (incremental resize)" : "") << std::endl;
+    PrintStats(total_stop - total_start, num_inserts, "\t");
+    PrintLatencyPercentiles(latencies, "\t");
+  }
+}
+
+
+/**
+ * Builds a hashmap from the given keys and looks each of them up.
+ */
+template<class Map>
+void ProfilePutAndGetKeys(const std::vector<int64_t>& keys, int num_runs,
+    const std::string& label) {
+  int64_t start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    Map test;
+    for (int64_t k : keys) {
+      test.Put(k, k);
+    }
+    for (int64_t k : keys) {
+      DoNotOptimize(test.Get(k));
+    }
+  }
+  int64_t stop = Clock::Now();
+  std::cout << label << std::endl;
+  PrintStats(stop - start, static_cast<int64_t>(num_runs) * keys.size() * 2,
+      "\t");
+}
+
+
+/**
+ * Profiles random keys against adversarial keys that all share their low 20
+ * bits, so std::hash puts them in one cluster, with std::hash and with
+ * SeededHash.
+ */
+void ProfileAdversarialKeys(int num_keys, int num_runs) {
+  std::vector<int64_t> random_keys;
+  std::vector<int64_t> adversarial_keys;
+  for (int i = 0; i < num_keys; ++i) {
+    random_keys.push_back(RandInt(0, 1 << 30) * 4LL + i);
+    adversarial_keys.push_back(static_cast<int64_t>(i) << 20);
+  }
+
+  typedef Hashmap<int64_t, int64_t> PlainMap;
+  typedef Hashmap<int64_t, int64_t, SeededHash> SeededMap;
+  ProfilePutAndGetKeys<PlainMap>(random_keys, num_runs,
+      "dsalgo Hashmap std::hash random keys");
+  ProfilePutAndGetKeys<PlainMap>(adversarial_keys, num_runs,
+      "dsalgo Hashmap std::hash adversarial keys");
+  ProfilePutAndGetKeys<SeededMap>(random_keys, num_runs,
+      "dsalgo Hashmap SeededHash random keys");
+  ProfilePutAndGetKeys<SeededMap>(adversarial_keys, num_runs,
+      "dsalgo Hashmap SeededHash adversarial keys");
+}
+
+
+/**
+ * Profiles a session store where each tick (e.g. millisecond) refreshes and
+ * reads random sessions with a TTL of ttl ticks. Compares a Hashmap that
+ * stores deadlines and scans the whole table for expired sessions every
+ * scan_interval ticks against ExpiringHashmap advancing its timer wheel every
+ * tick. Latencies are of the per-tick expiration work.
+ */
+void ProfileExpiringSessions(int num_sessions, int ops_per_tick, int ttl,
+    int scan_interval, int num_ticks) {
+  std::vector<int64_t> session_ids;
+  for (int i = 0; i < num_sessions; ++i) {
+    session_ids.push_back(RandInt(0, 1 << 30) * 4LL + i);
+  }
+  std::vector<int64_t> latencies(num_ticks);
+
+  int64_t total_start = Clock::Now();
+  {
+    Hashmap<int64_t, std::pair<int64_t, int64_t>> test;
+    std::vector<int64_t> expired;
+    for (int64_t tick = 0; tick < num_ticks; ++tick) {
+      for (int i = 0; i < ops_per_tick; ++i) {
+        int64_t id = session_ids[RandInt(0, num_sessions - 1)];
+        std::pair<int64_t, int64_t>* session = test.Get(id);
+        if (session != nullptr && session->second > tick) {
+          DoNotOptimize(session->first);
+        }
+        test.Put(id, std::make_pair(id, tick + ttl));
+      }
+
+      int64_t start = Clock::Now();
+      if (tick % scan_interval == 0) {
+        expired.clear();
+        test.ForEach([tick, &expired](int64_t id,
+              const std::pair<int64_t, int64_t>& session) {
+          if (session.second <= tick) {
+            expired.push_back(id);
+          }
+        });
+        for (int64_t id : expired) {
+          test.Remove(id);
+        }
+      }
+      latencies[tick] = Clock::Now() - start;
+    }
+  }
+  int64_t total_stop = Clock::Now();
+  std::cout << "dsalgo Hashmap with full scans" << std::endl;
+  PrintStats(total_stop - total_start,
+      static_cast<int64_t>(num_ticks) * ops_per_tick, "\t");
+  PrintLatencyPercentiles(latencies, "\t");
+
+  total_start = Clock::Now();
+  {
+    ExpiringHashmap<int64_t, int64_t> test;
+    for (int64_t tick = 0; tick < num_ticks; ++tick) {
+      for (int i = 0; i < ops_per_tick; ++i) {
+        int64_t id = session_ids[RandInt(0, num_sessions - 1)];
+        DoNotOptimize(test.Get(id));
+        test.Put(id, id, ttl);
+      }
+
+      int64_t start = Clock::Now();
+      test.Advance(tick + 1, 4 * ops_per_tick);
+      latencies[tick] = Clock::Now() - start;
+    }
+  }
+  total_stop = Clock::Now();
+  std::cout << "dsalgo ExpiringHashmap" << std::endl;
+  PrintStats(total_stop - total_start,
+      static_cast<int64_t>(num_ticks) * ops_per_tick, "\t");
+  PrintLatencyPercentiles(latencies, "\t");
+}
+
+
+/**
+ * Profiles a read-heavy mix (90% Get, 10% Put) of int64 keys from several
+ * threads at once. Compares ConcurrentHashmap against a Hashmap behind one
+ * global mutex.
+ */
+void ProfileConcurrentReadHeavy(int num_threads, int num_keys,
+    int ops_per_thread) {
+  std::vector<int> rand_keys = RandN(0, num_keys - 1, ops_per_thread);
+  std::vector<int> rand_ops = RandN(0, 9, ops_per_thread);
+
+  ConcurrentHashmap<int64_t, int64_t> test;
+  Hashmap<int64_t, int64_t> test_global;
+  std::mutex global_lock;
+  for (int64_t i = 0; i < num_keys; ++i) {
+    test.Put(i, i);
+    test_global.Put(i, i);
+  }
+
+  // each thread starts at a different offset into the shared operation list
+  // so that threads don't access the same keys in lockstep.
+  auto run_threads = [&](std::function<void(int64_t, bool)> op) {
+    std::vector<std::thread> threads;
+    int64_t start = Clock::Now();
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        int offset = t * (ops_per_thread / num_threads);
+        for (int i = 0; i < ops_per_thread; ++i) {
+          int idx = (i + offset) % ops_per_thread;
+          op(rand_keys[idx], rand_ops[idx] == 0);
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    return Clock::Now() - start;
+  };
+
+  int64_t elapsed = run_threads([&](int64_t k, bool is_put) {
+    if (is_put) {
+      test.Put(k, k);
+    } else {
+      int64_t v;
+      DoNotOptimize(test.Get(k, &v));
+    }
+  });
+  std::cout << "dsalgo ConcurrentHashmap" << std::endl;
+  PrintStats(elapsed, num_threads * ops_per_thread, "\t");
+
+  elapsed = run_threads([&](int64_t k, bool is_put) {
+    std::lock_guard<std::mutex> guard(global_lock);
+    if (is_put) {
+      test_global.Put(k, k);
+    } else {
+      DoNotOptimize(test_global.Get(k));
+    }
+  });
+  std::cout << "dsalgo Hashmap + global mutex" << std::endl;
+  PrintStats(elapsed, num_threads * ops_per_thread, "\t");
+}
+
+
+void ProfileConcurrentVariousThreads() {
+  int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    std::cout << "=== Profiling Concurrent Read-Heavy " << num_threads
+      << " Threads ===" << std::endl;
+    ProfileConcurrentReadHeavy(num_threads, 1000000, 1000000);
+    std::cout << "\n\n\n";
+  }
+}
+
+
 void ProfileRemove(int num_removals, int num_runs) {
   std::vector<std::string> rand_elems = RandStrs(8, 16, num_removals);
 
@@ -224,6 +1086,36 @@ void ProfileRandomized(int num_operations) {
   std::cout << "dsalgo Hashmap" << std::endl;
   PrintStats(stop - start, num_operations, "\t");
 
+  CuckooHashmap<std::string, std::string> test_cuckoo;
+  start = Clock::Now();
+  for (int i = 0; i < num_operations; ++i) {
+    switch (rand_ops[i]) {
+      // insert
+      case 0:
+      case 1:
+        test_cuckoo.Put(target_elem[i], target_elem[i]);
+        break;
+
+      // get
+      case 2:
+        test_cuckoo.Get(target_elem[i]);
+        break;
+
+      // remove
+      case 3:
+        test_cuckoo.Remove(target_elem[i]);
+        break;
+      default:
+        // should not get here
+        throw std::logic_error("Invalid op code " +
+            std::to_string(rand_ops[i]));
+        break;
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo CuckooHashmap" << std::endl;
+  PrintStats(stop - start, num_operations, "\t");
+
   std::unordered_map<std::string, std::string> test_std;
   start = Clock::Now();
   for (int i = 0; i < num_operations; ++i) {
@@ -279,10 +1171,50 @@ int main() {
   ReseedRand();
   ProfilePutVariousSizes();
   ProfileGetVariousSizes();
+  ProfileGetMissHighLoadVariousLoads();
+  ProfileGetMostlyMissesVariousSizes();
+
+  ProfileGetManyVariousSizes();
+  ProfileIterateVariousSizes();
+  ProfileContainsVariousSizes();
+  ProfileFrozenGetVariousSizes();
+
+  std::cout << "=== Profiling Hashmap Adversarial Keys ===" << std::endl;
+  ProfileAdversarialKeys(20000, 3);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Startup From Snapshot ===" << std::endl;
+  ProfileMappedStartup(4000000, 10000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Bulk Build ===" << std::endl;
+  ProfileBulkBuild(4000000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Get From Buffer ===" << std::endl;
+  ProfileGetFromBuffer(100000, 10);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Rebuild With String Keys ===" <<
+    std::endl;
+  ProfileRebuildStringKeys(100000, 10);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Hashmap Put Latency ===" << std::endl;
+  ProfilePutLatency(4000000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling Expiring Sessions ===" << std::endl;
+  ProfileExpiringSessions(1000000, 1000, 5000, 1000, 20000);
+  std::cout << "\n\n\n";
+
   ProfileRemoveVariousSizes();
 
   std::cout << "=== Profiling Hashmap Randomized Operations ===" << std::endl;
   ProfileRandomized(100000);
+  std::cout << "\n\n\n";
+
+  ProfileConcurrentVariousThreads();
   return 0;
 }
 
@@ -1,10 +1,14 @@
 #include "Hashmap.h"
 #include "Random.h"
+#include "SeededHash.h"
+#include "StringRef.h"
 #include <assert.h>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 using namespace dsalgo;
 
@@ -66,6 +70,117 @@ void testInsertViaOperator() {
 }
 
 
+void testMoveAndEmplace() {
+  // values that can only be moved
+  Hashmap<std::string, std::unique_ptr<int>> test;
+  for (int i = 0; i < 100; ++i) {
+    std::string key = std::to_string(i);
+    test.Put(std::move(key), std::unique_ptr<int>(new int(i)));
+  }
+  assert(test.Size() == 100);
+  for (int i = 0; i < 100; ++i) {
+    assert(**test.Get(std::to_string(i)) == i);
+  }
+
+  // TryEmplace doesn't touch existing values
+  std::pair<std::unique_ptr<int>*, bool> result =
+    test.TryEmplace(std::string("5"), std::unique_ptr<int>(new int(-5)));
+  assert(result.second == false);
+  assert(**result.first == 5);
+  result = test.TryEmplace(std::string("-5"),
+      std::unique_ptr<int>(new int(-5)));
+  assert(result.second == true);
+  assert(**result.first == -5);
+  assert(test.Size() == 101);
+
+  // Emplace overwrites them
+  result = test.Emplace(std::string("5"), new int(55));
+  assert(result.second == false);
+  assert(**test.Get("5") == 55);
+  result = test.Emplace(std::string("-6"), new int(-6));
+  assert(result.second == true);
+  assert(**test.Get("-6") == -6);
+  assert(test.Size() == 102);
+
+  // operator[] inserts default values
+  assert(test[std::string("-7")] == nullptr);
+  assert(test.Size() == 103);
+  test[std::string("-7")].reset(new int(-7));
+  assert(**test.Get("-7") == -7);
+}
+
+
+void testHeterogeneousLookup() {
+  Hashmap<std::string, int, StrHash, StrEq> test;
+  for (int i = 0; i < 500; ++i) {
+    test.Put(std::to_string(i), i);
+  }
+
+  const char* buf = "12 345 abc";
+  for (int i = 0; i < 500; ++i) {
+    std::string key = std::to_string(i);
+    assert(*test.Get(key.c_str()) == i);
+    assert(*test.Get(StringRef(key.data(), key.size())) == i);
+  }
+  assert(*test.Get(StringRef(buf, 2)) == 12);
+  assert(*test.Get(StringRef(buf + 3, 3)) == 345);
+  assert(test.Get(StringRef(buf + 7, 3)) == nullptr);
+  assert(test.Get("") == nullptr);
+
+  assert(test.Remove(StringRef(buf, 2)) == true);
+  assert(test.Remove(StringRef(buf, 2)) == false);
+  assert(test.Get("12") == nullptr);
+  assert(test.Remove("13") == true);
+  assert(test.Size() == 498);
+}
+
+
+void testGetManyAndPutMany() {
+  for (bool incremental : {false, true}) {
+    Hashmap<std::string, int> test;
+    test.SetIncrementalResize(incremental);
+
+    // batch sizes around the internal prefetch batch size
+    int batch_begin = 0;
+    for (int batch_size : {0, 1, 15, 16, 17, 300}) {
+      std::vector<std::string> keys;
+      std::vector<int> vals;
+      for (int i = batch_begin; i < batch_begin + batch_size; ++i) {
+        keys.push_back(std::to_string(i));
+        vals.push_back(i);
+      }
+      test.PutMany(keys.data(), vals.data(), batch_size);
+      batch_begin += batch_size;
+      assert(test.Size() == batch_begin);
+    }
+
+    // look up the inserted keys mixed with missing keys
+    std::vector<std::string> keys;
+    for (int i = -100; i < batch_begin + 100; ++i) {
+      keys.push_back(std::to_string(i));
+    }
+    std::vector<int*> vals(keys.size());
+    test.GetMany(keys.data(), keys.size(), vals.data());
+    for (int i = 0; i < static_cast<int>(keys.size()); ++i) {
+      int key = i - 100;
+      if (key >= 0 && key < batch_begin) {
+        assert(*vals[i] == key);
+      } else {
+        assert(vals[i] == nullptr);
+      }
+    }
+
+    // later duplicates in a batch win, like calling Put() in order
+    std::vector<std::string> dup_keys = {"a", "b", "a"};
+    std::vector<int> dup_vals = {1, 2, 3};
+    test.PutMany(dup_keys.data(), dup_vals.data(), 3);
+    assert(*test.Get("a") == 3);
+    assert(*test.Get("b") == 2);
+    assert(test.Size() == batch_begin + 2);
+  }
+}
+
+
 void testRemoveAndGet() {
   Hashmap<std::string, int> test;
 
@@ -206,7 +321,308 @@ void testMove() {
 }
 
 
-void testRandomized(Hashmap<std::string, int>& test_map, int num_ops) {
+void testIncrementalResize() {
+  Hashmap<std::string, int> test;
+  test.SetIncrementalResize(true);
+
+  // check every key after every insert so that lookups, overwrites and
+  // removals all happen while entries are split across the old and new tables.
+  int num_elems = 1000;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    assert(test.Size() == i + 1);
+    if (i % 97 == 0) {
+      for (int j = 0; j <= i; ++j) {
+        assert(*test.Get(std::to_string(j)) == j);
+      }
+    }
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), -i);
+  }
+  assert(test.Size() == num_elems);
+  for (int i = 0; i < num_elems; i += 2) {
+    assert(test.Remove(std::to_string(i)) == true);
+  }
+  assert(test.Size() == num_elems / 2);
+
+  // copies taken in the middle of a migration should be independent
+  Hashmap<std::string, int> copy = test;
+  for (int i = 1; i < num_elems; i += 2) {
+    assert(*test.Get(std::to_string(i)) == -i);
+    assert(test.Remove(std::to_string(i)) == true);
+    assert(*copy.Get(std::to_string(i)) == -i);
+    assert(copy.Get(std::to_string(i - 1)) == nullptr);
+  }
+  assert(test.Size() == 0);
+  assert(copy.Size() == num_elems / 2);
+
+  // disabling the mode finishes the migration
+  copy.SetIncrementalResize(false);
+  for (int i = 1; i < num_elems; i += 2) {
+    assert(copy[std::to_string(i)] == -i);
+  }
+
+  // the 718th Put() into a 1024 slot table resizes it, so the old table is
+  // still being migrated right afterwards.
+  Hashmap<std::string, int> migrating(1024);
+  migrating.SetIncrementalResize(true);
+  for (int i = 0; i < 718; ++i) {
+    migrating.Put(std::to_string(i), i);
+  }
+  Hashmap<std::string, int> migrating_copy = migrating;
+  Hashmap<std::string, int> migrating_moved = std::move(migrating);
+  for (int i = 0; i < 718; ++i) {
+    assert(migrating_copy.Remove(std::to_string(i)) == true);
+    assert(*migrating_moved.Get(std::to_string(i)) == i);
+  }
+  assert(migrating_copy.Size() == 0);
+  assert(migrating_moved.Size() == 718);
+}
+
+
+void testBloomFilter() {
+  for (bool incremental : {false, true}) {
+    Hashmap<std::string, int> test;
+    test.SetIncrementalResize(incremental);
+
+    // enabling the filter on a populated map adds its existing keys
+    int num_elems = 1000;
+    for (int i = 0; i < num_elems / 2; ++i) {
+      test.Put(std::to_string(i), i);
+    }
+    test.SetBloomFilter(true);
+    for (int i = num_elems / 2; i < num_elems; ++i) {
+      test.Put(std::to_string(i), i);
+      if (i % 97 == 0) {
+        for (int j = 0; j <= i; ++j) {
+          assert(*test.Get(std::to_string(j)) == j);
+        }
+      }
+    }
+    for (int i = 0; i < num_elems; ++i) {
+      assert(*test.Get(std::to_string(i)) == i);
+      assert(test.Get(std::to_string(-i - 1)) == nullptr);
+    }
+
+    // removed keys are misses even though they are still in the filter
+    for (int i = 0; i < num_elems; i += 2) {
+      assert(test.Remove(std::to_string(i)) == true);
+    }
+    for (int i = 0; i < num_elems; ++i) {
+      assert((test.Get(std::to_string(i)) != nullptr) == (i % 2 == 1));
+    }
+
+    // copies and moves keep the filter
+    Hashmap<std::string, int> copy = test;
+    Hashmap<std::string, int> moved = std::move(test);
+    for (int i = 1; i < num_elems; i += 2) {
+      assert(*copy.Get(std::to_string(i)) == i);
+      assert(*moved.Get(std::to_string(i)) == i);
+    }
+
+    // keys put after a clear are found
+    copy.Clear();
+    for (int i = 0; i < num_elems; ++i) {
+      assert(copy.Get(std::to_string(i)) == nullptr);
+    }
+    copy.Put("1", 1);
+    assert(*copy.Get("1") == 1);
+
+    // disabling the filter keeps all entries
+    moved.SetBloomFilter(false);
+    for (int i = 1; i < num_elems; i += 2) {
+      assert(*moved.Get(std::to_string(i)) == i);
+    }
+  }
+}
+
+
+/**
+ * Identity hash, except that negative keys all share a home slot just before
+ * 2^17 or 2^19, so their cluster crosses from one thread's range of slots
+ * into the next, or wraps around the end of a 2^19 slot table.
+ */
+struct BoundaryHash {
+  size_t operator()(int k) const {
+    if (k >= 0) {
+      return k;
+    }
+    return (k % 2 == 0) ? (1 << 17) - 3 : (1 << 19) - 3;
+  }
+};
+
+
+void testParallelBuild() {
+  ReseedRand();
+  std::vector<int> keys;
+  std::vector<int> vals;
+  for (int i = 0; i < 200000; ++i) {
+    keys.push_back(RandInt(0, 1 << 30));
+    vals.push_back(i);
+  }
+  for (int i = 1; i <= 500; ++i) {
+    keys.push_back(-i);
+    vals.push_back(-i);
+  }
+  // duplicates, whose later values must win
+  for (int i = 0; i < 1000; ++i) {
+    keys.push_back(keys[i * 7]);
+    vals.push_back(-1000000 - i);
+  }
+  std::unordered_map<int, int> correct_map;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    correct_map[keys[i]] = vals[i];
+  }
+
+  for (int num_threads : {2, 3, 4, 8}) {
+    for (bool bloom : {false, true}) {
+      Hashmap<int, int, BoundaryHash> test(1 << 19);
+      test.SetNumThreads(num_threads);
+      test.SetBloomFilter(bloom);
+      test.Put(keys[0], 1);
+      test.PutMany(keys.data(), vals.data(), keys.size());
+      assert(test.Size() == static_cast<int>(correct_map.size()));
+      for (const auto& entry : correct_map) {
+        assert(*test.Get(entry.first) == entry.second);
+      }
+      assert(test.Get(-501) == nullptr);
+      assert(test.Get(-502) == nullptr);
+
+      // removing keys works on a table built in parallel
+      for (int i = 1; i <= 500; ++i) {
+        assert(test.Remove(-i));
+      }
+      for (int i = 0; i < 1000; ++i) {
+        assert(*test.Get(keys[i]) == correct_map[keys[i]]);
+      }
+    }
+  }
+
+  // resizes of big enough tables reinsert entries in parallel
+  for (bool bloom : {false, true}) {
+    Hashmap<int, int, BoundaryHash> test;
+    test.SetNumThreads(4);
+    test.SetBloomFilter(bloom);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      test.Put(keys[i], vals[i]);
+    }
+    assert(test.Size() == static_cast<int>(correct_map.size()));
+    for (const auto& entry : correct_map) {
+      assert(*test.Get(entry.first) == entry.second);
+    }
+
+    Hashmap<int, int, BoundaryHash> copy = test;
+    copy.Reserve(2000000);
+    for (const auto& entry : correct_map) {
+      assert(*copy.Get(entry.first) == entry.second);
+    }
+  }
+}
+
+
+/**
+ * Reseedable hash that sends every key to the same slot until it is first
+ * reseeded.
+ */
+struct CollidingUntilReseededHash {
+  static int num_reseeds;
+  bool reseeded = false;
+
+  size_t operator()(int k) const {
+    return reseeded ? k : 7;
+  }
+
+  void Reseed() {
+    reseeded = true;
+    ++num_reseeds;
+  }
+};
+
+int CollidingUntilReseededHash::num_reseeds = 0;
+
+
+void testSeededHash() {
+  // hashes depend on every byte and on the seed
+  std::string bytes = RandStr(200, 200);
+  for (size_t len = 0; len <= bytes.size(); ++len) {
+    uint64_t hash = WyHash(bytes.data(), len, 1);
+    assert(hash == WyHash(bytes.data(), len, 1));
+    assert(hash != WyHash(bytes.data(), len, 2));
+    if (len > 0) {
+      assert(hash != WyHash(bytes.data(), len - 1, 1));
+      std::string flipped = bytes.substr(0, len);
+      flipped[RandInt(0, len - 1)] ^= 1;
+      assert(hash != WyHash(flipped.data(), len, 1));
+    }
+  }
+  assert(SeededHash().Seed() != SeededHash().Seed());
+  SeededHash hash(5);
+  assert(hash(std::string("abc")) == hash(StringRef("abc")));
+  assert(hash(std::string("abc")) == WyHash("abc", 3, 5));
+  assert(hash(3) == hash(3LL));
+  assert(hash(3) != hash(4));
+
+  // keys that all land in slot 0 with std::hash are spread out
+  Hashmap<int64_t, int64_t, SeededHash> test;
+  for (int64_t i = 0; i < 10000; ++i) {
+    test.Put(i << 20, i);
+  }
+  for (int64_t i = 0; i < 10000; ++i) {
+    assert(*test.Get(i << 20) == i);
+  }
+  assert(test.Get(1) == nullptr);
+
+  Hashmap<std::string, int, SeededHash, StrEq> str_test;
+  str_test.Put("abc", 1);
+  assert(*str_test.Get(StringRef("abc")) == 1);
+  assert(*str_test.Get("abc") == 1);
+
+  // a long probe makes the hashmap reseed and rehash
+  for (bool incremental : {false, true}) {
+    CollidingUntilReseededHash::num_reseeds = 0;
+    Hashmap<int, int, CollidingUntilReseededHash> colliding;
+    colliding.SetIncrementalResize(incremental);
+    colliding.SetBloomFilter(incremental);
+    for (int i = 0; i < 2000; ++i) {
+      colliding.Put(i, -i);
+    }
+    assert(CollidingUntilReseededHash::num_reseeds == 1);
+    assert(colliding.Size() == 2000);
+    for (int i = 0; i < 2000; ++i) {
+      assert(*colliding.Get(i) == -i);
+    }
+    assert(colliding.Get(2000) == nullptr);
+    for (int i = 0; i < 2000; i += 2) {
+      assert(colliding.Remove(i));
+    }
+    for (int i = 0; i < 2000; ++i) {
+      assert((colliding.Get(i) != nullptr) == (i % 2 == 1));
+    }
+  }
+
+  // PutMany() rehashes the rest of a batch after a reseed in the middle of
+  // it. The keys are spread out, so that a key inserted under a stale
+  // hashcode doesn't happen to land in its own slot.
+  CollidingUntilReseededHash::num_reseeds = 0;
+  std::vector<int> keys(2000);
+  std::vector<int> vals(2000);
+  for (int i = 0; i < 2000; ++i) {
+    keys[i] = 3 * i;
+    vals[i] = -i;
+  }
+  Hashmap<int, int, CollidingUntilReseededHash> batched;
+  batched.PutMany(keys.data(), vals.data(), 2000);
+  assert(CollidingUntilReseededHash::num_reseeds == 1);
+  assert(batched.Size() == 2000);
+  for (int i = 0; i < 2000; ++i) {
+    assert(*batched.Get(3 * i) == -i);
+  }
+}
+
+
+template<class Map>
+void testRandomized(Map& test_map, int num_ops) {
   std::unordered_map<std::string, int> correct_map;
 
   for (int i = 0; i < num_ops; ++i) {
@@ -259,17 +675,86 @@ void testRandomized() {
   // use small load factor
   test = Hashmap<std::string, int>(8, 0.01);
   testRandomized(test, 5000);
+
+  // resize incrementally
+  test = Hashmap<std::string, int>();
+  test.SetIncrementalResize(true);
+  testRandomized(test, 5000);
+  test = Hashmap<std::string, int>(8, 1);
+  test.SetIncrementalResize(true);
+  testRandomized(test, 1000);
+
+  // consult a Bloom filter before probing
+  test = Hashmap<std::string, int>();
+  test.SetBloomFilter(true);
+  testRandomized(test, 5000);
+  test = Hashmap<std::string, int>(8, 1);
+  test.SetIncrementalResize(true);
+  test.SetBloomFilter(true);
+  testRandomized(test, 1000);
+
+  // hash with a random seed
+  Hashmap<std::string, int, SeededHash> seeded_test;
+  testRandomized(seeded_test, 5000);
+
+  // use 64-bit sizes and hashcodes
+  typedef Hashmap<std::string, int, std::hash<std::string>,
+          std::equal_to<std::string>, int64_t> WideHashmap;
+  WideHashmap wide_test;
+  testRandomized(wide_test, 5000);
+  wide_test = WideHashmap(8, 1);
+  wide_test.SetIncrementalResize(true);
+  testRandomized(wide_test, 1000);
+}
+
+
+/**
+ * Hash that only differs between keys in its high 32 bits.
+ */
+struct HighBitsHash {
+  size_t operator()(int64_t k) const {
+    return (static_cast<size_t>(k) << 32) | 0xFFFFFFFF;
+  }
+};
+
+
+void testWideIndex() {
+  // hashcodes keep the high bits of the hash, which can't go negative or
+  // clash with the -1 that marks unused entries
+  Hashmap<int64_t, int64_t, HighBitsHash, std::equal_to<int64_t>, int64_t>
+    test(8, 0.5);
+  for (int64_t i = 0; i < 1000; ++i) {
+    test.Put(i, -i);
+  }
+  assert(test.Size() == 1000);
+  for (int64_t i = 0; i < 1000; ++i) {
+    assert(*test.Get(i) == -i);
+  }
+  for (int64_t i = 0; i < 1000; i += 2) {
+    assert(test.Remove(i));
+  }
+  for (int64_t i = 0; i < 1000; ++i) {
+    assert((test.Get(i) != nullptr) == (i % 2 == 1));
+  }
 }
 
 
 int main() {
   testPutAndGet();
   testInsertViaOperator();
+  testMoveAndEmplace();
+  testHeterogeneousLookup();
+  testGetManyAndPutMany();
+  testWideIndex();
   testRemoveAndGet();
   testClear();
   testCopy();
   testMove();
   testRemoveAndGet();
+  testIncrementalResize();
+  testBloomFilter();
+  testParallelBuild();
+  testSeededHash();
   testRandomized();
   return 0;
 }
@@ -0,0 +1,246 @@
+#include "Hashmap.h"
+#include "Profiling.h"
+#include "Random.h"
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+/**
+ * Benchmark matrix for Hashmap against std::unordered_map, written as CSV to
+ * stdout so runs can be diffed between releases:
+ *
+ *   ./hashmapmatrix_prof-opt > hashmap_matrix.csv
+ *
+ * Sweeps key types, table sizes from L1-resident to DRAM-resident, load
+ * factors, hit ratios and uniform against Zipfian lookups. Every row is one
+ * measurement:
+ *
+ *   map            dsalgo::Hashmap or std::unordered_map
+ *   key_type       int64, short_string (8-16 chars) or long_string (32-64)
+ *   num_slots      slots of the Hashmap, buckets of the unordered_map
+ *   num_keys       keys in the map
+ *   load_factor    num_keys / num_slots
+ *   op             put (building the presized map) or get
+ *   hit_ratio      fraction of gets for keys in the map. Empty for put.
+ *   distribution   uniform or zipf (s = kZipfSkew) popularity of the keys
+ *                  looked up. Empty for put.
+ *   ns_per_op      average time per put or get
+ */
+
+// number of slots of the Hashmap in each configuration. With int64 keys,
+// the tables take about 24 KB, 384 KB, 6 MB and 48 MB.
+const std::vector<int> kNumSlots = {1 << 10, 1 << 14, 1 << 18, 1 << 21};
+
+const std::vector<double> kLoadFactors = {0.5, 0.7, 0.8, 0.9, 0.95};
+
+const std::vector<double> kHitRatios = {1.0, 0.5, 0.0};
+
+const double kZipfSkew = 0.99;
+
+// number of gets timed for each hit ratio and distribution
+const int kNumLookups = 1 << 20;
+
+
+/**
+ * Adapts Hashmap and std::unordered_map to the operations being measured.
+ */
+template<class Key>
+struct DsalgoMap {
+  static constexpr const char* Name() {
+    return "dsalgo::Hashmap";
+  }
+
+  Hashmap<Key, int64_t> map;
+  int num_slots;
+
+  // num_slots is a power of 2, so it's the table size exactly, and the map
+  // never resizes while filled to load_factor
+  DsalgoMap(int num_slots, double load_factor)
+    : map(num_slots, load_factor), num_slots(num_slots) {}
+
+  void Put(const Key& k, int64_t v) {
+    map.Put(k, v);
+  }
+
+  const int64_t* Get(const Key& k) const {
+    return map.Get(k);
+  }
+
+  int64_t NumSlots() const {
+    return num_slots;
+  }
+};
+
+
+template<class Key>
+struct StdMap {
+  static constexpr const char* Name() {
+    return "std::unordered_map";
+  }
+
+  std::unordered_map<Key, int64_t> map;
+
+  StdMap(int num_slots, double load_factor) {
+    map.max_load_factor(load_factor);
+    map.reserve(static_cast<size_t>(num_slots * load_factor));
+  }
+
+  void Put(const Key& k, int64_t v) {
+    map[k] = v;
+  }
+
+  const int64_t* Get(const Key& k) const {
+    auto it = map.find(k);
+    return it == map.end() ? nullptr : &it->second;
+  }
+
+  int64_t NumSlots() const {
+    return map.bucket_count();
+  }
+};
+
+
+/**
+ * Generates n distinct, random looking int64 keys.
+ *
+ * The murmur3 finalizer is a bijection, so the keys are distinct, and their
+ * low bits are as good as random. Hashmap's home slot for an int64 key under
+ * std::hash is its low bits, so the keys cluster the way random keys do.
+ * Something weaker, like multiplying consecutive numbers by an odd constant,
+ * would give the first table_size keys distinct home slots, and no probe
+ * would ever go past the first slot.
+ */
+std::vector<int64_t> MakeIntKeys(int n) {
+  uint64_t seed = (static_cast<uint64_t>(rand()) << 32) ^ rand();
+  std::vector<int64_t> keys(n);
+  for (int i = 0; i < n; ++i) {
+    keys[i] = static_cast<int64_t>(MurmurMix(seed + i));
+  }
+  return keys;
+}
+
+
+/**
+ * @return 0, 1, ..., n - 1 in random order
+ */
+std::vector<int> RandomPermutation(int n) {
+  std::vector<int> permutation(n);
+  for (int i = 0; i < n; ++i) {
+    permutation[i] = i;
+  }
+  for (int i = n - 1; i > 0; --i) {
+    std::swap(permutation[i], permutation[RandInt(0, i)]);
+  }
+  return permutation;
+}
+
+
+/**
+ * Generates the lookups for one hit ratio and distribution. Index i < n is
+ * the i-th key in the map. Index n + i is a key that isn't in it.
+ *
+ * Zipf ranks go through a random permutation of the keys, so that the
+ * hottest keys aren't the first ones inserted. Those sit at their home slot
+ * under linear probing, but at the end of their bucket's chain in
+ * std::unordered_map, which would skew the comparison.
+ */
+std::vector<int> MakeLookups(int num_keys, double hit_ratio,
+    const ZipfGenerator* zipf) {
+  std::vector<int> hit_keys = RandomPermutation(num_keys);
+  std::vector<int> miss_keys = RandomPermutation(num_keys);
+  std::vector<int> lookups(kNumLookups);
+  for (int i = 0; i < kNumLookups; ++i) {
+    int rank = (zipf != nullptr) ? zipf->Next() : RandInt(0, num_keys - 1);
+    bool hit = rand() < hit_ratio * (RAND_MAX + 1.0);
+    lookups[i] = hit ? hit_keys[rank] : num_keys + miss_keys[rank];
+  }
+  return lookups;
+}
+
+
+void PrintRow(const std::string& map_name, const std::string& key_type,
+    int64_t num_slots, int num_keys, const std::string& op,
+    const std::string& hit_ratio, const std::string& distribution,
+    double ns_per_op) {
+  std::cout << map_name << "," << key_type << "," << num_slots << "," <<
+    num_keys << "," << static_cast<double>(num_keys) / num_slots << "," <<
+    op << "," << hit_ratio << "," << distribution << "," << ns_per_op <<
+    std::endl;
+}
+
+
+/**
+ * Measures one map type with one key type across every table size, load
+ * factor, hit ratio and distribution.
+ *
+ * @param keys distinct keys. The first half are put into the map, the second
+ * half are used for misses. Must hold 2 * 0.95 * the largest number of slots.
+ */
+template<class Map, class Key>
+void ProfileMatrix(const std::vector<Key>& keys, const std::string& key_type) {
+  int half = keys.size() / 2;
+  for (int num_slots : kNumSlots) {
+    for (double load_factor : kLoadFactors) {
+      int num_keys = static_cast<int>(num_slots * load_factor);
+
+      // the map's keys followed by as many missing keys
+      std::vector<Key> pool(keys.begin(), keys.begin() + num_keys);
+      pool.insert(pool.end(), keys.begin() + half,
+          keys.begin() + half + num_keys);
+
+      Map test(num_slots, load_factor);
+      int64_t start = Clock::Now();
+      for (int i = 0; i < num_keys; ++i) {
+        test.Put(pool[i], i);
+      }
+      int64_t stop = Clock::Now();
+      PrintRow(Map::Name(), key_type, test.NumSlots(), num_keys, "put", "",
+          "", static_cast<double>(stop - start) / num_keys);
+
+      ZipfGenerator zipf(num_keys, kZipfSkew);
+      for (double hit_ratio : kHitRatios) {
+        for (bool skewed : {false, true}) {
+          std::vector<int> lookups = MakeLookups(num_keys, hit_ratio,
+              skewed ? &zipf : nullptr);
+          start = Clock::Now();
+          for (int idx : lookups) {
+            DoNotOptimize(test.Get(pool[idx]));
+          }
+          stop = Clock::Now();
+          PrintRow(Map::Name(), key_type, test.NumSlots(), num_keys, "get",
+              std::to_string(hit_ratio), skewed ? "zipf" : "uniform",
+              static_cast<double>(stop - start) / kNumLookups);
+        }
+      }
+    }
+  }
+}
+
+
+/**
+ * Measures both maps with the given keys.
+ */
+template<class Key>
+void ProfileKeyType(const std::vector<Key>& keys, const std::string& key_type) {
+  ProfileMatrix<DsalgoMap<Key>>(keys, key_type);
+  ProfileMatrix<StdMap<Key>>(keys, key_type);
+}
+
+
+int main() {
+  ReseedRand();
+  std::cout << "map,key_type,num_slots,num_keys,load_factor,op,hit_ratio," <<
+    "distribution,ns_per_op" << std::endl;
+
+  int num_keys = 2 * static_cast<int>(kNumSlots.back() * kLoadFactors.back());
+  ProfileKeyType(MakeIntKeys(num_keys), "int64");
+  ProfileKeyType(RandStrs(8, 16, num_keys), "short_string");
+  ProfileKeyType(RandStrs(32, 64, num_keys), "long_string");
+  return 0;
+}
@@ -0,0 +1,159 @@
+#define DSALGO_HASHMAP_STATS
+#include "ConcurrentHashmap.h"
+#include "Hashmap.h"
+#include "Random.h"
+#include "SeededHash.h"
+#include <assert.h>
+#include <string>
+
+
+using namespace dsalgo;
+
+
+/**
+ * Hash that sends every key to the same slot.
+ */
+struct ConstantHash {
+  size_t operator()(int) const {
+    return 7;
+  }
+};
+
+
+int64_t Sum(const int64_t* histogram) {
+  int64_t sum = 0;
+  for (int i = 0; i < HashmapStats::kProbeHistogramSize; ++i) {
+    sum += histogram[i];
+  }
+  return sum;
+}
+
+
+void testProbeLengths() {
+  // identity hash, so keys 0..7 land in their own slots of an 8-slot table
+  Hashmap<int, int> test(8, 1.0);
+  for (int i = 0; i < 4; ++i) {
+    test.Put(i, i);
+  }
+  HashmapStats stats = test.GetStats();
+  assert(stats.miss_probe_lengths[0] == 4);
+  assert(Sum(stats.hit_probe_lengths) == 0);
+  assert(stats.longest_cluster == 4);
+  assert(stats.num_resizes == 0);
+
+  test.ResetStats();
+  for (int i = 0; i < 4; ++i) {
+    assert(*test.Get(i) == i);
+  }
+  assert(test.Get(4) == nullptr);
+  stats = test.GetStats();
+  assert(stats.hit_probe_lengths[0] == 4);
+  assert(stats.miss_probe_lengths[0] == 1);
+  assert(Sum(stats.hit_probe_lengths) == 4);
+  assert(Sum(stats.miss_probe_lengths) == 1);
+}
+
+
+void testBadHash() {
+  Hashmap<int, int, ConstantHash> test(64, 1.0);
+  for (int i = 0; i < 40; ++i) {
+    test.Put(i, i);
+  }
+  test.ResetStats();
+  for (int i = 0; i < 40; ++i) {
+    test.Get(i);
+  }
+
+  // key i sits i slots past the home slot. Long probes share the last bucket
+  HashmapStats stats = test.GetStats();
+  for (int i = 0; i < HashmapStats::kProbeHistogramSize - 1; ++i) {
+    assert(stats.hit_probe_lengths[i] == 1);
+  }
+  assert(stats.hit_probe_lengths[HashmapStats::kProbeHistogramSize - 1] ==
+      40 - (HashmapStats::kProbeHistogramSize - 1));
+  assert(stats.longest_cluster == 40);
+
+  // removing the first key shifts every other key back
+  test.Remove(0);
+  assert(test.GetStats().remove_shifts == 39);
+  assert(test.GetStats().longest_cluster == 39);
+}
+
+
+/**
+ * Reseedable hash that sends every key to the same slot until it is first
+ * reseeded.
+ */
+struct CollidingUntilReseededHash {
+  bool reseeded = false;
+
+  size_t operator()(int k) const {
+    return reseeded ? k : 7;
+  }
+
+  void Reseed() {
+    reseeded = true;
+  }
+};
+
+
+void testReseeds() {
+  Hashmap<int, int, CollidingUntilReseededHash> test;
+  for (int i = 0; i < 1000; ++i) {
+    test.Put(i, i);
+  }
+  assert(test.GetStats().num_reseeds == 1);
+
+  // random keys never probe far enough to reseed a seeded hash
+  Hashmap<int, int, SeededHash> seeded;
+  for (int i = 0; i < 100000; ++i) {
+    seeded.Put(RandInt(0, 1 << 30), i);
+  }
+  assert(seeded.GetStats().num_reseeds == 0);
+  Hashmap<int, int> unseeded;
+  assert(unseeded.GetStats().num_reseeds == 0);
+}
+
+
+void testResizesAndMemory() {
+  Hashmap<int, int> test(8, 0.5);
+  for (int i = 0; i < 1000; ++i) {
+    test.Put(i, i);
+  }
+
+  // 8 -> 16 -> ... -> 2048 slots
+  HashmapStats stats = test.GetStats();
+  assert(stats.num_resizes == 8);
+  assert(stats.resize_ns > 0);
+  assert(stats.table_bytes >= 2048 * static_cast<int64_t>(sizeof(int) * 3));
+  assert(stats.bytes_per_entry == stats.table_bytes / 1000.0);
+
+  // a full table is one cluster
+  Hashmap<int, int> full(8, 1.0);
+  for (int i = 0; i < 8; ++i) {
+    full.Put(i * 8, i);
+  }
+  assert(full.GetStats().longest_cluster == 8);
+
+  Hashmap<int, int> empty;
+  assert(empty.GetStats().longest_cluster == 0);
+  assert(empty.GetStats().bytes_per_entry == 0);
+}
+
+
+void testConcurrentHashmapStillCompiles() {
+  ConcurrentHashmap<std::string, int> test(4);
+  test.Put("a", 1);
+  int v = 0;
+  assert(test.Get("a", &v) && v == 1);
+}
+
+
+int main() {
+  testProbeLengths();
+  testBadHash();
+  testReseeds();
+  testResizesAndMemory();
+  testConcurrentHashmapStillCompiles();
+  return 0;
+}
@@ -0,0 +1,228 @@
+#include "HashSet.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+
+using namespace dsalgo;
+
+
+void testInsertAndContains() {
+
+  // test set with full load factor
+  HashSet<std::string> test(8, 1.0);
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    assert(test.Insert(std::to_string(i)) == true);
+    assert(test.Insert(std::to_string(i)) == false);
+    assert(test.Size() == i + 1);
+    for (int j = 0; j <= i; ++j) {
+      assert(test.Contains(std::to_string(j)));
+    }
+    assert(!test.Contains(std::to_string(-i - 1)));
+  }
+
+  // test set with very small load factor
+  HashSet<std::string> test_small_lf(8, 0.001);
+  for (int i = 0; i < num_elems; ++i) {
+    test_small_lf.Insert(std::to_string(i));
+    assert(test_small_lf.Size() == i + 1);
+    for (int j = 0; j <= i; ++j) {
+      assert(test_small_lf.Contains(std::to_string(j)));
+    }
+  }
+}
+
+
+void testRemoveAndContains() {
+  HashSet<std::string> test;
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Insert(std::to_string(i));
+    if (i % 16 == 0) {
+      for (int j = 0; j < i; ++j) {
+        assert(test.Remove(std::to_string(j)) == true);
+      }
+      for (int j = 0; j < i; ++j) {
+        test.Insert(std::to_string(j));
+      }
+    }
+    assert(test.Size() == i + 1);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(test.Contains(std::to_string(i)));
+  }
+  for (int i = -1000; i < -500; ++i) {
+    assert(!test.Contains(std::to_string(i)));
+    assert(test.Remove(std::to_string(i)) == false);
+  }
+}
+
+
+void testClearAndForEach() {
+  HashSet<int> test;
+  for (int i = 0; i < 110; ++i) {
+    test.Insert(i);
+    if (i % 16 == 0) {
+      test.Clear();
+    }
+  }
+
+  // only 97-109 should be in the set
+  assert(test.Size() == 13);
+  int sum = 0;
+  int count = 0;
+  test.ForEach([&](int k) {
+    sum += k;
+    ++count;
+  });
+  assert(count == 13);
+  assert(sum == (97 + 109) * 13 / 2);
+}
+
+
+void testCopyAndMove() {
+  HashSet<std::string> original;
+  int num_elems = 456;
+  for (int i = 0; i < num_elems; ++i) {
+    original.Insert(std::to_string(i));
+  }
+
+  HashSet<std::string> copy_construct = original;
+  HashSet<std::string> copy_assign;
+  copy_assign.Insert("-1");
+  copy_assign = original;
+  for (int i = 0; i < 300; ++i) {
+    original.Remove(std::to_string(i));
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(copy_construct.Contains(std::to_string(i)));
+    assert(copy_assign.Contains(std::to_string(i)));
+  }
+  assert(!copy_assign.Contains("-1"));
+
+  HashSet<std::string> move_construct = std::move(copy_construct);
+  HashSet<std::string> move_assign;
+  move_assign.Insert("-1");
+  move_assign = std::move(copy_assign);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(move_construct.Contains(std::to_string(i)));
+    assert(move_assign.Contains(std::to_string(i)));
+  }
+  assert(!move_assign.Contains("-1"));
+}
+
+
+void testIntHashSet() {
+  IntHashSet<int64_t> test;
+
+  // keys that only differ in their high bits must still spread out
+  int num_elems = 1000;
+  for (int i = 0; i < num_elems; ++i) {
+    assert(test.Insert(static_cast<int64_t>(i) << 40) == true);
+    assert(test.Insert(static_cast<int64_t>(i) << 40) == false);
+  }
+  assert(test.Size() == num_elems);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(test.Contains(static_cast<int64_t>(i) << 40));
+    assert(!test.Contains((static_cast<int64_t>(i) << 40) + 1));
+  }
+
+  // the sentinel key can't be inserted, and is never found
+  bool threw = false;
+  try {
+    test.Insert(std::numeric_limits<int64_t>::max());
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+  assert(!test.Contains(std::numeric_limits<int64_t>::max()));
+  assert(test.Remove(std::numeric_limits<int64_t>::max()) == false);
+
+  // user-declared sentinel frees up the maximum key
+  IntHashSet<int, -1> test_custom;
+  assert(test_custom.Insert(std::numeric_limits<int>::max()) == true);
+  assert(test_custom.Contains(std::numeric_limits<int>::max()));
+  assert(!test_custom.Contains(-1));
+
+  IntHashSet<int64_t> copy = test;
+  for (int i = 0; i < num_elems; i += 2) {
+    assert(test.Remove(static_cast<int64_t>(i) << 40) == true);
+  }
+  assert(test.Size() == num_elems / 2);
+  assert(copy.Size() == num_elems);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(test.Contains(static_cast<int64_t>(i) << 40) == (i % 2 == 1));
+    assert(copy.Contains(static_cast<int64_t>(i) << 40));
+  }
+  IntHashSet<int64_t> moved = std::move(copy);
+  assert(moved.Size() == num_elems);
+}
+
+
+template<class Set>
+void testRandomized(Set& test_set, int num_ops) {
+  std::unordered_set<int> correct_set;
+
+  for (int i = 0; i < num_ops; ++i) {
+    int operation = RandInt(0, 99);
+
+    // insert a key
+    if (operation < 50) {
+      int rand_key = RandInt(-1000, 1000);
+      bool inserted = correct_set.insert(rand_key).second;
+      assert(test_set.Insert(rand_key) == inserted);
+
+    // remove a key
+    } else if (operation < 75) {
+      if (!correct_set.empty()) {
+        int key_to_remove = *correct_set.begin();
+        correct_set.erase(key_to_remove);
+        assert(test_set.Remove(key_to_remove) == true);
+      }
+
+    // remove a key that may not be there
+    } else {
+      int rand_key = RandInt(-1000, 1000);
+      bool removed = correct_set.erase(rand_key) > 0;
+      assert(test_set.Remove(rand_key) == removed);
+    }
+
+    assert(test_set.Size() == static_cast<int>(correct_set.size()));
+    for (int k : correct_set) {
+      assert(test_set.Contains(k));
+    }
+  }
+}
+
+
+void testRandomized() {
+  ReseedRand();
+
+  HashSet<int> test;
+  testRandomized(test, 5000);
+  test = HashSet<int>(8, 1);
+  testRandomized(test, 5000);
+
+  IntHashSet<int> test_int;
+  testRandomized(test_int, 5000);
+  test_int = IntHashSet<int>(8, 1);
+  testRandomized(test_int, 5000);
+}
+
+
+int main() {
+  testInsertAndContains();
+  testRemoveAndContains();
+  testClearAndForEach();
+  testCopyAndMove();
+  testIntHashSet();
+  testRandomized();
+  return 0;
+}
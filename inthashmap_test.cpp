@@ -0,0 +1,228 @@
+#include "IntHashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+
+using namespace dsalgo;
+
+
+void testPutAndGet() {
+
+  // test hashmap with full load factor
+  IntHashmap<int64_t, int64_t> test(8, 1.0);
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(i, i);
+    assert(test.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test.Get(j) == j);
+      assert(test[j] == j);
+    }
+  }
+
+  // test hashmap with very small load factor
+  IntHashmap<int64_t, int64_t> test_small_lf(8, 0.001);
+  for (int i = 0; i < num_elems; ++i) {
+    test_small_lf.Put(i, i);
+    assert(test_small_lf.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test_small_lf.Get(j) == j);
+    }
+  }
+
+  // keys that only differ in their high bits must still spread out
+  IntHashmap<int64_t, int> test_high_bits;
+  for (int i = 0; i < 1000; ++i) {
+    test_high_bits[static_cast<int64_t>(i) << 40] = i;
+  }
+  for (int i = 0; i < 1000; ++i) {
+    assert(*test_high_bits.Get(static_cast<int64_t>(i) << 40) == i);
+    assert(test_high_bits.Get((static_cast<int64_t>(i) << 40) + 1) == nullptr);
+  }
+}
+
+
+void testEmptyKey() {
+  IntHashmap<int64_t, int> test;
+  const int64_t empty_key = std::numeric_limits<int64_t>::max();
+
+  bool threw = false;
+  try {
+    test.Put(empty_key, 1);
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+
+  threw = false;
+  try {
+    test[empty_key] = 1;
+  } catch (const std::invalid_argument& e) {
+    threw = true;
+  }
+  assert(threw);
+  assert(test.Size() == 0);
+  assert(test.Get(empty_key) == nullptr);
+  assert(test.Remove(empty_key) == false);
+
+  // user-declared sentinel frees up the maximum key
+  IntHashmap<int, std::string, 0> test_custom;
+  test_custom.Put(std::numeric_limits<int>::max(), "max");
+  test_custom.Put(-1, "-1");
+  assert(*test_custom.Get(std::numeric_limits<int>::max()) == "max");
+  assert(*test_custom.Get(-1) == "-1");
+  assert(test_custom.Get(0) == nullptr);
+}
+
+
+void testRemoveAndGet() {
+  IntHashmap<int, std::string> test;
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(i, std::to_string(i));
+    if (i % 16 == 0) {
+      for (int j = 0; j < i; ++j) {
+        assert(test.Remove(j) == true);
+      }
+      for (int j = 0; j < i; ++j) {
+        test.Put(j, std::to_string(j));
+      }
+    }
+    assert(test.Size() == i + 1);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*test.Get(i) == std::to_string(i));
+  }
+  for (int i = -1000; i < -500; ++i) {
+    assert(test.Get(i) == nullptr);
+    assert(test.Remove(i) == false);
+  }
+}
+
+
+void testClearAndForEach() {
+  IntHashmap<int, int> test;
+  for (int i = 0; i < 110; ++i) {
+    test[i] = i;
+    if (i % 16 == 0) {
+      test.Clear();
+    }
+  }
+
+  // only 97-109 should be in the map
+  assert(test.Size() == 13);
+  int count = 0;
+  test.ForEach([&](int k, int v) {
+    assert(k == v);
+    assert(97 <= k && k < 110);
+    ++count;
+  });
+  assert(count == 13);
+  for (int i = 0; i < 97; ++i) {
+    assert(test.Get(i) == nullptr);
+  }
+}
+
+
+void testCopyAndMove() {
+  IntHashmap<int, int> original;
+  int num_elems = 456;
+  for (int i = 0; i < num_elems; ++i) {
+    original.Put(i, i);
+  }
+
+  IntHashmap<int, int> copy_construct = original;
+  IntHashmap<int, int> copy_assign;
+  copy_assign[-1] = -1;
+  copy_assign = original;
+  for (int i = 0; i < 300; ++i) {
+    original.Remove(i);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*copy_construct.Get(i) == i);
+    assert(*copy_assign.Get(i) == i);
+  }
+  assert(copy_assign.Get(-1) == nullptr);
+
+  IntHashmap<int, int> move_construct = std::move(copy_construct);
+  IntHashmap<int, int> move_assign;
+  move_assign[-1] = -1;
+  move_assign = std::move(copy_assign);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*move_construct.Get(i) == i);
+    assert(*move_assign.Get(i) == i);
+  }
+  assert(move_assign.Get(-1) == nullptr);
+}
+
+
+void testRandomized(IntHashmap<int, int>& test_map, int num_ops) {
+  std::unordered_map<int, int> correct_map;
+
+  for (int i = 0; i < num_ops; ++i) {
+    int operation = RandInt(0, 75);
+
+    // insert via Put
+    if (0 <= operation && operation < 25) {
+      int rand_key = RandInt(-1000, 1000);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map.Put(rand_key, rand_val);
+
+    // insert via operator[]
+    } else if (25 <= operation && operation < 50) {
+      int rand_key = RandInt(-1000, 1000);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map[rand_key] = rand_val;
+
+    // remove a key
+    } else if (50 <= operation && operation < 75) {
+      if (!correct_map.empty()) {
+        int key_to_remove = correct_map.begin()->first;
+        correct_map.erase(key_to_remove);
+        assert(test_map.Remove(key_to_remove) == true);
+      }
+    }
+
+    assert(test_map.Size() == static_cast<int>(correct_map.size()));
+    for (const auto& entry : correct_map) {
+      assert(*test_map.Get(entry.first) == entry.second);
+    }
+  }
+}
+
+
+void testRandomized() {
+  ReseedRand();
+
+  // use recommended load factor
+  IntHashmap<int, int> test;
+  testRandomized(test, 5000);
+
+  // use high load factor
+  test = IntHashmap<int, int>(8, 1);
+  testRandomized(test, 5000);
+
+  // use small load factor
+  test = IntHashmap<int, int>(8, 0.01);
+  testRandomized(test, 5000);
+}
+
+
+int main() {
+  testPutAndGet();
+  testEmptyKey();
+  testRemoveAndGet();
+  testClearAndForEach();
+  testCopyAndMove();
+  testRandomized();
+  return 0;
+}
@@ -1,7 +1,19 @@
+#include "ArcCache.h"
+#include "ClockQueue.h"
+#include "ConcurrentLruCache.h"
+#include "LruCache.h"
 #include "LruQueue.h"
+#include "SegmentedLruCache.h"
+#include "TinyLfuCache.h"
 #include "Profiling.h"
 #include "Random.h"
+#include <algorithm>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 
@@ -152,10 +164,344 @@ void ProfileGetAndUse() {
 }
 
 
+/**
+ * Cache in front of a slower store: looks up each key, and on a miss, puts
+ * it. Keys are drawn from a Zipfian distribution over more keys than fit.
+ */
+void ProfileCacheLookups(int capacity, int num_keys, int num_ops) {
+  ZipfGenerator zipf(num_keys, 0.99);
+  std::vector<int64_t> keys(num_ops);
+  for (int i = 0; i < num_ops; ++i) {
+    keys[i] = zipf.Next();
+  }
+
+  LruCache<int64_t, int64_t> test(capacity);
+  int64_t hits = 0;
+  int64_t start = Clock::Now();
+  for (int64_t k : keys) {
+    int64_t* val = test.Get(k);
+    if (val != nullptr) {
+      ++hits;
+    } else {
+      test.Put(k, k);
+    }
+  }
+  int64_t stop = Clock::Now();
+  std::cout << "dsalgo lru cache (hit ratio " <<
+    static_cast<double>(hits) / num_ops << ")" << std::endl;
+  PrintStats(stop - start, num_ops, "\t");
+
+  // the usual list + unordered_map of iterators
+  typedef std::list<std::pair<int64_t, int64_t>> List;
+  List order;
+  std::unordered_map<int64_t, List::iterator> index;
+  index.reserve(capacity);
+  start = Clock::Now();
+  for (int64_t k : keys) {
+    auto it = index.find(k);
+    if (it != index.end()) {
+      order.splice(order.end(), order, it->second);
+      DoNotOptimize(it->second->second);
+    } else {
+      if (static_cast<int>(index.size()) == capacity) {
+        index.erase(order.front().first);
+        order.pop_front();
+      }
+      index[k] = order.insert(order.end(), std::make_pair(k, k));
+    }
+  }
+  stop = Clock::Now();
+  std::cout << "std::list + std::unordered_map" << std::endl;
+  PrintStats(stop - start, num_ops, "\t");
+}
+
+
+void ProfileCache() {
+  std::cout << "=== Profile small lru cache ===" << std::endl;
+  ProfileCacheLookups(1000, 100000, 5000000);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profile large lru cache ===" << std::endl;
+  ProfileCacheLookups(1000000, 10000000, 5000000);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Hits on random elements, which is all a read-mostly cache does to its
+ * eviction queue.
+ */
+template<class Queue>
+void ProfileMarkUsedRandom(const std::string& name, int num_elems,
+    int num_runs) {
+  std::vector<int64_t> elems;
+  for (int i = 0; i < num_elems; ++i) {
+    elems.push_back(i);
+  }
+  std::vector<int> elem_to_mark_used = RandN(0, num_elems - 1, num_runs);
+
+  Queue test(elems);
+  int64_t start = Clock::Now();
+  for (int i = 0; i < num_runs; ++i) {
+    test.MarkUsed(elem_to_mark_used[i]);
+  }
+  int64_t stop = Clock::Now();
+  std::cout << name << std::endl;
+  PrintStats(stop - start, num_runs, "\t");
+}
+
+
+/**
+ * Uses the queue to pick victims for a cache of num_slots keys: a hit marks
+ * the key's slot as used, and a miss evicts the key in GetLru()'s slot.
+ */
+template<class Queue>
+void ProfileQueueAsCache(const std::string& name, int num_slots,
+    const std::vector<int64_t>& keys) {
+  std::vector<int64_t> slots;
+  for (int i = 0; i < num_slots; ++i) {
+    slots.push_back(i);
+  }
+  Queue queue(slots);
+
+  // slots start out holding keys that are never looked up
+  std::vector<int64_t> slot_to_key(num_slots);
+  Hashmap<int64_t, int, FibonacciHash<std::hash<int64_t>>> key_to_slot(
+      2 * num_slots);
+  for (int i = 0; i < num_slots; ++i) {
+    slot_to_key[i] = -i - 1;
+    key_to_slot.Put(slot_to_key[i], i);
+  }
+
+  int64_t hits = 0;
+  int64_t start = Clock::Now();
+  for (int64_t k : keys) {
+    int* slot = key_to_slot.Get(k);
+    if (slot != nullptr) {
+      ++hits;
+      queue.MarkUsed(*slot);
+    } else {
+      int victim = queue.GetLru();
+      key_to_slot.Remove(slot_to_key[victim]);
+      slot_to_key[victim] = k;
+      key_to_slot.Put(k, victim);
+      queue.MarkUsed(victim);
+    }
+  }
+  int64_t stop = Clock::Now();
+  std::cout << name << " (hit ratio " <<
+    static_cast<double>(hits) / keys.size() << ")" << std::endl;
+  PrintStats(stop - start, keys.size(), "\t");
+}
+
+
+void ProfileClock() {
+  for (int num_elems : {1000, 1000000}) {
+    std::cout << "=== Profile mark used random, " << num_elems <<
+      " elements ===" << std::endl;
+    ProfileMarkUsedRandom<LruQueue<int64_t>>("dsalgo lru", num_elems,
+        10000000);
+    ProfileMarkUsedRandom<ClockQueue<int64_t>>("dsalgo clock", num_elems,
+        10000000);
+    std::cout << "\n\n\n";
+  }
+
+  // Zipfian keys over 10x as many keys as fit, and the same with a scan of
+  // keys that are never reused mixed in, which LRU handles poorly too
+  int num_slots = 100000;
+  int num_keys = 1000000;
+  int num_ops = 10000000;
+  ZipfGenerator zipf(num_keys, 0.99);
+  std::vector<int64_t> zipf_keys;
+  std::vector<int64_t> scan_keys;
+  for (int i = 0; i < num_ops; ++i) {
+    zipf_keys.push_back(zipf.Next());
+    scan_keys.push_back(i % 4 == 0 ? num_keys + i : zipf_keys.back());
+  }
+  for (double skew : {0.7, 0.99, 1.2}) {
+    ZipfGenerator skewed(num_keys, skew);
+    std::vector<int64_t> keys;
+    for (int i = 0; i < num_ops; ++i) {
+      keys.push_back(skewed.Next());
+    }
+    std::cout << "=== Profile cache of " << num_slots << " keys, zipf " <<
+      skew << " ===" << std::endl;
+    ProfileQueueAsCache<LruQueue<int64_t>>("dsalgo lru", num_slots, keys);
+    ProfileQueueAsCache<ClockQueue<int64_t>>("dsalgo clock", num_slots, keys);
+    std::cout << "\n\n\n";
+  }
+  std::cout << "=== Profile cache of " << num_slots << " keys, zipf 0.99 " <<
+    "with scans ===" << std::endl;
+  ProfileQueueAsCache<LruQueue<int64_t>>("dsalgo lru", num_slots, scan_keys);
+  ProfileQueueAsCache<ClockQueue<int64_t>>("dsalgo clock", num_slots,
+      scan_keys);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Runs a trace through a read-through cache: looks up each key, and on a
+ * miss, puts it.
+ */
+template<class Cache>
+void ProfileTrace(const std::string& name, int capacity,
+    const std::vector<int64_t>& keys) {
+  Cache test(capacity);
+  int64_t hits = 0;
+  int64_t start = Clock::Now();
+  for (int64_t k : keys) {
+    if (test.Get(k) != nullptr) {
+      ++hits;
+    } else {
+      test.Put(k, k);
+    }
+  }
+  int64_t stop = Clock::Now();
+  std::cout << name << " (hit ratio " <<
+    static_cast<double>(hits) / keys.size() << ")" << std::endl;
+  PrintStats(stop - start, keys.size(), "\t");
+}
+
+
+void ProfilePoliciesOnTrace(const std::string& trace_name, int capacity,
+    const std::vector<int64_t>& keys) {
+  std::cout << "=== Profile cache policies, " << trace_name << " ===" <<
+    std::endl;
+  ProfileTrace<LruCache<int64_t, int64_t>>("dsalgo lru", capacity, keys);
+  ProfileTrace<SegmentedLruCache<int64_t, int64_t>>("dsalgo segmented lru",
+      capacity, keys);
+  ProfileTrace<ArcCache<int64_t, int64_t>>("dsalgo arc", capacity, keys);
+  ProfileTrace<TinyLfuCache<int64_t, int64_t>>("dsalgo w-tinylfu", capacity,
+      keys);
+  std::cout << "\n\n\n";
+}
+
+
+/**
+ * Hit ratios of the eviction policies on Zipfian traces with scans mixed
+ * in. Keys are drawn from num_keys, 10x the cache's capacity. Scan keys are
+ * never reused.
+ */
+void ProfilePolicies() {
+  int capacity = 100000;
+  int num_keys = 1000000;
+  int num_ops = 10000000;
+  ZipfGenerator zipf(num_keys, 0.99);
+  int64_t next_scan_key = num_keys;
+
+  std::vector<int64_t> keys;
+  for (int i = 0; i < num_ops; ++i) {
+    keys.push_back(zipf.Next());
+  }
+  ProfilePoliciesOnTrace("zipf 0.99", capacity, keys);
+
+  // a sequential scan of 2x the capacity after every 1M lookups
+  std::vector<int64_t> scans;
+  for (int i = 0; i < num_ops; ++i) {
+    if (i % 1000000 == 0) {
+      for (int j = 0; j < 2 * capacity; ++j) {
+        scans.push_back(next_scan_key++);
+      }
+    }
+    scans.push_back(keys[i]);
+  }
+  ProfilePoliciesOnTrace("zipf 0.99 + periodic scans", capacity, scans);
+
+  // every other lookup is for a key that's never seen again
+  std::vector<int64_t> one_offs;
+  for (int i = 0; i < num_ops; ++i) {
+    one_offs.push_back(i % 2 == 0 ? keys[i] : next_scan_key++);
+  }
+  ProfilePoliciesOnTrace("zipf 0.99 + 50% one-off keys", capacity, one_offs);
+
+  // the popular keys change halfway through, which favors recency
+  std::vector<int64_t> shifted;
+  for (int i = 0; i < num_ops; ++i) {
+    shifted.push_back(i < num_ops / 2 ? keys[i] : keys[i] + num_keys / 2);
+  }
+  ProfilePoliciesOnTrace("zipf 0.99, shifting popularity", capacity,
+      shifted);
+}
+
+
+/**
+ * Runs f(thread index) on num_threads threads and prints the time per op.
+ */
+template<class F>
+void ProfileThreads(int num_threads, int64_t ops_per_thread,
+    const std::string& name, const F& f) {
+  std::vector<std::thread> threads;
+  int64_t start = Clock::Now();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back(f, t);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  int64_t stop = Clock::Now();
+  std::cout << name << " (" << num_threads << " threads)" << std::endl;
+  PrintStats(stop - start, num_threads * ops_per_thread, "\t");
+}
+
+
+/**
+ * Cache hits from several threads: a ConcurrentLruCache against an LruCache
+ * behind one mutex, both holding every key that's looked up.
+ */
+void ProfileConcurrentHits(int num_keys, int num_threads, int ops_per_thread) {
+  ZipfGenerator zipf(num_keys, 0.99);
+  std::vector<std::vector<int64_t>> keys(num_threads);
+  for (int t = 0; t < num_threads; ++t) {
+    for (int i = 0; i < ops_per_thread; ++i) {
+      keys[t].push_back(zipf.Next());
+    }
+  }
+
+  ConcurrentLruCache<int64_t, int64_t> concurrent(num_keys);
+  LruCache<int64_t, int64_t> locked(num_keys);
+  std::mutex lock;
+  for (int64_t k = 0; k < num_keys; ++k) {
+    concurrent.Put(k, k);
+    locked.Put(k, k);
+  }
+
+  ProfileThreads(num_threads, ops_per_thread, "dsalgo concurrent lru cache",
+      [&](int t) {
+        int64_t v = 0;
+        for (int64_t k : keys[t]) {
+          concurrent.Get(k, &v);
+          DoNotOptimize(v);
+        }
+      });
+
+  ProfileThreads(num_threads, ops_per_thread, "dsalgo lru cache + mutex",
+      [&](int t) {
+        for (int64_t k : keys[t]) {
+          std::lock_guard<std::mutex> guard(lock);
+          DoNotOptimize(*locked.Get(k));
+        }
+      });
+}
+
+
+void ProfileConcurrentCache() {
+  int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    std::cout << "=== Profile concurrent lru cache hits ===" << std::endl;
+    ProfileConcurrentHits(100000, num_threads, 2000000);
+    std::cout << "\n\n\n";
+  }
+}
+
+
 int main() {
   ReseedRand();
   ProfileConstruction();
   ProfileGetAndUse();
+  ProfileCache();
+  ProfileClock();
+  ProfilePolicies();
+  ProfileConcurrentCache();
   return 0;
 }
 
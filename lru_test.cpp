@@ -116,12 +116,32 @@ void testMarkUsedAlternating() {
 }
 
 
+void testCopyAfterMarkUsed() {
+  std::vector<int> elems = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  LruQueue<int> test(elems);
+  std::vector<int> expected = {1, 3, 4, 6, 7, 8, 0, 9, 5, 2};
+  for (int elem : {0, 9, 5, 2}) {
+    test.MarkUsed(elem);
+  }
+
+  // the copy has the same order as the original, not construction order
+  LruQueue<int> copy(test);
+  for (int i = 0; i < 20; ++i) {
+    assert(copy.GetLru() == expected[i % 10]);
+    assert(test.GetLru() == expected[i % 10]);
+    copy.MarkUsed(copy.GetLru());
+    test.MarkUsed(test.GetLru());
+  }
+}
+
+
 int main() {
   testConstructor();
   testCopy();
   testMove();
   testMarkUsed();
   testMarkUsedAlternating();
+  testCopyAfterMarkUsed();
   return 0;
 }
 
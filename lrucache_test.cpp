@@ -0,0 +1,182 @@
+#include "LruCache.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+
+using namespace dsalgo;
+
+
+void testPutAndGet() {
+  LruCache<int, std::string> test(3);
+  assert(test.Capacity() == 3);
+  assert(test.Put(1, "a"));
+  assert(test.Put(2, "b"));
+  assert(test.Put(3, "c"));
+  assert(test.Size() == 3);
+  assert(test.GetLru() == 1);
+
+  // using 1 makes 2 the next to be evicted
+  assert(*test.Get(1) == "a");
+  assert(test.GetLru() == 2);
+  assert(test.Put(4, "d"));
+  assert(test.Size() == 3);
+  assert(test.Get(2) == nullptr);
+  assert(test.GetLru() == 3);
+
+  // replacing a value is a use too
+  assert(!test.Put(3, "cc"));
+  assert(test.GetLru() == 1);
+  assert(*test.Get(3) == "cc");
+
+  // peeking isn't
+  assert(*test.Peek(1) == "a");
+  assert(test.Peek(2) == nullptr);
+  assert(test.GetLru() == 1);
+  assert(test.Put(5, "e"));
+  assert(test.Get(1) == nullptr);
+}
+
+
+void testErase() {
+  LruCache<int, int> test(4);
+  for (int i = 0; i < 4; ++i) {
+    test.Put(i, -i);
+  }
+  assert(test.Erase(0));
+  assert(!test.Erase(0));
+  assert(test.Erase(2));
+  assert(test.Size() == 2);
+  assert(test.GetLru() == 1);
+
+  // erased nodes are reused before anything is evicted
+  test.Put(4, -4);
+  test.Put(5, -5);
+  assert(test.Size() == 4);
+  assert(*test.Get(1) == -1);
+  assert(*test.Get(3) == -3);
+  test.Put(6, -6);
+  assert(test.Get(4) == nullptr);
+
+  test.Clear();
+  assert(test.Size() == 0);
+  assert(test.Get(1) == nullptr);
+  for (int i = 0; i < 10; ++i) {
+    test.Put(i, i);
+  }
+  assert(test.Size() == 4);
+  assert(test.GetLru() == 6);
+}
+
+
+void testCapacityOne() {
+  LruCache<std::string, int> test(1);
+  test.Put("a", 1);
+  test.Put("b", 2);
+  assert(test.Size() == 1);
+  assert(test.Get("a") == nullptr);
+  assert(*test.Get("b") == 2);
+  assert(test.Erase("b"));
+  assert(test.Size() == 0);
+  test.Put("c", 3);
+  assert(test.GetLru() == "c");
+}
+
+
+/**
+ * Reference LRU cache: a list from least- to most-recently used.
+ */
+struct SimpleLru {
+  int capacity;
+  std::list<std::pair<int, int>> order;
+  std::unordered_map<int, std::list<std::pair<int, int>>::iterator> index;
+
+  int* Get(int k) {
+    auto it = index.find(k);
+    if (it == index.end()) {
+      return nullptr;
+    }
+    order.splice(order.end(), order, it->second);
+    return &it->second->second;
+  }
+
+  void Put(int k, int v) {
+    auto it = index.find(k);
+    if (it != index.end()) {
+      it->second->second = v;
+      order.splice(order.end(), order, it->second);
+      return;
+    }
+    if (static_cast<int>(order.size()) == capacity) {
+      index.erase(order.front().first);
+      order.pop_front();
+    }
+    index[k] = order.insert(order.end(), std::make_pair(k, v));
+  }
+
+  bool Erase(int k) {
+    auto it = index.find(k);
+    if (it == index.end()) {
+      return false;
+    }
+    order.erase(it->second);
+    index.erase(it);
+    return true;
+  }
+};
+
+
+void testRandomized() {
+  for (int capacity : {1, 2, 17, 500}) {
+    LruCache<int, int> test(capacity);
+    SimpleLru correct{capacity, {}, {}};
+    for (int i = 0; i < 20000; ++i) {
+      int operation = RandInt(0, 9);
+      int key = RandInt(0, 2 * capacity + 5);
+      if (operation < 4) {
+        test.Put(key, i);
+        correct.Put(key, i);
+      } else if (operation < 8) {
+        int* val = test.Get(key);
+        int* expected = correct.Get(key);
+        assert((val == nullptr) == (expected == nullptr));
+        assert(val == nullptr || *val == *expected);
+      } else {
+        assert(test.Erase(key) == correct.Erase(key));
+      }
+      assert(test.Size() == static_cast<int>(correct.order.size()));
+      if (test.Size() > 0) {
+        assert(test.GetLru() == correct.order.front().first);
+      }
+    }
+
+    // copies keep the LRU order, and moves keep everything
+    LruCache<int, int> copy = test;
+    LruCache<int, int> moved = std::move(test);
+    for (const auto& entry : correct.order) {
+      assert(copy.GetLru() == entry.first);
+      assert(moved.GetLru() == entry.first);
+      assert(*copy.Get(entry.first) == entry.second);
+      assert(*moved.Get(entry.first) == entry.second);
+    }
+
+    test = copy;
+    assert(test.Size() == copy.Size());
+    test.Put(-1, -1);
+    assert(*test.Get(-1) == -1);
+    assert(copy.Get(-1) == nullptr);
+  }
+}
+
+
+int main() {
+  ReseedRand();
+  testPutAndGet();
+  testErase();
+  testCapacityOne();
+  testRandomized();
+  return 0;
+}
@@ -0,0 +1,222 @@
+#include "MappedHashmap.h"
+#include "Hashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+const std::string kTestFile = "/tmp/mappedhashmap_test.map";
+
+
+struct Point {
+  int x;
+  double y;
+};
+
+
+void testWriteAndGet() {
+  for (int num_elems : {0, 1, 7, 1000}) {
+    Hashmap<int, Point> original;
+    for (int i = 0; i < num_elems; ++i) {
+      original.Put(i * 3, Point{i, i / 2.0});
+    }
+    MappedHashmap<int, Point>::Write(kTestFile, original);
+
+    MappedHashmap<int, Point> mapped(kTestFile);
+    assert(mapped.Size() == num_elems);
+    for (int i = 0; i < num_elems; ++i) {
+      const Point* p = mapped.Get(i * 3);
+      assert(p->x == i);
+      assert(p->y == i / 2.0);
+      assert(mapped.Get(i * 3 + 1) == nullptr);
+    }
+    assert(mapped.Get(-1) == nullptr);
+  }
+  unlink(kTestFile.c_str());
+}
+
+
+void testWriteDuringIncrementalResize() {
+  Hashmap<int, int> original;
+  original.SetIncrementalResize(true);
+
+  // check after every insertion, so some snapshots are taken while entries
+  // are still in the old table
+  for (int i = 0; i < 300; ++i) {
+    original.Put(i, -i);
+    MappedHashmap<int, int>::Write(kTestFile, original, 0.9);
+    MappedHashmap<int, int> mapped(kTestFile);
+    assert(mapped.Size() == i + 1);
+    for (int j = 0; j <= i; ++j) {
+      assert(*mapped.Get(j) == -j);
+    }
+  }
+  unlink(kTestFile.c_str());
+}
+
+
+void testStringKeys() {
+  ReseedRand();
+  Hashmap<std::string, int> original;
+  std::vector<std::string> keys = RandStrs(0, 20, 2000);
+  for (int i = 0; i < static_cast<int>(keys.size()); ++i) {
+    original.Put(keys[i], i);
+  }
+  MappedStringHashmap<int>::Write(kTestFile, original);
+
+  MappedStringHashmap<int> mapped(kTestFile);
+  assert(mapped.Size() == original.Size());
+  original.ForEach([&](const std::string& k, int v) {
+    assert(*mapped.Get(k) == v);
+  });
+
+  // look up keys straight out of a buffer
+  std::string buffer = "abc " + keys[0] + " xyz";
+  assert(*mapped.Get(StringRef(buffer.data() + 4, keys[0].size())) ==
+      *original.Get(keys[0]));
+  assert(mapped.Get("this key is too long to be generated") == nullptr);
+  unlink(kTestFile.c_str());
+}
+
+
+void testBadFiles() {
+  bool threw = false;
+  try {
+    MappedHashmap<int, int> mapped("/tmp/mappedhashmap_test_missing.map");
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // a map with different value types
+  Hashmap<int, int> original;
+  original.Put(1, 1);
+  MappedHashmap<int, int>::Write(kTestFile, original);
+  threw = false;
+  try {
+    MappedHashmap<int, double> mapped(kTestFile);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // a map with integer keys isn't a map with string keys
+  threw = false;
+  try {
+    MappedStringHashmap<int> mapped(kTestFile);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // a truncated file
+  assert(truncate(kTestFile.c_str(), 100) == 0);
+  threw = false;
+  try {
+    MappedHashmap<int, int> mapped(kTestFile);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+  unlink(kTestFile.c_str());
+}
+
+
+/**
+ * Layout of a MappedHashmap<int, int> slot in the file.
+ */
+struct IntSlot {
+  int k;
+  int v;
+  int32_t hashcode;
+};
+
+
+/**
+ * Layout of a MappedStringHashmap<int> slot in the file.
+ */
+struct StringSlot {
+  uint64_t key_offset;
+  uint32_t key_size;
+  int32_t hashcode;
+  int v;
+};
+
+
+/**
+ * Overwrites every slot of a mapped file with f(slot).
+ */
+template<class Slot, class F>
+void CorruptSlots(const std::string& filename, F f) {
+  int fd = open(filename.c_str(), O_RDWR);
+  assert(fd >= 0);
+  MappedHashmapHeader hdr;
+  assert(pread(fd, &hdr, sizeof(hdr), 0) == sizeof(hdr));
+  for (int i = 0; i < hdr.table_size; ++i) {
+    Slot slot;
+    off_t offset = hdr.table_offset + i * sizeof(Slot);
+    assert(pread(fd, &slot, sizeof(slot), offset) == sizeof(slot));
+    f(slot);
+    assert(pwrite(fd, &slot, sizeof(slot), offset) == sizeof(slot));
+  }
+  close(fd);
+}
+
+
+void testCorruptSlots() {
+  // no empty slot to stop a probe
+  Hashmap<int, int> original;
+  for (int i = 0; i < 100; ++i) {
+    original.Put(i, i);
+  }
+  MappedHashmap<int, int>::Write(kTestFile, original);
+  CorruptSlots<IntSlot>(kTestFile, [](IntSlot& slot) {
+    if (slot.hashcode == -1) {
+      slot.hashcode = 0x7FFFFFFF;
+    }
+  });
+  {
+    MappedHashmap<int, int> mapped(kTestFile);
+    assert(*mapped.Get(5) == 5);
+    assert(mapped.Get(1000) == nullptr);
+  }
+
+  // keys pointing outside the string data, and no empty slot
+  Hashmap<std::string, int> strings;
+  for (int i = 0; i < 100; ++i) {
+    strings.Put(std::to_string(i), i);
+  }
+  MappedStringHashmap<int>::Write(kTestFile, strings);
+  CorruptSlots<StringSlot>(kTestFile, [](StringSlot& slot) {
+    if (slot.hashcode == -1) {
+      slot.hashcode = 0x7FFFFFFF;
+    } else {
+      slot.key_offset = uint64_t(1) << 40;
+    }
+  });
+  {
+    MappedStringHashmap<int> mapped(kTestFile);
+    for (int i = 0; i < 100; ++i) {
+      assert(mapped.Get(std::to_string(i)) == nullptr);
+    }
+    assert(mapped.Get("missing") == nullptr);
+  }
+  unlink(kTestFile.c_str());
+}
+
+
+int main() {
+  testWriteAndGet();
+  testWriteDuringIncrementalResize();
+  testStringKeys();
+  testBadFiles();
+  testCorruptSlots();
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "ShmHashmap.h"
+#include "Hashmap.h"
+#include "Profiling.h"
+#include "Random.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace dsalgo;
+
+
+/**
+ * Profiles lookups in a ShmHashmap against lookups in a private Hashmap. If
+ * with_writer is set, another process keeps overwriting values while the
+ * lookups run.
+ */
+void ProfileGet(int num_keys, int num_gets, bool with_writer) {
+  ShmHashmap<int64_t, int64_t> test("prof_hashmap.shm", num_keys, true);
+  Hashmap<int64_t, int64_t> baseline;
+  std::vector<int64_t> keys;
+  for (int i = 0; i < num_keys; ++i) {
+    int64_t k = RandInt(0, 1 << 30) * 4LL + i;
+    keys.push_back(k);
+    test.Put(k, k);
+    baseline.Put(k, k);
+  }
+  std::vector<int64_t> lookups;
+  for (int i = 0; i < num_gets; ++i) {
+    lookups.push_back(keys[RandInt(0, num_keys - 1)]);
+  }
+
+  int writer_pid = -1;
+  if (with_writer) {
+    writer_pid = fork();
+    if (writer_pid == 0) {
+      ShmHashmap<int64_t, int64_t> writer("prof_hashmap.shm");
+      for (int64_t i = 0; ; ++i) {
+        writer.Put(keys[i % num_keys], i);
+      }
+    }
+  }
+
+  int64_t start = 0;
+  int64_t stop = 0;
+
+  start = Clock::Now();
+  for (int64_t k : lookups) {
+    DoNotOptimize(baseline.Get(k));
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo Hashmap" << std::endl;
+  PrintStats(stop - start, num_gets, "\t");
+
+  start = Clock::Now();
+  int64_t v = 0;
+  for (int64_t k : lookups) {
+    DoNotOptimize(test.Get(k, &v));
+  }
+  stop = Clock::Now();
+  std::cout << "dsalgo ShmHashmap" << std::endl;
+  PrintStats(stop - start, num_gets, "\t");
+
+  if (with_writer) {
+    kill(writer_pid, SIGKILL);
+    waitpid(writer_pid, nullptr, 0);
+  }
+  unlink("prof_hashmap.shm");
+}
+
+
+int main() {
+  ReseedRand();
+
+  std::cout << "=== Profiling ShmHashmap Get Small Size ===" << std::endl;
+  ProfileGet(1000, 10000000, false);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling ShmHashmap Get Large Size ===" << std::endl;
+  ProfileGet(4000000, 10000000, false);
+  std::cout << "\n\n\n";
+
+  std::cout << "=== Profiling ShmHashmap Get With Concurrent Writer ===" <<
+    std::endl;
+  ProfileGet(1000, 10000000, true);
+  std::cout << "\n\n\n";
+  return 0;
+}
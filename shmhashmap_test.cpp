@@ -0,0 +1,203 @@
+#include "ShmHashmap.h"
+#include "Profiling.h"
+#include "Random.h"
+#include <algorithm>
+#include <assert.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+
+
+using namespace dsalgo;
+
+
+void testInitialize() {
+  ShmHashmap<int, int> test("test_hashmap.shm", 100, true);
+  ShmHashmap<int, int> test2("test_hashmap.shm");
+  assert(test2.Capacity() == 100);
+  assert(test2.Size() == 0);
+
+  // can't attach with different types
+  bool threw = false;
+  try {
+    ShmHashmap<int, double> test3("test_hashmap.shm");
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // can't accidentally overwrite
+  threw = false;
+  try {
+    ShmHashmap<int, int> test4("test_hashmap.shm", 100, false);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+
+void testPutGetRemove() {
+  ShmHashmap<int, int> test("test_hashmap.shm", 1000, true);
+  ShmHashmap<int, int> attached("test_hashmap.shm");
+  std::unordered_map<int, int> correct_map;
+
+  for (int i = 0; i < 100000; ++i) {
+    int operation = RandInt(0, 2);
+    int key = RandInt(0, 1500);
+    if (operation < 2) {
+      if (correct_map.size() < 1000 || correct_map.count(key) > 0) {
+        correct_map[key] = i;
+        test.Put(key, i);
+      }
+    } else {
+      assert(test.Remove(key) == (correct_map.erase(key) > 0));
+    }
+    assert(attached.Size() == static_cast<int>(correct_map.size()));
+  }
+
+  // every write is visible through the other mapping
+  for (int key = 0; key <= 1500; ++key) {
+    int val = 0;
+    bool found = attached.Get(key, &val);
+    assert(found == (correct_map.count(key) > 0));
+    if (found) {
+      assert(val == correct_map[key]);
+    }
+  }
+}
+
+
+void testChurn() {
+  // a sliding window of distinct keys, most of them sharing home slots, so
+  // removes leave tombstones in the middle and at the end of clusters
+  ShmHashmap<int, int> test("test_hashmap.shm", 100, true);
+  int window = 80;
+  for (int i = 0; i < 100000; ++i) {
+    test.Put(i * 64, i);
+    if (i >= window) {
+      assert(test.Remove((i - window) * 64));
+    }
+    if (i % 1000 == 0) {
+      for (int j = std::max(0, i - window - 50); j <= i; ++j) {
+        int val = 0;
+        bool found = test.Get(j * 64, &val);
+        assert(found == (j > i - window));
+        assert(!found || val == j);
+      }
+    }
+  }
+  assert(test.Size() == window);
+}
+
+
+void testCapacity() {
+  ShmHashmap<int, int> test("test_hashmap.shm", 10, true);
+  for (int i = 0; i < 10; ++i) {
+    test.Put(i, i);
+  }
+
+  // overwriting is fine, inserting is not
+  test.Put(5, 50);
+  bool threw = false;
+  try {
+    test.Put(10, 10);
+  } catch (const std::logic_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // removing makes room again
+  assert(test.Remove(3));
+  test.Put(10, 10);
+  int val = 0;
+  assert(test.Get(5, &val) && val == 50);
+  assert(test.Get(10, &val) && val == 10);
+  assert(!test.Contains(3));
+}
+
+
+/**
+ * Value that is torn if its halves don't match.
+ */
+struct Versioned {
+  int64_t version;
+  int64_t check;
+};
+
+
+void testSingleWriterMultiReader() {
+  constexpr int N_KEYS = 64;
+  constexpr int N_READERS = 3;
+  constexpr int N_WRITES = 200000;
+
+  // all processes will be limited to 10 seconds of execution time.
+  int64_t TIME_LIMIT_NS = 10000000000;
+  int64_t start = Clock::Now();
+
+  ShmHashmap<int, Versioned> test("test_hashmap.shm", N_KEYS, true);
+  for (int i = 0; i < N_KEYS; i += 2) {
+    test.Put(i, Versioned{0, 0});
+  }
+
+  std::vector<int> readers;
+  for (int r = 0; r < N_READERS; ++r) {
+    int pid = fork();
+    if (pid == 0) {
+      ShmHashmap<int, Versioned> reader("test_hashmap.shm");
+
+      // versions of a key only ever increase, and a value is never torn
+      int64_t last_versions[N_KEYS] = {0};
+      while (Clock::Now() - start < TIME_LIMIT_NS) {
+        for (int k = 0; k < N_KEYS; ++k) {
+          Versioned v;
+          if (reader.Get(k, &v)) {
+            assert(v.check == -v.version);
+            assert(v.version >= last_versions[k]);
+            last_versions[k] = v.version;
+          }
+        }
+
+        // the writer puts a final version in key N_KEYS - 1 when it's done
+        Versioned done;
+        if (reader.Get(N_KEYS - 1, &done) && done.version == N_WRITES) {
+          break;
+        }
+      }
+      exit(0);
+    }
+    readers.push_back(pid);
+  }
+
+  // odd keys keep getting inserted and removed, so readers also probe past
+  // tombstones and slots that are being reused
+  for (int64_t i = 1; i < N_WRITES; ++i) {
+    int k = RandInt(0, N_KEYS - 2);
+    if (k % 2 == 1 && test.Contains(k)) {
+      test.Remove(k);
+    } else {
+      test.Put(k, Versioned{i, -i});
+    }
+  }
+  test.Put(N_KEYS - 1, Versioned{N_WRITES, -N_WRITES});
+
+  for (int pid : readers) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+}
+
+
+int main() {
+  ReseedRand();
+  testInitialize();
+  testPutGetRemove();
+  testChurn();
+  testCapacity();
+  testSingleWriterMultiReader();
+  unlink("test_hashmap.shm");
+  return 0;
+}
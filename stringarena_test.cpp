@@ -0,0 +1,157 @@
+#include "StringArena.h"
+#include "Hashmap.h"
+#include "LruQueue.h"
+#include "Random.h"
+#include "Triemap.h"
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+using namespace dsalgo;
+
+
+void testArena() {
+  StringArena arena(16);
+  StringRef empty = arena.Add("");
+  assert(empty.size == 0);
+
+  StringRef abc = arena.Add("abc");
+  StringRef def = arena.Add("def");
+  assert(abc.ToString() == "abc");
+  assert(def.ToString() == "def");
+  assert(def.data == abc.data + 3);
+
+  // doesn't fit in the rest of the chunk, or in a chunk at all
+  std::string long_str(40, 'x');
+  StringRef long_ref = arena.Add(long_str);
+  StringRef ghi = arena.Add("ghijklmnopq");
+  assert(long_ref.ToString() == long_str);
+  assert(ghi.ToString() == "ghijklmnopq");
+  assert(abc.ToString() == "abc");
+  assert(arena.BytesUsed() == 6 + 40 + 11);
+
+  arena.Clear();
+  assert(arena.BytesUsed() == 0);
+  StringRef reused = arena.Add("xyz");
+  assert(reused.data == abc.data);
+  assert(reused.ToString() == "xyz");
+}
+
+
+void testArenaRandomized() {
+  std::vector<std::string> rand_strs = RandStrs(0, 100, 1000);
+  StringArena arena(256);
+  std::vector<StringRef> refs;
+  for (const std::string& s : rand_strs) {
+    refs.push_back(arena.Add(s));
+  }
+  for (size_t i = 0; i < rand_strs.size(); ++i) {
+    assert(refs[i].ToString() == rand_strs[i]);
+  }
+
+  StringArena moved(std::move(arena));
+  assert(arena.BytesUsed() == 0);
+  for (size_t i = 0; i < rand_strs.size(); ++i) {
+    assert(refs[i].ToString() == rand_strs[i]);
+  }
+}
+
+
+void testIntern() {
+  StringInterner interner;
+  std::string abc = "abc";
+  InternedString h1 = interner.Intern(abc);
+  InternedString h2 = interner.Intern("abc");
+  InternedString h3 = interner.Intern("abd");
+  InternedString empty = interner.Intern("");
+  assert(interner.Size() == 3);
+  assert(interner.BytesUsed() == 6);
+
+  assert(h1 == h2);
+  assert(h1 != h3);
+  assert(h1 != empty);
+  assert(h1.data != abc.data());
+  assert(h1.ToString() == "abc");
+  assert(h3.ToString() == "abd");
+  assert(empty.size == 0);
+  assert(h1.hash == static_cast<uint32_t>(StrHash()(abc)));
+  assert(std::hash<InternedString>()(h1) == h1.hash);
+
+  assert(interner.Find("abc") != nullptr);
+  assert(*interner.Find("abc") == h1);
+  assert(interner.Find("xyz") == nullptr);
+  assert(interner.Size() == 3);
+
+  interner.Clear();
+  assert(interner.Size() == 0);
+  assert(interner.BytesUsed() == 0);
+  assert(interner.Find("abc") == nullptr);
+  assert(interner.Intern("xyz").ToString() == "xyz");
+  assert(interner.Size() == 1);
+}
+
+
+void testInternRandomized() {
+  std::vector<std::string> rand_strs = RandStrs(0, 30, 2000);
+  StringInterner interner;
+  std::vector<InternedString> handles;
+  for (const std::string& s : rand_strs) {
+    handles.push_back(interner.Intern(s));
+  }
+  for (size_t i = 0; i < rand_strs.size(); ++i) {
+    assert(handles[i].ToString() == rand_strs[i]);
+    assert(interner.Intern(rand_strs[i]) == handles[i]);
+    for (size_t j = i + 1; j < rand_strs.size() && j < i + 20; ++j) {
+      assert((handles[i] == handles[j]) == (rand_strs[i] == rand_strs[j]));
+    }
+  }
+
+  StringInterner moved(std::move(interner));
+  assert(interner.Size() == 0);
+  assert(interner.Find(rand_strs[0]) == nullptr);
+  for (size_t i = 0; i < rand_strs.size(); ++i) {
+    assert(*moved.Find(rand_strs[i]) == handles[i]);
+  }
+}
+
+
+void testAsKeys() {
+  std::vector<std::string> rand_strs = RandStrs(1, 30, 500);
+  StringInterner interner;
+  Hashmap<InternedString, int> hashmap;
+  Triemap<InternedString, int> triemap;
+  Hashmap<std::string, int> expected;
+  for (size_t i = 0; i < rand_strs.size(); ++i) {
+    InternedString key = interner.Intern(rand_strs[i]);
+    hashmap[key] = i;
+    triemap.Put(key, i);
+    expected[rand_strs[i]] = i;
+  }
+  assert(hashmap.Size() == expected.Size());
+  assert(triemap.Size() == expected.Size());
+  for (const std::string& s : rand_strs) {
+    InternedString key = *interner.Find(s);
+    assert(*hashmap.Get(key) == *expected.Get(s));
+    assert(*triemap.Get(key) == *expected.Get(s));
+  }
+
+  std::vector<InternedString> elems = {
+    interner.Intern("a"), interner.Intern("b"), interner.Intern("c")};
+  LruQueue<InternedString> lru(elems);
+  assert(lru.GetLru() == interner.Intern("a"));
+  lru.MarkUsed(interner.Intern("a"));
+  assert(lru.GetLru() == interner.Intern("b"));
+}
+
+
+int main() {
+  ReseedRand();
+  testArena();
+  testArenaRandomized();
+  testIntern();
+  testInternRandomized();
+  testAsKeys();
+  return 0;
+}
@@ -0,0 +1,207 @@
+#include "SwissHashmap.h"
+#include "Random.h"
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+
+using namespace dsalgo;
+
+
+void testPutAndGet() {
+
+  // test hashmap with full load factor
+  SwissHashmap<std::string, int> test(8, 1.0);
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    assert(test.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test.Get(std::to_string(j)) == j);
+      assert(test[std::to_string(j)] == j);
+    }
+  }
+
+  // test hashmap with recommended load factor
+  SwissHashmap<std::string, int> test_rec_lf;
+  for (int i = 0; i < num_elems; ++i) {
+    test_rec_lf.Put(std::to_string(i), i);
+    assert(test_rec_lf.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test_rec_lf.Get(std::to_string(j)) == j);
+    }
+  }
+
+  // test hashmap with very small load factor
+  SwissHashmap<std::string, int> test_small_lf(8, 0.001);
+  for (int i = 0; i < num_elems; ++i) {
+    test_small_lf.Put(std::to_string(i), i);
+    assert(test_small_lf.Size() == i + 1);
+    for (int j = 0; j < i; ++j) {
+      assert(*test_small_lf.Get(std::to_string(j)) == j);
+    }
+  }
+}
+
+
+void testRemoveAndGet() {
+  SwissHashmap<std::string, int> test;
+
+  int num_elems = 128;
+  for (int i = 0; i < num_elems; ++i) {
+    test.Put(std::to_string(i), i);
+    if (i % 16 == 0) {
+      for (int j = 0; j < i; ++j) {
+        assert(test.Remove(std::to_string(j)) == true);
+      }
+      for (int j = 0; j < i; ++j) {
+        test.Put(std::to_string(j), j);
+      }
+    }
+    assert(test.Size() == i + 1);
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*test.Get(std::to_string(i)) == i);
+  }
+  for (int i = -1000; i < -500; ++i) {
+    assert(test.Get(std::to_string(i)) == nullptr);
+    assert(test.Remove(std::to_string(i)) == false);
+  }
+}
+
+
+void testTombstoneChurn() {
+  // repeatedly insert and remove distinct keys without growing the map. The
+  // tombstones this leaves behind must get cleaned out by rehashing instead of
+  // filling up the table.
+  SwissHashmap<int, int> test(64, 0.875);
+  for (int i = 0; i < 100000; ++i) {
+    test.Put(i, i);
+    if (i >= 20) {
+      assert(test.Remove(i - 20) == true);
+    }
+    assert(test.Size() == std::min(i + 1, 20));
+  }
+  for (int i = 100000 - 20; i < 100000; ++i) {
+    assert(*test.Get(i) == i);
+  }
+}
+
+
+void testClear() {
+  SwissHashmap<std::string, int> test;
+  for (int i = 0; i < 110; ++i) {
+    test[std::to_string(i)] = i;
+    if (i % 16 == 0) {
+      test.Clear();
+    }
+  }
+
+  // only 97-109 should be in the map
+  assert(test.Size() == 13);
+  for (int i = 97; i < 110; ++i) {
+    assert(test[std::to_string(i)] == i);
+  }
+  for (int i = 0; i < 97; ++i) {
+    assert(test.Get(std::to_string(i)) == nullptr);
+  }
+}
+
+
+void testCopyAndMove() {
+  SwissHashmap<std::string, int> original;
+  int num_elems = 456;
+  for (int i = 0; i < num_elems; ++i) {
+    original.Put(std::to_string(i), i);
+  }
+
+  SwissHashmap<std::string, int> copy_construct = original;
+  SwissHashmap<std::string, int> copy_assign;
+  copy_assign["-1"] = -1;
+  copy_assign = original;
+  for (int i = 0; i < 300; ++i) {
+    original.Remove(std::to_string(i));
+  }
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*copy_construct.Get(std::to_string(i)) == i);
+    assert(*copy_assign.Get(std::to_string(i)) == i);
+  }
+  assert(copy_assign.Get("-1") == nullptr);
+
+  SwissHashmap<std::string, int> move_construct = std::move(copy_construct);
+  SwissHashmap<std::string, int> move_assign;
+  move_assign["-1"] = -1;
+  move_assign = std::move(copy_assign);
+  for (int i = 0; i < num_elems; ++i) {
+    assert(*move_construct.Get(std::to_string(i)) == i);
+    assert(*move_assign.Get(std::to_string(i)) == i);
+  }
+  assert(move_assign.Get("-1") == nullptr);
+}
+
+
+void testRandomized(SwissHashmap<std::string, int>& test_map, int num_ops) {
+  std::unordered_map<std::string, int> correct_map;
+
+  for (int i = 0; i < num_ops; ++i) {
+    int operation = RandInt(0, 75);
+
+    // insert via Put
+    if (0 <= operation && operation < 25) {
+      std::string rand_key = RandStr(5, 10);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map.Put(rand_key, rand_val);
+
+    // insert via operator[]
+    } else if (25 <= operation && operation < 50) {
+      std::string rand_key = RandStr(5, 10);
+      int rand_val = RandInt(-100000, 100000);
+      correct_map[rand_key] = rand_val;
+      test_map[rand_key] = rand_val;
+
+    // remove a key
+    } else if (50 <= operation && operation < 75) {
+      if (!correct_map.empty()) {
+        std::string key_to_remove = correct_map.begin()->first;
+        correct_map.erase(key_to_remove);
+        assert(test_map.Remove(key_to_remove) == true);
+      }
+    }
+
+    assert(test_map.Size() == static_cast<int>(correct_map.size()));
+    for (const auto& entry : correct_map) {
+      assert(*test_map.Get(entry.first) == entry.second);
+    }
+  }
+}
+
+
+void testRandomized() {
+  ReseedRand();
+
+  // use recommended load factor
+  SwissHashmap<std::string, int> test;
+  testRandomized(test, 5000);
+
+  // use high load factor
+  test = SwissHashmap<std::string, int>(8, 1);
+  testRandomized(test, 1000);
+
+  // use small load factor
+  test = SwissHashmap<std::string, int>(8, 0.01);
+  testRandomized(test, 5000);
+}
+
+
+int main() {
+  testPutAndGet();
+  testRemoveAndGet();
+  testTombstoneChurn();
+  testClear();
+  testCopyAndMove();
+  testRandomized();
+  return 0;
+}